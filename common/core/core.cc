@@ -475,6 +475,8 @@ Core::accessMemory(lock_signal_t lock_signal, mem_op_t mem_op_type, IntPtr d_add
       }
       data_buffer = NULL; // initiateMemoryAccess's data is not used
    }
+   LOG_ASSERT_ERROR(!(data_buffer && Sim()->getConfig()->getTimingOnlyMemory()),
+                    "Functional access to the memory hierarchy's data is not possible with caching_protocol/timing_only");
 
    if (modeled == MEM_MODELED_NONE)
       return makeMemoryResult(HitWhere::UNKNOWN, SubsecondTime::Zero());
@@ -2,6 +2,12 @@
 #include "cache.h"
 #include "log.h"
 
+#include <map>
+
+// Number of caches and total bytes used by them, per cache name
+static std::map<String, std::pair<UInt32, UInt64> > s_memory_usage;
+static Lock s_memory_usage_lock;
+
 // Cache class
 // constructors/destructors
 Cache::Cache(
@@ -31,6 +37,15 @@ Cache::Cache(
       m_sets[i] = CacheSet::createCacheSet(cfgname, core_id, replacement_policy, m_cache_type, m_associativity, m_blocksize, m_set_info);
    }
 
+   UInt64 bytes = sizeof(*this) + m_num_sets * sizeof(CacheSet*);
+   for (UInt32 i = 0; i < m_num_sets; i++)
+      bytes += m_sets[i]->getMemoryUsage();
+   {
+      ScopedLock sl(s_memory_usage_lock);
+      s_memory_usage[name].first++;
+      s_memory_usage[name].second += bytes;
+   }
+
    #ifdef ENABLE_SET_USAGE_HIST
    m_set_usage_hist = new UInt64[m_num_sets];
    for (UInt32 i = 0; i < m_num_sets; i++)
@@ -56,6 +71,22 @@ Cache::~Cache()
    delete [] m_sets;
 }
 
+void
+Cache::printMemoryUsage()
+{
+   ScopedLock sl(s_memory_usage_lock);
+
+   UInt64 total = 0;
+   printf("[SNIPER] Cache model memory usage (line metadata and data):\n");
+   for (std::map<String, std::pair<UInt32, UInt64> >::iterator it = s_memory_usage.begin(); it != s_memory_usage.end(); ++it)
+   {
+      printf("[SNIPER]   %-12s %4u x %8.1f KB = %8.1f MB\n", it->first.c_str(), it->second.first,
+             it->second.second / it->second.first / 1024., it->second.second / (1024. * 1024.));
+      total += it->second.second;
+   }
+   printf("[SNIPER]   %-12s %26.1f MB\n", "total", total / (1024. * 1024.));
+}
+
 Lock&
 Cache::getSetLock(IntPtr addr)
 {
@@ -68,6 +68,9 @@ class Cache : public CacheBase
 
       void enable() { m_enabled = true; }
       void disable() { m_enabled = false; }
+
+      // Print the host memory used by all caches created so far, per cache name
+      static void printMemoryUsage();
 };
 
 template <class T>
@@ -59,6 +59,8 @@ class CacheBase
          PLRU,
          SRRIP,
          SRRIP_QBS,
+         DRRIP,
+         SHIP,
          RANDOM,
          NUM_REPLACEMENT_POLICIES
       };
@@ -4,6 +4,13 @@
 #include "shared_cache_block_info.h"
 #include "log.h"
 
+#include <new>
+
+static_assert(CacheState::NUM_CSTATE_STATES <= 8, "CacheBlockInfo::m_cstate is too small");
+#ifdef TARGET_INTEL64
+static_assert(sizeof(PrL1CacheBlockInfo) == 32 && sizeof(PrL2CacheBlockInfo) == 32, "CacheBlockInfo is no longer packed");
+#endif
+
 const char* CacheBlockInfo::option_names[] =
 {
    "prefetch",
@@ -23,11 +30,12 @@ const char* CacheBlockInfo::getOptionName(option_t option)
 
 CacheBlockInfo::CacheBlockInfo(IntPtr tag, CacheState::cstate_t cstate, UInt64 options):
    m_tag(tag),
-   m_cstate(cstate),
    m_owner(0),
-   m_used(0),
-   m_options(options)
-{}
+   m_cstate(cstate),
+   m_options(options),
+   m_used(0)
+{
+}
 
 CacheBlockInfo::~CacheBlockInfo()
 {}
@@ -52,6 +60,46 @@ CacheBlockInfo::create(CacheBase::cache_t cache_type)
    }
 }
 
+CacheBlockInfo*
+CacheBlockInfo::create(CacheBase::cache_t cache_type, void* memory)
+{
+   switch (cache_type)
+   {
+      case CacheBase::PR_L1_CACHE:
+         return new(memory) PrL1CacheBlockInfo();
+
+      case CacheBase::PR_L2_CACHE:
+         return new(memory) PrL2CacheBlockInfo();
+
+      case CacheBase::SHARED_CACHE:
+         return new(memory) SharedCacheBlockInfo();
+
+      default:
+         LOG_PRINT_ERROR("Unrecognized cache type (%u)", cache_type);
+         return NULL;
+   }
+}
+
+size_t
+CacheBlockInfo::getSize(CacheBase::cache_t cache_type)
+{
+   switch (cache_type)
+   {
+      case CacheBase::PR_L1_CACHE:
+         return sizeof(PrL1CacheBlockInfo);
+
+      case CacheBase::PR_L2_CACHE:
+         return sizeof(PrL2CacheBlockInfo);
+
+      case CacheBase::SHARED_CACHE:
+         return sizeof(SharedCacheBlockInfo);
+
+      default:
+         LOG_PRINT_ERROR("Unrecognized cache type (%u)", cache_type);
+         return 0;
+   }
+}
+
 void
 CacheBlockInfo::invalidate()
 {
@@ -62,8 +110,8 @@ CacheBlockInfo::invalidate()
 void
 CacheBlockInfo::clone(CacheBlockInfo* cache_block_info)
 {
-   m_tag = cache_block_info->getTag();
-   m_cstate = cache_block_info->getCState();
+   m_tag = cache_block_info->m_tag;
+   m_cstate = cache_block_info->m_cstate;
    m_owner = cache_block_info->m_owner;
    m_used = cache_block_info->m_used;
    m_options = cache_block_info->m_options;
@@ -21,11 +21,14 @@ class CacheBlockInfo
    // This can be extended later to include other information
    // for different cache coherence protocols
    private:
+      // The tag is the address without the block offset, which can use nearly all address bits (e.g. the trace frontend
+      // puts the application id in the upper address bits), so it is kept in full. State, options and usage are
+      // packed into one 32-bit word that sits after the owner, subclasses can use the remaining tail padding.
       IntPtr m_tag;
-      CacheState::cstate_t m_cstate;
       UInt64 m_owner;
-      BitsUsedType m_used;
-      UInt8 m_options;  // large enough to hold a bitfield for all available option_t's
+      UInt32 m_cstate : 3;
+      UInt32 m_options : NUM_OPTIONS;  // bitfield for all available option_t's
+      UInt32 m_used : 8 * sizeof(BitsUsedType);
 
       static const char* option_names[];
 
@@ -36,14 +39,17 @@ class CacheBlockInfo
       virtual ~CacheBlockInfo();
 
       static CacheBlockInfo* create(CacheBase::cache_t cache_type);
+      // Construct in place at memory, which should hold getSize(cache_type) bytes
+      static CacheBlockInfo* create(CacheBase::cache_t cache_type, void* memory);
+      static size_t getSize(CacheBase::cache_t cache_type);
 
       virtual void invalidate(void);
       virtual void clone(CacheBlockInfo* cache_block_info);
 
-      bool isValid() const { return (m_tag != ((IntPtr) ~0)); }
+      bool isValid() const { return (m_tag != ~IntPtr(0)); }
 
       IntPtr getTag() const { return m_tag; }
-      CacheState::cstate_t getCState() const { return m_cstate; }
+      CacheState::cstate_t getCState() const { return CacheState::cstate_t(m_cstate); }
 
       void setTag(IntPtr tag) { m_tag = tag; }
       void setCState(CacheState::cstate_t cstate) { m_cstate = cstate; }
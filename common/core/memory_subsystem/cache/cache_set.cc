@@ -7,20 +7,32 @@
 #include "cache_set_random.h"
 #include "cache_set_round_robin.h"
 #include "cache_set_srrip.h"
+#include "cache_set_drrip.h"
+#include "cache_set_ship.h"
 #include "cache_base.h"
 #include "log.h"
 #include "simulator.h"
 #include "config.h"
 #include "config.hpp"
 
+#if defined(__AVX2__) && defined(TARGET_INTEL64)
+# include <immintrin.h>
+#elif defined(__SSE2__) && defined(TARGET_INTEL64)
+# include <emmintrin.h>
+#endif
+
 CacheSet::CacheSet(CacheBase::cache_t cache_type,
       UInt32 associativity, UInt32 blocksize):
       m_associativity(associativity), m_blocksize(blocksize)
 {
    m_cache_block_info_array = new CacheBlockInfo*[m_associativity];
+   m_tags = new IntPtr[m_associativity];
+   m_block_info_size = CacheBlockInfo::getSize(cache_type);
+   m_block_info_storage = new char[m_associativity * m_block_info_size];
    for (UInt32 i = 0; i < m_associativity; i++)
    {
-      m_cache_block_info_array[i] = CacheBlockInfo::create(cache_type);
+      m_cache_block_info_array[i] = CacheBlockInfo::create(cache_type, m_block_info_storage + i * m_block_info_size);
+      m_tags[i] = m_cache_block_info_array[i]->getTag();
    }
 
    if (Sim()->getFaultinjectionManager())
@@ -35,8 +47,10 @@ CacheSet::CacheSet(CacheBase::cache_t cache_type,
 CacheSet::~CacheSet()
 {
    for (UInt32 i = 0; i < m_associativity; i++)
-      delete m_cache_block_info_array[i];
+      m_cache_block_info_array[i]->~CacheBlockInfo();
+   delete [] m_block_info_storage;
    delete [] m_cache_block_info_array;
+   delete [] m_tags;
    delete [] m_blocks;
 }
 
@@ -66,33 +80,76 @@ CacheSet::write_line(UInt32 line_index, UInt32 offset, Byte *in_buff, UInt32 byt
       updateReplacementIndex(line_index);
 }
 
-CacheBlockInfo*
-CacheSet::find(IntPtr tag, UInt32* line_index)
+bool
+CacheSet::checkWay(UInt32 index, IntPtr tag)
+{
+   IntPtr block_tag = m_cache_block_info_array[index]->getTag();
+   if (block_tag == tag)
+      return true;
+   // The line was invalidated through its CacheBlockInfo, update our copy
+   m_tags[index] = block_tag;
+   return false;
+}
+
+SInt32
+CacheSet::findWay(IntPtr tag)
 {
-   for (SInt32 index = m_associativity-1; index >= 0; index--)
+   UInt32 index = 0;
+
+#if defined(__AVX2__) && defined(TARGET_INTEL64)
+   const __m256i key = _mm256_set1_epi64x(tag);
+   for ( ; index + 4 <= m_associativity; index += 4)
+   {
+      __m256i tags = _mm256_loadu_si256((const __m256i*)&m_tags[index]);
+      UInt32 mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(tags, key)));
+      for ( ; mask; mask &= mask - 1)
+         if (checkWay(index + __builtin_ctz(mask), tag))
+            return index + __builtin_ctz(mask);
+   }
+#elif defined(__SSE2__) && defined(TARGET_INTEL64)
+   // SSE2 has no 64-bit compare: compare both 32-bit halves and combine them
+   const __m128i key = _mm_set1_epi64x(tag);
+   for ( ; index + 2 <= m_associativity; index += 2)
    {
-      if (m_cache_block_info_array[index]->getTag() == tag)
-      {
-         if (line_index != NULL)
-            *line_index = index;
-         return (m_cache_block_info_array[index]);
-      }
+      __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)&m_tags[index]), key);
+      eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+      UInt32 mask = _mm_movemask_pd(_mm_castsi128_pd(eq));
+      for ( ; mask; mask &= mask - 1)
+         if (checkWay(index + __builtin_ctz(mask), tag))
+            return index + __builtin_ctz(mask);
    }
-   return NULL;
+#endif
+
+   for ( ; index < m_associativity; index++)
+   {
+      if (m_tags[index] == tag && checkWay(index, tag))
+         return index;
+   }
+   return -1;
+}
+
+CacheBlockInfo*
+CacheSet::find(IntPtr tag, UInt32* line_index)
+{
+   SInt32 index = findWay(tag);
+   if (index < 0)
+      return NULL;
+
+   if (line_index != NULL)
+      *line_index = index;
+   return m_cache_block_info_array[index];
 }
 
 bool
 CacheSet::invalidate(IntPtr& tag)
 {
-   for (SInt32 index = m_associativity-1; index >= 0; index--)
-   {
-      if (m_cache_block_info_array[index]->getTag() == tag)
-      {
-         m_cache_block_info_array[index]->invalidate();
-         return true;
-      }
-   }
-   return false;
+   SInt32 index = findWay(tag);
+   if (index < 0)
+      return false;
+
+   m_cache_block_info_array[index]->invalidate();
+   m_tags[index] = m_cache_block_info_array[index]->getTag();
+   return true;
 }
 
 void
@@ -120,9 +177,12 @@ CacheSet::insert(CacheBlockInfo* cache_block_info, Byte* fill_buff, bool* evicti
 
    // FIXME: This is a hack. I dont know if this is the best way to do
    m_cache_block_info_array[index]->clone(cache_block_info);
+   m_tags[index] = m_cache_block_info_array[index]->getTag();
 
    if (fill_buff != NULL && m_blocks != NULL)
       memcpy(&m_blocks[index * m_blocksize], (void*) fill_buff, m_blocksize);
+
+   notifyInsert(index);
 }
 
 char*
@@ -131,6 +191,15 @@ CacheSet::getDataPtr(UInt32 line_index, UInt32 offset)
    return &m_blocks[line_index * m_blocksize + offset];
 }
 
+UInt64
+CacheSet::getMemoryUsage() const
+{
+   UInt64 bytes_per_way = sizeof(CacheBlockInfo*) + sizeof(IntPtr) + m_block_info_size;
+   if (m_blocks)
+      bytes_per_way += m_blocksize;
+   return sizeof(*this) + m_associativity * bytes_per_way;
+}
+
 CacheSet*
 CacheSet::createCacheSet(String cfgname, core_id_t core_id,
       String replacement_policy,
@@ -163,6 +232,12 @@ CacheSet::createCacheSet(String cfgname, core_id_t core_id,
       case CacheBase::SRRIP_QBS:
          return new CacheSetSRRIP(cfgname, core_id, cache_type, associativity, blocksize, dynamic_cast<CacheSetInfoLRU*>(set_info), getNumQBSAttempts(policy, cfgname, core_id));
 
+      case CacheBase::DRRIP:
+         return new CacheSetDRRIP(cfgname, core_id, cache_type, associativity, blocksize, dynamic_cast<CacheSetInfoDRRIP*>(set_info), getNumQBSAttempts(policy, cfgname, core_id));
+
+      case CacheBase::SHIP:
+         return new CacheSetSHiP(cfgname, core_id, cache_type, associativity, blocksize, dynamic_cast<CacheSetInfoSHiP*>(set_info), getNumQBSAttempts(policy, cfgname, core_id));
+
       case CacheBase::RANDOM:
          return new CacheSetRandom(cache_type, associativity, blocksize);
 
@@ -186,6 +261,10 @@ CacheSet::createCacheSetInfo(String name, String cfgname, core_id_t core_id, Str
       case CacheBase::SRRIP:
       case CacheBase::SRRIP_QBS:
          return new CacheSetInfoLRU(name, cfgname, core_id, associativity, getNumQBSAttempts(policy, cfgname, core_id));
+      case CacheBase::DRRIP:
+         return new CacheSetInfoDRRIP(name, cfgname, core_id, associativity, getNumQBSAttempts(policy, cfgname, core_id));
+      case CacheBase::SHIP:
+         return new CacheSetInfoSHiP(name, cfgname, core_id, associativity, getNumQBSAttempts(policy, cfgname, core_id));
       default:
          return NULL;
    }
@@ -225,6 +304,10 @@ CacheSet::parsePolicyType(String policy)
       return CacheBase::SRRIP;
    if (policy == "srrip_qbs")
       return CacheBase::SRRIP_QBS;
+   if (policy == "drrip")
+      return CacheBase::DRRIP;
+   if (policy == "ship")
+      return CacheBase::SHIP;
    if (policy == "random")
       return CacheBase::RANDOM;
 
@@ -30,11 +30,23 @@ class CacheSet
 
    protected:
       CacheBlockInfo** m_cache_block_info_array;
+      // Tags of all ways, stored contiguously so find() can compare them with SIMD instead of loading every
+      // CacheBlockInfo. Kept in sync by insert() and invalidate(); a CacheBlockInfo that is invalidated directly
+      // leaves a stale copy here, which find() detects and repairs.
+      IntPtr* m_tags;
+      // Storage for all CacheBlockInfo objects of this set, allocated as one block instead of one allocation per way
+      char* m_block_info_storage;
+      size_t m_block_info_size;
       char* m_blocks;
       UInt32 m_associativity;
       UInt32 m_blocksize;
       Lock m_lock;
 
+      SInt32 findWay(IntPtr tag);
+      bool checkWay(UInt32 index, IntPtr tag);
+      // Called by insert() once the new line is in place, for policies that depend on the line's address
+      virtual void notifyInsert(UInt32 index) {}
+
    public:
 
       CacheSet(CacheBase::cache_t cache_type,
@@ -54,6 +66,8 @@ class CacheSet
       CacheBlockInfo* peekBlock(UInt32 way) const { return m_cache_block_info_array[way]; }
 
       char* getDataPtr(UInt32 line_index, UInt32 offset = 0);
+      // Host memory used by the line metadata and data of this set, in bytes (not including replacement state)
+      UInt64 getMemoryUsage() const;
       UInt32 getBlockSize(void) const { return m_blocksize; }
 
       virtual UInt32 getReplacementIndex(CacheCntlr *cntlr) = 0;
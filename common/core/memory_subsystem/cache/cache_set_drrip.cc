@@ -0,0 +1,51 @@
+#include "cache_set_drrip.h"
+#include "simulator.h"
+#include "config.hpp"
+#include "log.h"
+
+// D-RRIP: Dynamic Re-reference Interval Prediction [Jaleel et al., ISCA'10]
+// Set dueling between SRRIP, which inserts lines with a 'long' re-reference prediction, and the thrash-resistant
+// BRRIP, which inserts most lines with a 'distant' prediction so they are evicted first unless they are reused.
+
+CacheSetDRRIP::CacheSetDRRIP(
+      String cfgname, core_id_t core_id,
+      CacheBase::cache_t cache_type,
+      UInt32 associativity, UInt32 blocksize, CacheSetInfoDRRIP* set_info, UInt8 num_attempts)
+   : CacheSetSRRIP(cfgname, core_id, cache_type, associativity, blocksize, set_info, num_attempts)
+   , m_drrip_info(set_info)
+   , m_role(set_info->getMonitor().getRole(set_info->addSet()))
+{
+}
+
+CacheSetDRRIP::~CacheSetDRRIP()
+{
+}
+
+UInt8
+CacheSetDRRIP::getInsertionRRPV()
+{
+   SetDuelingMonitor &monitor = m_drrip_info->getMonitor();
+   monitor.recordMiss(m_role);
+
+   // Policy A is SRRIP, policy B is BRRIP
+   if (monitor.usePolicyB(m_role) && !m_drrip_info->getBRRIPInsertLong())
+      return m_rrip_max;
+   else
+      return m_rrip_insert;
+}
+
+CacheSetInfoDRRIP::CacheSetInfoDRRIP(String name, String cfgname, core_id_t core_id, UInt32 associativity, UInt8 num_attempts)
+   : CacheSetInfoLRU(name, cfgname, core_id, associativity, num_attempts)
+   , m_monitor(name, core_id,
+               Sim()->getCfg()->getInt("perf_model/cache/drrip/constituency"),
+               Sim()->getCfg()->getInt("perf_model/cache/drrip/psel_bits"))
+   , m_num_sets(0)
+   , m_brrip_interval(Sim()->getCfg()->getInt("perf_model/cache/drrip/brrip_long_interval"))
+   , m_brrip_count(0)
+{
+   LOG_ASSERT_ERROR(m_brrip_interval > 0, "perf_model/cache/drrip/brrip_long_interval should be at least 1");
+}
+
+CacheSetInfoDRRIP::~CacheSetInfoDRRIP()
+{
+}
@@ -0,0 +1,42 @@
+#ifndef CACHE_SET_DRRIP_H
+#define CACHE_SET_DRRIP_H
+
+#include "cache_set_srrip.h"
+#include "cache_set_dueling.h"
+
+class CacheSetInfoDRRIP : public CacheSetInfoLRU
+{
+   public:
+      CacheSetInfoDRRIP(String name, String cfgname, core_id_t core_id, UInt32 associativity, UInt8 num_attempts);
+      virtual ~CacheSetInfoDRRIP();
+
+      // Sets are created in order, this returns the index of the next one
+      UInt32 addSet() { return m_num_sets++; }
+      SetDuelingMonitor& getMonitor() { return m_monitor; }
+      // BRRIP inserts with a 'long' re-reference prediction once every m_brrip_interval fills, 'distant' otherwise
+      bool getBRRIPInsertLong() { return ++m_brrip_count % m_brrip_interval == 0; }
+
+   private:
+      SetDuelingMonitor m_monitor;
+      UInt32 m_num_sets;
+      const UInt32 m_brrip_interval;
+      UInt32 m_brrip_count;
+};
+
+class CacheSetDRRIP : public CacheSetSRRIP
+{
+   public:
+      CacheSetDRRIP(String cfgname, core_id_t core_id,
+            CacheBase::cache_t cache_type,
+            UInt32 associativity, UInt32 blocksize, CacheSetInfoDRRIP* set_info, UInt8 num_attempts);
+      virtual ~CacheSetDRRIP();
+
+   protected:
+      UInt8 getInsertionRRPV();
+
+   private:
+      CacheSetInfoDRRIP* m_drrip_info;
+      const SetDuelingMonitor::role_t m_role;
+};
+
+#endif /* CACHE_SET_DRRIP_H */
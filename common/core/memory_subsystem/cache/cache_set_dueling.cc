@@ -0,0 +1,34 @@
+#include "cache_set_dueling.h"
+#include "stats.h"
+#include "log.h"
+
+SetDuelingMonitor::SetDuelingMonitor(String name, core_id_t core_id, UInt32 constituency, UInt32 psel_bits)
+   : m_constituency(constituency)
+   , m_psel_max((1 << psel_bits) - 1)
+   , m_psel(m_psel_max / 2)
+   , m_misses_a(0)
+   , m_misses_b(0)
+{
+   LOG_ASSERT_ERROR(m_constituency >= 2 && (m_constituency & (m_constituency - 1)) == 0,
+                    "Set dueling constituency size (%u) should be a power of two", m_constituency);
+   LOG_ASSERT_ERROR(psel_bits > 0 && psel_bits < 32, "Invalid number of PSEL bits (%u)", psel_bits);
+
+   registerStatsMetric(name, core_id, "dueling-psel", &m_psel);
+   registerStatsMetric(name, core_id, "dueling-leader-a-misses", &m_misses_a);
+   registerStatsMetric(name, core_id, "dueling-leader-b-misses", &m_misses_b);
+}
+
+SetDuelingMonitor::role_t
+SetDuelingMonitor::getRole(UInt32 set_index) const
+{
+   // Complement-select: the leader's offset within its constituency shifts with the constituency number,
+   // such that leaders are not all aligned to the same address bits. Both offsets differ as m_constituency is even.
+   UInt32 offset = set_index % m_constituency;
+   UInt32 select = (set_index / m_constituency) % m_constituency;
+   if (offset == select)
+      return LEADER_A;
+   else if (offset == m_constituency - 1 - select)
+      return LEADER_B;
+   else
+      return FOLLOWER;
+}
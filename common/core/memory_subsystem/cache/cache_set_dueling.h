@@ -0,0 +1,56 @@
+#ifndef CACHE_SET_DUELING_H
+#define CACHE_SET_DUELING_H
+
+#include "fixed_types.h"
+
+// Set dueling [Qureshi et al., ISCA'07]: in every constituency of sets, one leader set always uses policy A and another
+// always uses policy B. Misses in the leader sets move a saturating policy selection counter (PSEL) towards the other
+// policy, all follower sets use the policy that currently misses less. There is one monitor per cache, shared by all sets.
+class SetDuelingMonitor
+{
+   public:
+      enum role_t
+      {
+         FOLLOWER,
+         LEADER_A,
+         LEADER_B,
+      };
+
+      SetDuelingMonitor(String name, core_id_t core_id, UInt32 constituency, UInt32 psel_bits);
+
+      role_t getRole(UInt32 set_index) const;
+
+      void recordMiss(role_t role)
+      {
+         // Sets are locked individually, so concurrent updates from different sets may be lost. This only delays training.
+         if (role == LEADER_A)
+         {
+            ++m_misses_a;
+            if (m_psel < m_psel_max)
+               ++m_psel;
+         }
+         else if (role == LEADER_B)
+         {
+            ++m_misses_b;
+            if (m_psel > 0)
+               --m_psel;
+         }
+      }
+
+      bool usePolicyB(role_t role) const
+      {
+         if (role == FOLLOWER)
+            return m_psel > m_psel_max / 2;
+         else
+            return role == LEADER_B;
+      }
+
+   private:
+      const UInt32 m_constituency;
+      const UInt64 m_psel_max;
+      UInt64 m_psel;
+      UInt64 m_misses_a;
+      UInt64 m_misses_b;
+};
+
+#endif /* CACHE_SET_DUELING_H */
@@ -1,4 +1,5 @@
 #include "cache_set_lru.h"
+#include "cache_set_vector.h"
 #include "log.h"
 #include "stats.h"
 
@@ -87,11 +88,7 @@ CacheSetLRU::updateReplacementIndex(UInt32 accessed_index)
 void
 CacheSetLRU::moveToMRU(UInt32 accessed_index)
 {
-   for (UInt32 i = 0; i < m_associativity; i++)
-   {
-      if (m_lru_bits[i] < m_lru_bits[accessed_index])
-         m_lru_bits[i] ++;
-   }
+   CacheSetVector::incrementBelow(m_lru_bits, m_associativity, m_lru_bits[accessed_index]);
    m_lru_bits[accessed_index] = 0;
 }
 
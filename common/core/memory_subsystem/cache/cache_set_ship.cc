@@ -0,0 +1,82 @@
+#include "cache_set_ship.h"
+#include "simulator.h"
+#include "config.hpp"
+#include "stats.h"
+#include "log.h"
+
+// SHiP: Signature-based Hit Predictor [Wu et al., MICRO'11], on top of SRRIP
+// Lines are tagged with a signature of their memory region. A table of saturating counters (SHCT) learns which
+// signatures are reused: it is incremented on hits and decremented when a line is replaced without having been hit.
+// Lines whose signature counter is zero are inserted with a 'distant' re-reference prediction.
+
+CacheSetSHiP::CacheSetSHiP(
+      String cfgname, core_id_t core_id,
+      CacheBase::cache_t cache_type,
+      UInt32 associativity, UInt32 blocksize, CacheSetInfoSHiP* set_info, UInt8 num_attempts)
+   : CacheSetSRRIP(cfgname, core_id, cache_type, associativity, blocksize, set_info, num_attempts)
+   , m_ship_info(set_info)
+{
+   m_signature = new UInt32[m_associativity];
+   m_line_flags = new UInt8[m_associativity];
+   for (UInt32 i = 0; i < m_associativity; i++)
+   {
+      m_signature[i] = 0;
+      m_line_flags[i] = 0;
+   }
+}
+
+CacheSetSHiP::~CacheSetSHiP()
+{
+   delete [] m_signature;
+   delete [] m_line_flags;
+}
+
+void
+CacheSetSHiP::updateReplacementIndex(UInt32 accessed_index)
+{
+   CacheSetSRRIP::updateReplacementIndex(accessed_index);
+
+   if (m_line_flags[accessed_index] & LINE_TRACKED)
+   {
+      m_line_flags[accessed_index] |= LINE_REUSED;
+      m_ship_info->train(m_signature[accessed_index], true);
+   }
+}
+
+void
+CacheSetSHiP::notifyInsert(UInt32 index)
+{
+   // The previous line in this way is gone (replaced, or invalidated before), train on whether it was reused
+   if ((m_line_flags[index] & (LINE_TRACKED | LINE_REUSED)) == LINE_TRACKED)
+      m_ship_info->train(m_signature[index], false);
+
+   m_signature[index] = m_ship_info->getSignature(m_tags[index]);
+   m_line_flags[index] = LINE_TRACKED;
+
+   if (!m_ship_info->predictReuse(m_signature[index]))
+      m_rrip_bits[index] = m_rrip_max;
+}
+
+CacheSetInfoSHiP::CacheSetInfoSHiP(String name, String cfgname, core_id_t core_id, UInt32 associativity, UInt8 num_attempts)
+   : CacheSetInfoLRU(name, cfgname, core_id, associativity, num_attempts)
+   , m_shct_bits(Sim()->getCfg()->getInt("perf_model/cache/ship/shct_bits"))
+   , m_region_bits(Sim()->getCfg()->getInt("perf_model/cache/ship/region_bits"))
+   , m_counter_max((1 << Sim()->getCfg()->getInt("perf_model/cache/ship/counter_bits")) - 1)
+   , m_predict_reuse(0)
+   , m_predict_distant(0)
+{
+   LOG_ASSERT_ERROR(m_shct_bits > 0 && m_shct_bits <= 24, "Invalid perf_model/cache/ship/shct_bits (%u)", m_shct_bits);
+   LOG_ASSERT_ERROR(m_counter_max > 0 && m_counter_max <= 0xff, "perf_model/cache/ship/counter_bits should be between 1 and 8");
+
+   // Start out weakly predicting reuse, such that lines are not inserted as 'distant' before anything was learned
+   m_shct = new UInt8[1 << m_shct_bits];
+   memset(m_shct, 1, 1 << m_shct_bits);
+
+   registerStatsMetric(name, core_id, "ship-predict-reuse", &m_predict_reuse);
+   registerStatsMetric(name, core_id, "ship-predict-distant", &m_predict_distant);
+}
+
+CacheSetInfoSHiP::~CacheSetInfoSHiP()
+{
+   delete [] m_shct;
+}
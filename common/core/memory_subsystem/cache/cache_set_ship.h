@@ -0,0 +1,73 @@
+#ifndef CACHE_SET_SHIP_H
+#define CACHE_SET_SHIP_H
+
+#include "cache_set_srrip.h"
+
+class CacheSetInfoSHiP : public CacheSetInfoLRU
+{
+   public:
+      CacheSetInfoSHiP(String name, String cfgname, core_id_t core_id, UInt32 associativity, UInt8 num_attempts);
+      virtual ~CacheSetInfoSHiP();
+
+      UInt32 getSignature(IntPtr tag) const
+      {
+         // Memory region of the line (SHiP-Mem), hashed into the table
+         return ((UInt64(tag) >> m_region_bits) * 0x9e3779b97f4a7c15ULL) >> (64 - m_shct_bits);
+      }
+      bool predictReuse(UInt32 signature)
+      {
+         if (m_shct[signature])
+         {
+            ++m_predict_reuse;
+            return true;
+         }
+         else
+         {
+            ++m_predict_distant;
+            return false;
+         }
+      }
+      void train(UInt32 signature, bool reused)
+      {
+         // Sets are locked individually, concurrent updates of the same counter from different sets may be lost
+         if (reused && m_shct[signature] < m_counter_max)
+            ++m_shct[signature];
+         else if (!reused && m_shct[signature] > 0)
+            --m_shct[signature];
+      }
+
+   private:
+      const UInt32 m_shct_bits;
+      const UInt32 m_region_bits;
+      const UInt32 m_counter_max;
+      UInt8* m_shct;
+      UInt64 m_predict_reuse;
+      UInt64 m_predict_distant;
+};
+
+class CacheSetSHiP : public CacheSetSRRIP
+{
+   public:
+      CacheSetSHiP(String cfgname, core_id_t core_id,
+            CacheBase::cache_t cache_type,
+            UInt32 associativity, UInt32 blocksize, CacheSetInfoSHiP* set_info, UInt8 num_attempts);
+      virtual ~CacheSetSHiP();
+
+      void updateReplacementIndex(UInt32 accessed_index);
+
+   protected:
+      void notifyInsert(UInt32 index);
+
+   private:
+      enum
+      {
+         LINE_TRACKED = 1,    //< m_signature is valid
+         LINE_REUSED = 2,     //< Line was hit since it was inserted
+      };
+
+      CacheSetInfoSHiP* m_ship_info;
+      UInt32* m_signature;
+      UInt8* m_line_flags;
+};
+
+#endif /* CACHE_SET_SHIP_H */
@@ -1,4 +1,5 @@
 #include "cache_set_srrip.h"
+#include "cache_set_vector.h"
 #include "simulator.h"
 #include "config.hpp"
 #include "log.h"
@@ -36,7 +37,7 @@ CacheSetSRRIP::getReplacementIndex(CacheCntlr *cntlr)
       {
          // If there is an invalid line(s) in the set, regardless of the LRU bits of other lines, we choose the first invalid line to replace
          // Prepare way for a new line: set prediction to 'long'
-         m_rrip_bits[i] = m_rrip_insert;
+         m_rrip_bits[i] = getInsertionRRPV();
          return i;
       }
    }
@@ -71,7 +72,7 @@ CacheSetSRRIP::getReplacementIndex(CacheCntlr *cntlr)
 
             m_replacement_pointer = (m_replacement_pointer + 1) % m_associativity;
             // Prepare way for a new line: set prediction to 'long'
-            m_rrip_bits[index] = m_rrip_insert;
+            m_rrip_bits[index] = getInsertionRRPV();
 
             m_set_info->incrementAttempt(attempt);
 
@@ -82,14 +83,11 @@ CacheSetSRRIP::getReplacementIndex(CacheCntlr *cntlr)
          m_replacement_pointer = (m_replacement_pointer + 1) % m_associativity;
       }
 
-      // Increment all RRIP counters until one hits RRIP_MAX
-      for (UInt32 i = 0; i < m_associativity; i++)
-      {
-         if (m_rrip_bits[i] < m_rrip_max)
-         {
-            m_rrip_bits[i]++;
-         }
-      }
+      // Increment all RRIP counters until one hits RRIP_MAX. Rather than incrementing by one and scanning the set again,
+      // which would not find a victim until the largest counter reaches RRIP_MAX, add the difference at once.
+      UInt8 rrip_highest = CacheSetVector::max(m_rrip_bits, m_associativity);
+      if (rrip_highest < m_rrip_max)
+         CacheSetVector::add(m_rrip_bits, m_associativity, m_rrip_max - rrip_highest);
    }
 
    LOG_PRINT_ERROR("Error finding replacement index");
@@ -10,12 +10,15 @@ class CacheSetSRRIP : public CacheSet
       CacheSetSRRIP(String cfgname, core_id_t core_id,
             CacheBase::cache_t cache_type,
             UInt32 associativity, UInt32 blocksize, CacheSetInfoLRU* set_info, UInt8 num_attempts);
-      ~CacheSetSRRIP();
+      virtual ~CacheSetSRRIP();
 
       UInt32 getReplacementIndex(CacheCntlr *cntlr);
       void updateReplacementIndex(UInt32 accessed_index);
 
-   private:
+   protected:
+      // Re-reference prediction for a line that is about to be inserted, called once per fill
+      virtual UInt8 getInsertionRRPV() { return m_rrip_insert; }
+
       const UInt8 m_rrip_numbits;
       const UInt8 m_rrip_max;
       const UInt8 m_rrip_insert;
@@ -0,0 +1,70 @@
+#ifndef CACHE_SET_VECTOR_H
+#define CACHE_SET_VECTOR_H
+
+#include "fixed_types.h"
+
+#if defined(__SSE2__) && defined(TARGET_INTEL64)
+# include <emmintrin.h>
+#endif
+
+// Operations on the per-way replacement state (LRU positions, RRPVs) of a set, stored as one byte per way.
+// Sixteen ways are handled per SSE2 instruction, the remaining ways with the scalar loop.
+namespace CacheSetVector
+{
+   // Increment all values smaller than threshold (LRU: age the lines that were more recently used than the accessed one)
+   inline void incrementBelow(UInt8* values, UInt32 size, UInt8 threshold)
+   {
+      UInt32 i = 0;
+#if defined(__SSE2__) && defined(TARGET_INTEL64)
+      const __m128i limit = _mm_set1_epi8(threshold);
+      for ( ; i + 16 <= size; i += 16)
+      {
+         __m128i v = _mm_loadu_si128((const __m128i*)&values[i]);
+         // SSE2 has no unsigned byte compare: v < limit iff max(v, limit) != v. lt is all-ones (-1) where true.
+         __m128i lt = _mm_xor_si128(_mm_cmpeq_epi8(_mm_max_epu8(v, limit), v), _mm_set1_epi8(-1));
+         _mm_storeu_si128((__m128i*)&values[i], _mm_sub_epi8(v, lt));
+      }
+#endif
+      for ( ; i < size; i++)
+         if (values[i] < threshold)
+            values[i]++;
+   }
+
+   inline UInt8 max(const UInt8* values, UInt32 size)
+   {
+      UInt8 result = 0;
+      UInt32 i = 0;
+#if defined(__SSE2__) && defined(TARGET_INTEL64)
+      if (size >= 16)
+      {
+         __m128i m = _mm_setzero_si128();
+         for ( ; i + 16 <= size; i += 16)
+            m = _mm_max_epu8(m, _mm_loadu_si128((const __m128i*)&values[i]));
+         m = _mm_max_epu8(m, _mm_srli_si128(m, 8));
+         m = _mm_max_epu8(m, _mm_srli_si128(m, 4));
+         m = _mm_max_epu8(m, _mm_srli_si128(m, 2));
+         m = _mm_max_epu8(m, _mm_srli_si128(m, 1));
+         result = _mm_cvtsi128_si32(m) & 0xff;
+      }
+#endif
+      for ( ; i < size; i++)
+         if (values[i] > result)
+            result = values[i];
+      return result;
+   }
+
+   // Add delta to all values, the caller makes sure that this does not overflow
+   inline void add(UInt8* values, UInt32 size, UInt8 delta)
+   {
+      UInt32 i = 0;
+#if defined(__SSE2__) && defined(TARGET_INTEL64)
+      const __m128i d = _mm_set1_epi8(delta);
+      for ( ; i + 16 <= size; i += 16)
+         _mm_storeu_si128((__m128i*)&values[i], _mm_add_epi8(_mm_loadu_si128((const __m128i*)&values[i]), d));
+#endif
+      for ( ; i < size; i++)
+         values[i] += delta;
+   }
+};
+
+#endif /* CACHE_SET_VECTOR_H */
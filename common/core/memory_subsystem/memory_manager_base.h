@@ -87,6 +87,8 @@ class MemoryManagerBase
 
       // Modeling
       virtual UInt32 getModeledLength(const void* pkt_data) = 0;
+      // Bytes the message stands for but does not carry (see caching_protocol/timing_only)
+      virtual UInt32 getOmittedLength(const void* pkt_data) { return 0; }
 
       Core* getCore() { return m_core; }
 
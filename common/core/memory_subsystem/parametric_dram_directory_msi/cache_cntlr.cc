@@ -81,11 +81,49 @@ PrevCacheIndex CacheCntlrList::find(core_id_t core_id, MemComponent::component_t
 }
 #endif
 
+static UInt64 setLockAcquiresCallback(String objectName, UInt32 index, String metricName, UInt64 arg)
+{
+   return ((SetLock*)arg)->getAcquires();
+}
+
+static UInt64 setLockContendedCallback(String objectName, UInt32 index, String metricName, UInt64 arg)
+{
+   return ((SetLock*)arg)->getContended();
+}
+
+static UInt64 setLocksAcquiresCallback(String objectName, UInt32 index, String metricName, UInt64 arg)
+{
+   UInt64 total = 0;
+   for(std::vector<SetLock>::const_iterator it = ((std::vector<SetLock>*)arg)->begin(); it != ((std::vector<SetLock>*)arg)->end(); ++it)
+      total += it->getAcquires();
+   return total;
+}
+
+static UInt64 setLocksContendedCallback(String objectName, UInt32 index, String metricName, UInt64 arg)
+{
+   UInt64 total = 0;
+   for(std::vector<SetLock>::const_iterator it = ((std::vector<SetLock>*)arg)->begin(); it != ((std::vector<SetLock>*)arg)->end(); ++it)
+      total += it->getContended();
+   return total;
+}
+
 void CacheMasterCntlr::createSetLocks(UInt32 cache_block_size, UInt32 num_sets, UInt32 core_offset, UInt32 num_cores)
 {
    m_log_blocksize = floorLog2(cache_block_size);
    m_num_sets = num_sets;
    m_setlocks.resize(m_num_sets, SetLock(core_offset, num_cores));
+
+   // Set lock statistics, host-side only: these do not affect simulated time.
+   // Totals over all sets are always available, per-set counters (to find hot sets) add two metrics per set and are opt-in.
+   Sim()->getStatsManager()->registerMetric(new StatsMetricCallback("setlock", core_offset, "acquires", setLocksAcquiresCallback, (UInt64)&m_setlocks));
+   Sim()->getStatsManager()->registerMetric(new StatsMetricCallback("setlock", core_offset, "contended", setLocksContendedCallback, (UInt64)&m_setlocks));
+   if (!Sim()->getCfg()->getBool("perf_model/cache/setlock_stats"))
+      return;
+   for(UInt32 set = 0; set < m_num_sets; ++set)
+   {
+      Sim()->getStatsManager()->registerMetric(new StatsMetricCallback("setlock", core_offset, "set-" + itostr(set) + "-acquires", setLockAcquiresCallback, (UInt64)&m_setlocks[set]));
+      Sim()->getStatsManager()->registerMetric(new StatsMetricCallback("setlock", core_offset, "set-" + itostr(set) + "-contended", setLockContendedCallback, (UInt64)&m_setlocks[set]));
+   }
 }
 
 SetLock*
@@ -142,6 +180,8 @@ CacheCntlr::CacheCntlr(MemComponent::component_t mem_component,
    m_coherent(cache_params.coherent),
    m_prefetch_on_prefetch_hit(false),
    m_l1_mshr(cache_params.outstanding_misses > 0),
+   m_fast_path(false),
+   m_fast_path_validate(false),
    m_core_id(core_id),
    m_cache_block_size(cache_block_size),
    m_cache_writethrough(cache_params.writethrough),
@@ -205,6 +245,15 @@ CacheCntlr::CacheCntlr(MemComponent::component_t mem_component,
    if (m_master->m_prefetcher)
       m_prefetch_on_prefetch_hit = Sim()->getCfg()->getBoolArray("perf_model/" + cache_params.configName + "/prefetcher/prefetch_on_prefetch_hit", core_id);
 
+   if (mem_component == MemComponent::L1_ICACHE || mem_component == MemComponent::L1_DCACHE)
+   {
+      // The fast path only implements a plain hit: no prefetcher training, write-through, fault injection or special cache modes
+      bool fast_path_possible = !m_perfect && !m_passthrough && !m_cache_writethrough
+                                && !m_master->m_prefetcher && !Sim()->getFaultinjectionManager();
+      m_fast_path = fast_path_possible && Sim()->getCfg()->getBoolArray("perf_model/" + cache_params.configName + "/fast_path", core_id);
+      m_fast_path_validate = m_fast_path && Sim()->getCfg()->getBoolArray("perf_model/" + cache_params.configName + "/fast_path_validate", core_id);
+   }
+
    bzero(&stats, sizeof(stats));
 
    registerStatsMetric(name, core_id, "loads", &stats.loads);
@@ -227,6 +276,11 @@ CacheCntlr::CacheCntlr(MemComponent::component_t mem_component,
    registerStatsMetric(name, core_id, "qbs-query-latency", &stats.qbs_query_latency);
    registerStatsMetric(name, core_id, "mshr-latency", &stats.mshr_latency);
    registerStatsMetric(name, core_id, "prefetches", &stats.prefetches);
+   if (m_fast_path)
+   {
+      registerStatsMetric(name, core_id, "fast-path-hits", &stats.fast_path_hits);
+      registerStatsMetric(name, core_id, "fast-path-validated", &stats.fast_path_validated);
+   }
    for(CacheState::cstate_t state = CacheState::CSTATE_FIRST; state < CacheState::NUM_CSTATE_STATES; state = CacheState::cstate_t(int(state)+1)) {
       registerStatsMetric(name, core_id, String("loads-")+CStateString(state), &stats.loads_state[state]);
       registerStatsMetric(name, core_id, String("stores-")+CStateString(state), &stats.stores_state[state]);
@@ -327,6 +381,16 @@ CacheCntlr::processMemOpFromCore(
    // Protect against concurrent access from sibling SMT threads
    ScopedLock sl_smt(m_master->m_smt_lock);
 
+   // Hits that need no coherence action, outside of atomic operations, take the fast path
+   bool fast_path_validate = false;
+   if (m_fast_path && lock_signal == Core::NONE && !Sim()->getConfig()->hasCacheEfficiencyCallbacks())
+   {
+      if (m_fast_path_validate)
+         fast_path_validate = true;
+      else if (processMemOpFromCoreFast(mem_op_type, ca_address, offset, data_buf, data_length, modeled, count))
+         return HitWhere::where_t(m_mem_component);
+   }
+
    LOG_PRINT("processMemOpFromCore(), lock_signal(%u), mem_op_type(%u), ca_address(0x%x)",
              lock_signal, mem_op_type, ca_address);
 MYLOG("----------------------------------------------");
@@ -356,6 +420,16 @@ LOG_ASSERT_ERROR(offset + data_length <= getCacheBlockSize(), "access until %u >
 
    SubsecondTime t_start = getShmemPerfModel()->getElapsedTime(ShmemPerfModel::_USER_THREAD);
 
+   // Validation mode: determine what the fast path would have done, while holding the same set lock
+   bool fast_path_hit = false;
+   FastPathHit fast_path_prediction = FastPathHit(), fast_path_stats = FastPathHit();
+   if (fast_path_validate && checkFastPath(ca_address, mem_op_type))
+   {
+      ScopedLock sl(getLock());
+      fast_path_hit = true;
+      fast_path_prediction = predictFastPathHit(mem_op_type, ca_address, modeled);
+   }
+
    CacheBlockInfo *cache_block_info;
    bool cache_hit = operationPermissibleinCache(ca_address, mem_op_type, &cache_block_info), prefetch_hit = false;
 
@@ -386,6 +460,13 @@ LOG_ASSERT_ERROR(offset + data_length <= getCacheBlockSize(), "access until %u >
       updateCounters(mem_op_type, ca_address, cache_hit, getCacheState(cache_block_info), Prefetch::NONE);
    }
 
+   if (fast_path_hit)
+   {
+      // Hit latency statistics before this access adds to them
+      fast_path_stats.overlapping_misses = mem_op_type == Core::WRITE ? stats.store_overlapping_misses : stats.load_overlapping_misses;
+      fast_path_stats.mshr_latency = stats.mshr_latency;
+   }
+
    if (cache_hit)
    {
 MYLOG("L1 hit");
@@ -405,35 +486,10 @@ MYLOG("L1 hit");
          cache_block_info->clearOption(CacheBlockInfo::PREFETCH);
       }
 
-      if (modeled && m_l1_mshr)
-      {
-         ScopedLock sl(getLock());
-         SubsecondTime t_now = getShmemPerfModel()->getElapsedTime(ShmemPerfModel::_USER_THREAD);
-         SubsecondTime t_completed = m_master->m_l1_mshr.getTagCompletionTime(ca_address);
-         if (t_completed != SubsecondTime::MaxTime() && t_completed > t_now)
-         {
-            if (mem_op_type == Core::WRITE)
-               ++stats.store_overlapping_misses;
-            else
-               ++stats.load_overlapping_misses;
-
-            SubsecondTime latency = t_completed - t_now;
-            getShmemPerfModel()->incrElapsedTime(latency, ShmemPerfModel::_USER_THREAD);
-         }
-      }
-
       if (modeled)
       {
          ScopedLock sl(getLock());
-         // This is a hit, but maybe the prefetcher filled it at a future time stamp. If so, delay.
-         SubsecondTime t_now = getShmemPerfModel()->getElapsedTime(ShmemPerfModel::_USER_THREAD);
-         if (m_master->mshr.count(ca_address)
-            && (m_master->mshr[ca_address].t_issue < t_now && m_master->mshr[ca_address].t_complete > t_now))
-         {
-            SubsecondTime latency = m_master->mshr[ca_address].t_complete - t_now;
-            stats.mshr_latency += latency;
-            getMemoryManager()->incrElapsedTime(latency, ShmemPerfModel::_USER_THREAD);
-         }
+         updateHitLatency(mem_op_type, ca_address);
       }
 
    } else {
@@ -582,6 +638,26 @@ MYLOG("access done");
          stats.stores_where[hit_where]++;
       else
          stats.loads_where[hit_where]++;
+
+      if (fast_path_hit)
+      {
+         // The fast path may decline hits (e.g. when another core holds the set lock), but when it claims one,
+         // the full controller should see the same hit and account the same latency and statistics for it
+         LOG_ASSERT_ERROR((cache_hit && hit_where == HitWhere::where_t(m_mem_component)),
+                          "L1 fast path predicted a hit for %c %lx, the full controller returned %s",
+                          mem_op_type == Core::WRITE ? 'W' : 'R', ca_address, HitWhereString(hit_where));
+         LOG_ASSERT_ERROR(total_latency == fast_path_prediction.latency,
+                          "L1 fast path predicted a latency of %lu ps for %c %lx, the full controller took %lu ps",
+                          fast_path_prediction.latency.getPS(), mem_op_type == Core::WRITE ? 'W' : 'R', ca_address, total_latency.getPS());
+         UInt64 overlapping_misses = mem_op_type == Core::WRITE ? stats.store_overlapping_misses : stats.load_overlapping_misses;
+         LOG_ASSERT_ERROR(overlapping_misses - fast_path_stats.overlapping_misses == fast_path_prediction.overlapping_misses
+                          && stats.mshr_latency - fast_path_stats.mshr_latency == fast_path_prediction.mshr_latency,
+                          "L1 fast path statistics for %c %lx do not match the full controller: overlapping misses %lu vs %lu, mshr latency %lu vs %lu ps",
+                          mem_op_type == Core::WRITE ? 'W' : 'R', ca_address,
+                          fast_path_prediction.overlapping_misses, overlapping_misses - fast_path_stats.overlapping_misses,
+                          fast_path_prediction.mshr_latency.getPS(), (stats.mshr_latency - fast_path_stats.mshr_latency).getPS());
+         ++stats.fast_path_validated;
+      }
    }
 
 
@@ -603,6 +679,173 @@ MYLOG("access done");
    return hit_where;
 }
 
+// Is this an L1 hit that the fast path can handle? Returns NULL if the full controller is needed.
+CacheBlockInfo*
+CacheCntlr::checkFastPath(IntPtr ca_address, Core::mem_op_t mem_op_type)
+{
+   CacheBlockInfo *cache_block_info;
+   if (!operationPermissibleinCache(ca_address, mem_op_type, &cache_block_info))
+      return NULL;
+   // Warmup and prefetch bookkeeping is left to the full controller
+   if (cache_block_info->hasOption(CacheBlockInfo::WARMUP) || cache_block_info->hasOption(CacheBlockInfo::PREFETCH))
+      return NULL;
+   return cache_block_info;
+}
+
+// Same as checkFastPath, but without taking the set lock, so misses can go to the full controller cheaply.
+// The result is only a hint: the line may change as soon as we return.
+CacheBlockInfo*
+CacheCntlr::probeFastPath(IntPtr ca_address, Core::mem_op_t mem_op_type)
+{
+   // Other cores only change our lines (invalidations, downgrades) while holding the set lock exclusively,
+   // the sequence number tells us whether that happened while we were looking at the line
+   SetLock *set_lock = lastLevelCache()->m_master->getSetLock(ca_address);
+   UInt64 sequence;
+   if (!set_lock->read_begin(sequence))
+      return NULL;
+
+   CacheBlockInfo *cache_block_info = checkFastPath(ca_address, mem_op_type);
+
+   if (!set_lock->read_validate(sequence))
+      return NULL;
+   return cache_block_info;
+}
+
+// Latency of an L1 hit starting now: the data and tag access, plus any delay while the line is still in flight
+// (see updateHitLatency, which the full controller uses). Does not change any state. Caller holds getLock().
+CacheCntlr::FastPathHit
+CacheCntlr::predictFastPathHit(Core::mem_op_t mem_op_type, IntPtr ca_address, bool modeled)
+{
+   FastPathHit hit = FastPathHit();
+   SubsecondTime t_start = getShmemPerfModel()->getElapsedTime(ShmemPerfModel::_USER_THREAD);
+   SubsecondTime t_now = t_start + getMemoryManager()->getCost(m_mem_component, CachePerfModel::ACCESS_CACHE_DATA_AND_TAGS);
+
+   if (modeled)
+   {
+      if (m_l1_mshr)
+      {
+         SubsecondTime t_completed = m_master->m_l1_mshr.getTagCompletionTime(ca_address);
+         if (t_completed != SubsecondTime::MaxTime() && t_completed > t_now)
+         {
+            ++hit.overlapping_misses;
+            t_now = t_completed;
+         }
+      }
+
+      Mshr::const_iterator it = m_master->mshr.find(ca_address);
+      if (it != m_master->mshr.end() && it->second.t_issue < t_now && it->second.t_complete > t_now)
+      {
+         hit.mshr_latency = it->second.t_complete - t_now;
+         t_now = it->second.t_complete;
+      }
+   }
+
+   hit.latency = t_now - t_start;
+   return hit;
+}
+
+// L1 hit in a permissible state: does the same as processMemOpFromCore does for such a hit,
+// but with a single acquisition of the controller lock.
+// Returns false, having done nothing, if this is not such a hit.
+bool
+CacheCntlr::processMemOpFromCoreFast(
+      Core::mem_op_t mem_op_type,
+      IntPtr ca_address, UInt32 offset,
+      Byte* data_buf, UInt32 data_length,
+      bool modeled,
+      bool count)
+{
+   if (!probeFastPath(ca_address, mem_op_type))
+      return false;
+
+   // Hold the set lock while accessing the data, such that the line cannot be invalidated or written back
+   // from under us. If it changed since the probe, leave it to the full controller.
+   acquireLock(ca_address);
+   CacheBlockInfo *cache_block_info = checkFastPath(ca_address, mem_op_type);
+   if (!cache_block_info)
+   {
+      releaseLock(ca_address);
+      return false;
+   }
+
+   HitWhere::where_t hit_where = HitWhere::where_t(m_mem_component);
+   SubsecondTime t_start = getShmemPerfModel()->getElapsedTime(ShmemPerfModel::_USER_THREAD);
+
+   {
+      ScopedLock sl(getLock());
+
+      if (count)
+      {
+         getCache()->updateCounters(true);
+         updateCounters(mem_op_type, ca_address, true, getCacheState(cache_block_info), Prefetch::NONE);
+      }
+
+      FastPathHit hit = predictFastPathHit(mem_op_type, ca_address, modeled);
+      getShmemPerfModel()->incrElapsedTime(hit.latency, ShmemPerfModel::_USER_THREAD);
+      if (mem_op_type == Core::WRITE)
+         stats.store_overlapping_misses += hit.overlapping_misses;
+      else
+         stats.load_overlapping_misses += hit.overlapping_misses;
+      stats.mshr_latency += hit.mshr_latency;
+
+      #ifdef TRACK_LATENCY_BY_HITWHERE
+      if (count)
+         lat_by_where[hit_where].update(hit.latency.getNS());
+      #endif
+
+      if (mem_op_type == Core::WRITE)
+         stats.stores_where[hit_where]++;
+      else
+         stats.loads_where[hit_where]++;
+      ++stats.fast_path_hits;
+   }
+
+   accessCache(mem_op_type, ca_address, offset, data_buf, data_length, count);
+
+   releaseLock(ca_address);
+
+   // Next-level caches may have prefetches queued
+   if (modeled)
+      Prefetch(t_start);
+
+   if (Sim()->getConfig()->getCacheEfficiencyCallbacks().notify_access_func)
+      Sim()->getConfig()->getCacheEfficiencyCallbacks().call_notify_access(cache_block_info->getOwner(), mem_op_type, hit_where);
+
+   return true;
+}
+
+// Delay a hit when the line is still in flight: an earlier miss in the L1 MSHR, or a prefetch completing in the future.
+// Caller holds getLock().
+void
+CacheCntlr::updateHitLatency(Core::mem_op_t mem_op_type, IntPtr ca_address)
+{
+   if (m_l1_mshr)
+   {
+      SubsecondTime t_now = getShmemPerfModel()->getElapsedTime(ShmemPerfModel::_USER_THREAD);
+      SubsecondTime t_completed = m_master->m_l1_mshr.getTagCompletionTime(ca_address);
+      if (t_completed != SubsecondTime::MaxTime() && t_completed > t_now)
+      {
+         if (mem_op_type == Core::WRITE)
+            ++stats.store_overlapping_misses;
+         else
+            ++stats.load_overlapping_misses;
+
+         SubsecondTime latency = t_completed - t_now;
+         getShmemPerfModel()->incrElapsedTime(latency, ShmemPerfModel::_USER_THREAD);
+      }
+   }
+
+   // This is a hit, but maybe the prefetcher filled it at a future time stamp. If so, delay.
+   SubsecondTime t_now = getShmemPerfModel()->getElapsedTime(ShmemPerfModel::_USER_THREAD);
+   if (m_master->mshr.count(ca_address)
+      && (m_master->mshr[ca_address].t_issue < t_now && m_master->mshr[ca_address].t_complete > t_now))
+   {
+      SubsecondTime latency = m_master->mshr[ca_address].t_complete - t_now;
+      stats.mshr_latency += latency;
+      getMemoryManager()->incrElapsedTime(latency, ShmemPerfModel::_USER_THREAD);
+   }
+}
+
 
 void
 CacheCntlr::updateHits(Core::mem_op_t mem_op_type, UInt64 hits)
@@ -1704,7 +1947,7 @@ MYLOG(" ");
       MYLOG("writing to evict buffer %lx", address);
 assert(offset==0);
 assert(data_length==getCacheBlockSize());
-      if (data_buf)
+      if (data_buf && !Sim()->getConfig()->getTimingOnlyMemory())
          memcpy(m_master->m_evicting_buf + offset, data_buf, data_length);
    } else {
       __attribute__((unused)) SharedCacheBlockInfo* cache_block_info = (SharedCacheBlockInfo*) m_master->m_cache->accessSingleLine(
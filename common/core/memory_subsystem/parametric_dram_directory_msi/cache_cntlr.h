@@ -214,6 +214,8 @@ namespace ParametricDramDirectoryMSI
          bool m_coherent;
          bool m_prefetch_on_prefetch_hit;
          bool m_l1_mshr;
+         bool m_fast_path;            //< L1 hits that need no coherence action skip the full controller (processMemOpFromCoreFast)
+         bool m_fast_path_validate;   //< Instead, run the full controller and check that it agrees with the fast path
 
          struct {
            UInt64 loads, stores;
@@ -238,6 +240,7 @@ namespace ParametricDramDirectoryMSI
            SubsecondTime qbs_query_latency;
            SubsecondTime mshr_latency;
            UInt64 prefetches;
+           UInt64 fast_path_hits, fast_path_validated;
            UInt64 coherency_downgrades, coherency_upgrades, coherency_invalidates, coherency_writebacks;
            #ifdef ENABLE_TRANSITIONS
            UInt64 transitions[CacheState::NUM_CSTATE_SPECIAL_STATES][CacheState::NUM_CSTATE_SPECIAL_STATES];
@@ -250,6 +253,7 @@ namespace ParametricDramDirectoryMSI
          #endif
 
          void updateCounters(Core::mem_op_t mem_op_type, IntPtr address, bool cache_hit, CacheState::cstate_t state, Prefetch::prefetch_type_t isPrefetch);
+         void updateHitLatency(Core::mem_op_t mem_op_type, IntPtr ca_address);
          void cleanupMshr();
          void transition(IntPtr address, Transition::reason_t reason, CacheState::cstate_t old_state, CacheState::cstate_t new_state);
          void updateUncoreStatistics(HitWhere::where_t hit_where, SubsecondTime now);
@@ -282,6 +286,22 @@ namespace ParametricDramDirectoryMSI
                Byte* data_buf, UInt32 data_length, bool update_replacement);
          bool operationPermissibleinCache(
                IntPtr address, Core::mem_op_t mem_op_type, CacheBlockInfo **cache_block_info = NULL);
+         // Latency of an L1 hit, and the hit latency statistics it adds, as accounted by the fast path
+         struct FastPathHit
+         {
+            SubsecondTime latency;
+            UInt64 overlapping_misses;
+            SubsecondTime mshr_latency;
+         };
+         CacheBlockInfo* checkFastPath(IntPtr ca_address, Core::mem_op_t mem_op_type);
+         CacheBlockInfo* probeFastPath(IntPtr ca_address, Core::mem_op_t mem_op_type);
+         FastPathHit predictFastPathHit(Core::mem_op_t mem_op_type, IntPtr ca_address, bool modeled);
+         bool processMemOpFromCoreFast(
+               Core::mem_op_t mem_op_type,
+               IntPtr ca_address, UInt32 offset,
+               Byte* data_buf, UInt32 data_length,
+               bool modeled,
+               bool count);
 
          void copyDataFromNextLevel(Core::mem_op_t mem_op_type, IntPtr address, bool modeled, SubsecondTime t_start);
          void trainPrefetcher(IntPtr address, bool cache_hit, bool prefetch_hit, SubsecondTime t_issue);
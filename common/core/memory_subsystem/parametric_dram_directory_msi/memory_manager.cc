@@ -66,6 +66,8 @@ MemoryManager::MemoryManager(Core* core,
    try
    {
       m_cache_block_size = Sim()->getCfg()->getInt("perf_model/l1_icache/cache_block_size");
+      if (Sim()->getConfig()->getTimingOnlyMemory())
+         PrL1PrL2DramDirectoryMSI::ShmemMsg::setTimingOnly(m_cache_block_size);
 
       m_last_level_cache = (MemComponent::component_t)(Sim()->getCfg()->getInt("perf_model/cache/levels") - 2 + MemComponent::L2_CACHE);
 
@@ -526,7 +528,7 @@ MYLOG("begin");
    // First delete 'data_buf' if it is present
    // LOG_PRINT("Finished handling Shmem Msg");
 
-   if (shmem_msg->getDataLength() > 0)
+   if (shmem_msg->getDataLength() > 0 && !PrL1PrL2DramDirectoryMSI::ShmemMsg::isTimingOnly())
    {
       assert(shmem_msg->getDataBuf());
       delete [] shmem_msg->getDataBuf();
@@ -109,6 +109,8 @@ namespace ParametricDramDirectoryMSI
 
          UInt32 getModeledLength(const void* pkt_data)
          { return ((PrL1PrL2DramDirectoryMSI::ShmemMsg*) pkt_data)->getModeledLength(); }
+         UInt32 getOmittedLength(const void* pkt_data)
+         { return ((PrL1PrL2DramDirectoryMSI::ShmemMsg*) pkt_data)->getOmittedDataLength(); }
 
          SubsecondTime getCost(MemComponent::component_t mem_component, CachePerfModel::CacheAccess_t access_type);
          void incrElapsedTime(SubsecondTime latency, ShmemPerfModel::Thread_t thread_num = ShmemPerfModel::NUM_CORE_THREADS);
@@ -6,6 +6,7 @@
 #include "stats.h"
 #include "fault_injection.h"
 #include "shmem_perf.h"
+#include "config.hpp"
 
 #if 0
    extern Lock iolock;
@@ -25,6 +26,9 @@ DramCntlr::DramCntlr(MemoryManagerBase* memory_manager,
       ShmemPerfModel* shmem_perf_model,
       UInt32 cache_block_size)
    : DramCntlrInterface(memory_manager, shmem_perf_model, cache_block_size)
+   , m_dram_access_count(NULL)
+   , m_access_count_sampling(Sim()->getCfg()->getInt("perf_model/dram/access_count_sampling"))
+   , m_access_count_countdown(m_access_count_sampling)
    , m_reads(0)
    , m_writes(0)
 {
@@ -36,15 +40,19 @@ DramCntlr::DramCntlr(MemoryManagerBase* memory_manager,
       ? Sim()->getFaultinjectionManager()->getFaultInjector(memory_manager->getCore()->getId(), MemComponent::DRAM)
       : NULL;
 
-   m_dram_access_count = new AccessCountMap[DramCntlrInterface::NUM_ACCESS_TYPES];
+   if (m_access_count_sampling)
+      m_dram_access_count = new AccessCountMap[DramCntlrInterface::NUM_ACCESS_TYPES];
    registerStatsMetric("dram", memory_manager->getCore()->getId(), "reads", &m_reads);
    registerStatsMetric("dram", memory_manager->getCore()->getId(), "writes", &m_writes);
 }
 
 DramCntlr::~DramCntlr()
 {
-   printDramAccessCount();
-   delete [] m_dram_access_count;
+   if (m_dram_access_count)
+   {
+      printDramAccessCount();
+      delete [] m_dram_access_count;
+   }
 
    delete m_dram_perf_model;
 }
@@ -54,25 +62,20 @@ DramCntlr::getDataFromDram(IntPtr address, core_id_t requester, Byte* data_buf,
 {
    if (Sim()->getFaultinjectionManager())
    {
-      if (m_data_map.count(address) == 0)
-      {
-         m_data_map[address] = new Byte[getCacheBlockSize()];
-         memset((void*) m_data_map[address], 0x00, getCacheBlockSize());
-      }
+      Byte *data = m_data.get(address);
 
       // NOTE: assumes error occurs in memory. If we want to model bus errors, insert the error into data_buf instead
       if (m_fault_injector)
-         m_fault_injector->preRead(address, address, getCacheBlockSize(), (Byte*)m_data_map[address], now);
+         m_fault_injector->preRead(address, address, getCacheBlockSize(), data, now);
 
-      memcpy((void*) data_buf, (void*) m_data_map[address], getCacheBlockSize());
+      memcpy((void*) data_buf, (void*) data, getCacheBlockSize());
    }
 
    SubsecondTime dram_access_latency = runDramPerfModel(requester, now, address, READ, perf);
 
    ++m_reads;
-   #ifdef ENABLE_DRAM_ACCESS_COUNT
-   addToDramAccessCount(address, READ);
-   #endif
+   if (m_dram_access_count)
+      addToDramAccessCount(address, READ);
    MYLOG("R @ %08lx latency %s", address, itostr(dram_access_latency).c_str());
 
    return boost::tuple<SubsecondTime, HitWhere::where_t>(dram_access_latency, HitWhere::DRAM);
@@ -83,23 +86,19 @@ DramCntlr::putDataToDram(IntPtr address, core_id_t requester, Byte* data_buf, Su
 {
    if (Sim()->getFaultinjectionManager())
    {
-      if (m_data_map[address] == NULL)
-      {
-         LOG_PRINT_ERROR("Data Buffer does not exist");
-      }
-      memcpy((void*) m_data_map[address], (void*) data_buf, getCacheBlockSize());
+      Byte *data = m_data.get(address);
+      memcpy((void*) data, (void*) data_buf, getCacheBlockSize());
 
       // NOTE: assumes error occurs in memory. If we want to model bus errors, insert the error into data_buf instead
       if (m_fault_injector)
-         m_fault_injector->postWrite(address, address, getCacheBlockSize(), (Byte*)m_data_map[address], now);
+         m_fault_injector->postWrite(address, address, getCacheBlockSize(), data, now);
    }
 
    SubsecondTime dram_access_latency = runDramPerfModel(requester, now, address, WRITE, &m_dummy_shmem_perf);
 
    ++m_writes;
-   #ifdef ENABLE_DRAM_ACCESS_COUNT
-   addToDramAccessCount(address, WRITE);
-   #endif
+   if (m_dram_access_count)
+      addToDramAccessCount(address, WRITE);
    MYLOG("W @ %08lx", address);
 
    return boost::tuple<SubsecondTime, HitWhere::where_t>(dram_access_latency, HitWhere::DRAM);
@@ -116,7 +115,12 @@ DramCntlr::runDramPerfModel(core_id_t requester, SubsecondTime time, IntPtr addr
 void
 DramCntlr::addToDramAccessCount(IntPtr address, DramCntlrInterface::access_t access_type)
 {
-   m_dram_access_count[access_type][address] = m_dram_access_count[access_type][address] + 1;
+   if (--m_access_count_countdown == 0)
+   {
+      // Each sample stands for m_access_count_sampling accesses
+      m_dram_access_count[access_type][address] += m_access_count_sampling;
+      m_access_count_countdown = m_access_count_sampling;
+   }
 }
 
 void
@@ -1,8 +1,5 @@
 #pragma once
 
-// Define to re-enable DramAccessCount
-//#define ENABLE_DRAM_ACCESS_COUNT
-
 #include <unordered_map>
 
 #include "dram_perf_model.h"
@@ -12,6 +9,7 @@
 #include "memory_manager_base.h"
 #include "dram_cntlr_interface.h"
 #include "subsecond_time.h"
+#include "paged_memory.h"
 
 class FaultInjector;
 
@@ -20,12 +18,15 @@ namespace PrL1PrL2DramDirectoryMSI
    class DramCntlr : public DramCntlrInterface
    {
       private:
-         std::unordered_map<IntPtr, Byte*> m_data_map;
+         PagedMemory m_data;  //< Functional DRAM contents, only needed (and allocated) with fault injection
          DramPerfModel* m_dram_perf_model;
          FaultInjector* m_fault_injector;
 
+         // Per-line access counts, recorded for one in every m_access_count_sampling accesses (0 = disabled)
          typedef std::unordered_map<IntPtr,UInt64> AccessCountMap;
          AccessCountMap* m_dram_access_count;
+         UInt64 m_access_count_sampling;
+         UInt64 m_access_count_countdown;
          UInt64 m_reads, m_writes;
 
          ShmemPerf m_dummy_shmem_perf;
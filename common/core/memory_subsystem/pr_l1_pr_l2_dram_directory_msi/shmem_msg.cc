@@ -5,6 +5,10 @@
 
 namespace PrL1PrL2DramDirectoryMSI
 {
+   bool ShmemMsg::s_timing_only = false;
+   Byte* ShmemMsg::s_placeholder_buf = NULL;
+   UInt32 ShmemMsg::s_placeholder_length = 0;
+
    ShmemMsg::ShmemMsg(ShmemPerf* perf) :
       m_msg_type(INVALID_MSG_TYPE),
       m_sender_mem_component(MemComponent::INVALID_MEM_COMPONENT),
@@ -55,7 +59,12 @@ namespace PrL1PrL2DramDirectoryMSI
    {
       ShmemMsg* shmem_msg = new ShmemMsg(perf);
       memcpy((void*) shmem_msg, msg_buf, sizeof(*shmem_msg));
-      if (shmem_msg->getDataLength() > 0)
+      if (shmem_msg->getDataLength() > 0 && s_timing_only)
+      {
+         LOG_ASSERT_ERROR(shmem_msg->getDataLength() <= s_placeholder_length, "Data length (%u) exceeds timing-only placeholder (%u)", shmem_msg->getDataLength(), s_placeholder_length);
+         shmem_msg->setDataBuf(s_placeholder_buf);
+      }
+      else if (shmem_msg->getDataLength() > 0)
       {
          shmem_msg->setDataBuf(new Byte[shmem_msg->getDataLength()]);
          memcpy((void*) shmem_msg->getDataBuf(), msg_buf + sizeof(*shmem_msg), shmem_msg->getDataLength());
@@ -68,7 +77,7 @@ namespace PrL1PrL2DramDirectoryMSI
    {
       Byte* msg_buf = new Byte[getMsgLen()];
       memcpy(msg_buf, (void*) this, sizeof(*this));
-      if (m_data_length > 0)
+      if (m_data_length > 0 && !s_timing_only)
       {
          LOG_ASSERT_ERROR(m_data_buf != NULL, "m_data_buf(%p)", m_data_buf);
          memcpy(msg_buf + sizeof(*this), (void*) m_data_buf, m_data_length);
@@ -80,7 +89,21 @@ namespace PrL1PrL2DramDirectoryMSI
    UInt32
    ShmemMsg::getMsgLen()
    {
-      return (sizeof(*this) + m_data_length);
+      return (sizeof(*this) + m_data_length - getOmittedDataLength());
+   }
+
+   void
+   ShmemMsg::setTimingOnly(UInt32 max_data_length)
+   {
+      // Called while creating the memory managers, before any messages are sent
+      s_timing_only = true;
+      if (max_data_length > s_placeholder_length)
+      {
+         delete [] s_placeholder_buf;
+         s_placeholder_buf = new Byte[max_data_length];
+         memset(s_placeholder_buf, 0, max_data_length);
+         s_placeholder_length = max_data_length;
+      }
    }
 
    UInt32
@@ -51,6 +51,12 @@ namespace PrL1PrL2DramDirectoryMSI
          UInt32 m_data_length;
          ShmemPerf* m_perf;
 
+         // Timing-only mode (caching_protocol/timing_only): cache line data is not marshalled into messages,
+         // received messages point to a shared placeholder instead so checks on getDataBuf() != NULL still hold
+         static bool s_timing_only;
+         static Byte* s_placeholder_buf;
+         static UInt32 s_placeholder_length;
+
       public:
          ShmemMsg() = delete;
          ShmemMsg(ShmemPerf* perf);
@@ -70,8 +76,13 @@ namespace PrL1PrL2DramDirectoryMSI
          Byte* makeMsgBuf();
          UInt32 getMsgLen();
 
+         static void setTimingOnly(UInt32 max_data_length);
+         static bool isTimingOnly() { return s_timing_only; }
+
          // Modeling
          UInt32 getModeledLength();
+         // Data length represented by, but not included in, getMsgLen()
+         UInt32 getOmittedDataLength() { return s_timing_only ? m_data_length : 0; }
 
          msg_t getMsgType() { return m_msg_type; }
          MemComponent::component_t getSenderMemComponent() { return m_sender_mem_component; }
@@ -159,10 +159,9 @@ bool SyscallMdl::runEnter(IntPtr syscall_number, syscall_args_t &args)
       case SYS_wait4:
       {
          // System call is blocking, mark thread as asleep
-         ScopedLock sl(Sim()->getThreadManager()->getLock());
-         Sim()->getThreadManager()->stallThread_async(m_thread->getId(),
-                                                      syscall_number == SYS_pause ? ThreadManager::STALL_PAUSE : ThreadManager::STALL_SYSCALL,
-                                                      m_thread->getCore()->getPerformanceModel()->getElapsedTime());
+         Sim()->getThreadManager()->postStallThread(m_thread->getId(),
+                                                    syscall_number == SYS_pause ? ThreadManager::STALL_PAUSE : ThreadManager::STALL_SYSCALL,
+                                                    m_thread->getCore()->getPerformanceModel()->getElapsedTime());
          m_stalled = true;
          break;
       }
@@ -36,6 +36,7 @@ bool Config::m_suppress_stderr;
 bool Config::m_circular_log_enabled;
 bool Config::m_knob_enable_pinplay;
 bool Config::m_knob_enable_syscall_emulation;
+bool Config::m_knob_timing_only_memory;
 
 Config *Config::m_singleton;
 
@@ -111,6 +112,8 @@ Config::Config(SimulationMode mode)
    m_knob_enable_pinplay = Sim()->getCfg()->getBool("general/enable_pinplay");
    m_knob_enable_syscall_emulation = !m_knob_enable_pinplay && Sim()->getCfg()->getBool("general/enable_syscall_emulation");
 
+   m_knob_timing_only_memory = Sim()->getCfg()->getBool("caching_protocol/timing_only");
+
    m_knob_clock_skew_minimization_scheme = ClockSkewMinimizationObject::parseScheme(Sim()->getCfg()->getString("clock_skew_minimization/scheme"));
 
    m_total_cores = m_knob_total_cores;
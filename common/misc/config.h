@@ -89,6 +89,7 @@ public:
    bool suppressStderr() const { return m_suppress_stderr; }
    bool getEnablePinPlay() const { return m_knob_enable_pinplay; }
    bool getEnableSyscallEmulation() const { return m_knob_enable_syscall_emulation; }
+   bool getTimingOnlyMemory() const { return m_knob_timing_only_memory; }
 
    bool getBBVsEnabled() const { return m_knob_bbvs; }
    void setBBVsEnabled(bool enable) { m_knob_bbvs = enable; }
@@ -140,6 +141,7 @@ private:
    static bool m_circular_log_enabled;
    static bool m_knob_enable_pinplay;
    static bool m_knob_enable_syscall_emulation;
+   static bool m_knob_timing_only_memory;
 
    static CacheEfficiencyTracker::Callbacks m_cache_efficiency_callbacks;
 
@@ -1,35 +1,77 @@
 #include "lockfree_hash.h"
 
-LockFreeHash::LockFreeHash(UInt64 size) : BasicHash::BasicHash(size)
+LockFreeHash::LockFreeHash(UInt64 _size)
+   : size(1)
 {
+   while (size < _size)
+      size <<= 1;
+   array = new Entry[size];
+   for (UInt64 i = 0; i < size; i++)
+   {
+      array[i].key.store(0, std::memory_order_relaxed);
+      array[i].value.store(0, std::memory_order_relaxed);
+   }
 }
 
 LockFreeHash::~LockFreeHash()
 {
+   delete[] array;
 }
 
 
-UInt64 LockFreeHash::bucket_size(UInt64 key)
+UInt64 LockFreeHash::index(UInt64 key) const
 {
-   UInt64 index = key % size;
-   Bucket& bucket = array[index];
-   return bucket.size();
+   // Keys are often aligned addresses, mix all bits into the index
+   key ^= key >> 33;
+   key *= 0xff51afd7ed558ccdULL;
+   key ^= key >> 33;
+   return key & (size - 1);
 }
 
-std::pair<bool, UInt64> LockFreeHash::find(UInt64 key)
+UInt64 LockFreeHash::waitValue(Entry &entry) const
 {
-   std::pair<bool, UInt64> res = BasicHash::find(key);
-   assert(bucket_size(key) <= 1);
-
-   return res;
+   // The key is claimed before the value is written, another thread may still be completing its insert
+   UInt64 value;
+   while ((value = entry.value.load(std::memory_order_acquire)) == 0)
+      ;
+   return value;
 }
 
-bool LockFreeHash::insert(UInt64 key, UInt64 value)
+std::pair<bool, UInt64> LockFreeHash::find(UInt64 key) const
 {
-   bool res = BasicHash::insert(key, value);
-   assert(bucket_size(key) <= 1);
+   assert(key != 0);
+
+   for (UInt64 i = 0, idx = index(key); i < size; i++, idx = (idx + 1) & (size - 1))
+   {
+      UInt64 current = array[idx].key.load(std::memory_order_acquire);
+      if (current == key)
+         return std::make_pair(true, waitValue(array[idx]));
+      else if (current == 0)
+         break;
+   }
+   return std::make_pair(false, 0);
+}
 
-   return res;
+std::pair<bool, UInt64> LockFreeHash::insert(UInt64 key, UInt64 value)
+{
+   assert(key != 0 && value != 0);
+
+   for (UInt64 i = 0, idx = index(key); i < size; i++, idx = (idx + 1) & (size - 1))
+   {
+      UInt64 current = array[idx].key.load(std::memory_order_acquire);
+      if (current == 0)
+      {
+         if (array[idx].key.compare_exchange_strong(current, key, std::memory_order_acq_rel))
+         {
+            array[idx].value.store(value, std::memory_order_release);
+            return std::make_pair(true, value);
+         }
+         // Someone else claimed this slot first, current now holds their key
+      }
+      if (current == key)
+         return std::make_pair(false, waitValue(array[idx]));
+   }
+   return std::make_pair(false, 0);
 }
 
 
@@ -37,24 +79,22 @@ bool LockFreeHash::insert(UInt64 key, UInt64 value)
 
 int main(int argc, char* argv[])
 {
-   LockFreeHash hash(100);
+   LockFreeHash hash(4);
    UInt64 ids[4] = {1001, 1050, 1011, 1099};
 
    for (int i = 0; i < 4; i++)
-      hash.insert(ids[i], i);
+      assert(hash.insert(ids[i], i + 1).first == true);
 
    for (int i = 3; i >= 0; i--)
-      assert(hash.find(ids[i]).first == true);
-   cerr << "Test 1 passed" << endl;
+      assert(hash.find(ids[i]) == std::make_pair(true, UInt64(i + 1)));
+   std::cerr << "Test 1 passed" << std::endl;
 
+   assert(hash.insert(ids[0], 42) == std::make_pair(false, UInt64(1)));
+   assert(hash.insert(2002, 42) == std::make_pair(false, UInt64(0)));
+   assert(hash.find(2002).first == false);
+   std::cerr << "Test 2 passed" << std::endl;
 
-   cerr << "Test 2 should fail in assertion" << endl;
-   ids[3] = ids[0] + 100;
-
-   for (int i = 0; i < 4; i++)
-      hash.insert(ids[i], i);
-
-   cerr << "All tests passed" << endl;
+   std::cerr << "All tests passed" << std::endl;
 
    return 0;
 }
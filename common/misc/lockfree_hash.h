@@ -2,9 +2,8 @@
 #define LOCKFREE_HASH_H
 
 #include "fixed_types.h"
-#include "basic_hash.h"
 
-#include <map>
+#include <atomic>
 #include <utility>
 #include <iostream>
 #include <assert.h>
@@ -12,17 +11,32 @@
 //#define DEBUG_LOCKFREE_HASH
 
 
-class LockFreeHash : private BasicHash
+// Insert-only hash table, open addressing with linear probing into a fixed number of slots.
+// Lookups never lock or wait (except for an insert of the same key that is in progress), so the table
+// can be used to publish read-mostly data to many threads. Keys and values must be non-zero.
+class LockFreeHash
 {
    private:
-      UInt64 bucket_size(UInt64 key);
+      struct Entry
+      {
+         std::atomic<UInt64> key;
+         std::atomic<UInt64> value;
+      };
+
+      Entry *array;
+      UInt64 size;            // Power of two
+
+      UInt64 index(UInt64 key) const;
+      UInt64 waitValue(Entry &entry) const;
 
    public:
       LockFreeHash(UInt64 size);
       ~LockFreeHash();
 
-      std::pair<bool, UInt64> find(UInt64 key);
-      bool insert(UInt64 key, UInt64 value);
+      std::pair<bool, UInt64> find(UInt64 key) const;
+      // Insert key if it is not present yet. Returns whether we inserted it, and the value now associated with key:
+      // ours, or the one inserted first by another thread (0 if the table is full)
+      std::pair<bool, UInt64> insert(UInt64 key, UInt64 value);
 };
 
 #endif
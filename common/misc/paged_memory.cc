@@ -0,0 +1,56 @@
+#include "paged_memory.h"
+#include "log.h"
+
+#include <cstring>
+#include <sys/mman.h>
+
+PagedMemory::PagedMemory()
+   : m_last_table_index(0)
+   , m_last_table(NULL)
+   , m_num_chunks(0)
+{
+}
+
+PagedMemory::~PagedMemory()
+{
+   for(std::unordered_map<UInt64, Table*>::iterator it = m_tables.begin(); it != m_tables.end(); ++it)
+   {
+      for(UInt32 i = 0; i < TABLE_ENTRIES; ++i)
+         if (it->second->chunks[i])
+            munmap(it->second->chunks[i], CHUNK_SIZE);
+      delete it->second;
+   }
+}
+
+PagedMemory::Table*
+PagedMemory::getTable(UInt64 table_index)
+{
+   if (m_last_table && table_index == m_last_table_index)
+      return m_last_table;
+
+   Table* &table = m_tables[table_index];
+   if (!table)
+   {
+      table = new Table;
+      memset(table->chunks, 0, sizeof(table->chunks));
+   }
+
+   m_last_table_index = table_index;
+   m_last_table = table;
+   return table;
+}
+
+Byte*
+PagedMemory::get(IntPtr address)
+{
+   Table *table = getTable(UInt64(address) >> TABLE_SHIFT);
+   Byte* &chunk = table->chunks[(address >> CHUNK_SHIFT) & (TABLE_ENTRIES - 1)];
+   if (!chunk)
+   {
+      void *data = mmap(NULL, CHUNK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+      LOG_ASSERT_ERROR(data != MAP_FAILED, "Cannot map %" PRIu64 " bytes of backing store for address %" PRIxPTR, CHUNK_SIZE, address);
+      chunk = (Byte*)data;
+      ++m_num_chunks;
+   }
+   return chunk + (address & (CHUNK_SIZE - 1));
+}
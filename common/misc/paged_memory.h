@@ -0,0 +1,43 @@
+#ifndef PAGED_MEMORY_H
+#define PAGED_MEMORY_H
+
+#include "fixed_types.h"
+
+#include <unordered_map>
+
+// Sparse backing store for a (physical) address space. A two-level table maps each 1 GB region to an array of
+// 2 MB chunks, chunks are reserved with mmap(MAP_NORESERVE) the first time they are touched so the host only
+// commits (zero-filled) 4 KB pages that are actually used.
+class PagedMemory
+{
+   public:
+      PagedMemory();
+      ~PagedMemory();
+
+      // Pointer to the backing store for address, zero until written. Valid for accesses up to the end of the 2 MB chunk.
+      Byte* get(IntPtr address);
+
+      UInt64 getNumChunks() const { return m_num_chunks; }
+
+      static const UInt64 CHUNK_SIZE = 1 << 21;
+
+   private:
+      static const UInt32 CHUNK_SHIFT = 21;
+      static const UInt32 TABLE_SHIFT = 30;
+      static const UInt32 TABLE_ENTRIES = 1 << (TABLE_SHIFT - CHUNK_SHIFT);
+
+      struct Table
+      {
+         Byte* chunks[TABLE_ENTRIES];
+      };
+
+      std::unordered_map<UInt64, Table*> m_tables;
+      // Most accesses go to the same 1 GB region as the previous one
+      UInt64 m_last_table_index;
+      Table* m_last_table;
+      UInt64 m_num_chunks;
+
+      Table* getTable(UInt64 table_index);
+};
+
+#endif // PAGED_MEMORY_H
@@ -0,0 +1,138 @@
+#include "profiled_lock.h"
+#include "timer.h"
+
+ProfiledLock::ProfiledLock(String name)
+   : m_name(name)
+   , m_profiling(false)
+   , m_owner_site(NULL)
+   , m_hold_timer(NULL)
+   , m_posted(NULL)
+   , m_held(false)
+   , m_running_posted(false)
+{
+}
+
+ProfiledLock::~ProfiledLock()
+{
+   // TotalTimers are never deleted: they still need to be reported after we are gone
+   delete m_hold_timer;
+
+   for(Task *task = m_posted; task; )
+   {
+      Task *next = task->next;
+      delete task;
+      task = next;
+   }
+}
+
+void ProfiledLock::setProfiling(bool enabled)
+{
+   // Constructing the first Timer calibrates rdtsc, only pay for that when profiling is used
+   if (enabled && !m_hold_timer)
+      m_hold_timer = new Timer();
+   m_profiling = enabled;
+}
+
+ProfiledLock::Site *ProfiledLock::getSite(void *caller)
+{
+   std::unordered_map<void*, Site>::iterator it = m_sites.find(caller);
+   if (it == m_sites.end())
+   {
+      // Skip the TotalTimer constructor and getSite() in the backtrace, timertop.py also skips the next one (acquire())
+      // such that the call site is the first entry shown
+      Site site = { new TotalTimer("lock-wait:" + m_name, 2), new TotalTimer("lock-hold:" + m_name, 2) };
+      it = m_sites.insert(std::make_pair(caller, site)).first;
+   }
+   return &it->second;
+}
+
+// Not inlined, such that our return address identifies the call site
+__attribute__((noinline)) void ProfiledLock::acquire()
+{
+   if (!m_profiling)
+   {
+      Lock::acquire();
+      m_held = true;
+      return;
+   }
+
+   Timer wait_timer;
+   Lock::acquire();
+   m_held = true;
+   UInt64 wait_time = wait_timer.getTime();
+
+   Site *site = getSite(__builtin_return_address(0));
+   site->wait->add(wait_time, wait_timer.switched);
+   m_owner_site = site;
+   m_hold_timer->start();
+}
+
+void ProfiledLock::release()
+{
+   runPosted();
+
+   if (m_profiling && m_owner_site)
+   {
+      m_owner_site->hold->add(m_hold_timer->getTime(), m_hold_timer->switched);
+      m_owner_site = NULL;
+   }
+   Lock::release();
+}
+
+void ProfiledLock::post(const std::function<void()> &func)
+{
+   Task *task = new Task();
+   task->func = func;
+   task->next = m_posted.load();
+   while(!m_posted.compare_exchange_weak(task->next, task))
+      ;
+
+   // Pairs with runPosted(), which clears m_held before checking m_posted one last time:
+   // either the holder sees our task, or we see that nobody will run it for us
+   if (!m_held)
+   {
+      acquire();
+      release();
+   }
+}
+
+// Caller holds the lock
+void ProfiledLock::runPosted()
+{
+   // A task may release the lock temporarily (e.g. waiting on a condition variable), leave the rest to the outer call
+   if (m_running_posted)
+      return;
+   m_running_posted = true;
+
+   while(true)
+   {
+      Task *tasks = m_posted.exchange(NULL);
+      if (tasks == NULL)
+      {
+         m_held = false;
+         if (m_posted.load() == NULL)
+            break;
+         m_held = true;
+         continue;
+      }
+
+      // Run in posting order
+      Task *first = NULL;
+      while(tasks)
+      {
+         Task *next = tasks->next;
+         tasks->next = first;
+         first = tasks;
+         tasks = next;
+      }
+      while(first)
+      {
+         Task *next = first->next;
+         first->func();
+         delete first;
+         first = next;
+      }
+   }
+
+   m_running_posted = false;
+}
@@ -0,0 +1,63 @@
+#ifndef PROFILED_LOCK_H
+#define PROFILED_LOCK_H
+
+#include "lock.h"
+#include "fixed_types.h"
+
+#include <unordered_map>
+#include <functional>
+#include <atomic>
+
+class Timer;
+class TotalTimer;
+
+// Lock that, when profiling is enabled, measures (host) time spent waiting for and holding it, separately for each call site.
+// Each acquiring call site gets a pair of TotalTimers ("lock-wait:<name>" and "lock-hold:<name>") that are written to
+// sim_timers.out together with all other timers, use tools/timertop.py to resolve the call sites.
+// Profiling is off by default, in which case acquire() and release() only add a predictable branch.
+// Work that needs the lock but not its result can be post()ed, which does not wait for the lock when it is busy.
+class ProfiledLock : public Lock
+{
+   public:
+      ProfiledLock(String name);
+      ~ProfiledLock();
+
+      // Only change this while no other thread can be using the lock
+      void setProfiling(bool enabled);
+
+      void acquire();
+      void release();
+      void acquire_read() { acquire(); }
+      void release_read() { release(); }
+
+      // Run func while holding the lock, in the order of posting. If another thread holds the lock, it runs func
+      // before releasing it and we return right away, else we take the lock and run func ourselves.
+      void post(const std::function<void()> &func);
+
+   private:
+      struct Site
+      {
+         TotalTimer *wait;
+         TotalTimer *hold;
+      };
+      struct Task
+      {
+         std::function<void()> func;
+         Task *next;
+      };
+
+      const String m_name;
+      bool m_profiling;
+      // Protected by the lock itself
+      std::unordered_map<void*, Site> m_sites;
+      Site *m_owner_site;
+      Timer *m_hold_timer;
+      std::atomic<Task*> m_posted;     //< Tasks waiting to be run, most recently posted first
+      std::atomic<bool> m_held;        //< Someone holds the lock and will run m_posted before releasing it
+      bool m_running_posted;           //< Protected by the lock itself
+
+      Site *getSite(void *caller);
+      void runPosted();
+};
+
+#endif // PROFILED_LOCK_H
@@ -4,6 +4,9 @@
 _SetLock::_SetLock(UInt32 core_offset, UInt32 num_sharers)
    : m_locks(num_sharers)
    , m_core_offset(core_offset)
+   , m_sequence(0)
+   , m_exclusive_acquires(0)
+   , m_exclusive_contended(0)
 {
    #ifdef TIME_LOCKS
    _timer = TotalTimer::getTimerByStacktrace("setlock@" + itostr(this));
@@ -18,14 +21,21 @@ _SetLock::acquire_exclusive(void)
    ScopedTimer tt(*_timer);
    #endif
 
+   bool contended = false;
    for(std::vector<PersetLock>::iterator it = m_locks.begin(); it != m_locks.end(); ++it)
-      (*it).acquire();
+      contended |= (*it).acquire();
+
+   ++m_exclusive_acquires;
+   if (contended)
+      ++m_exclusive_contended;
+   write_begin();
 }
 
 // Release exclusive access
 void
 _SetLock::release_exclusive(void)
 {
+   write_end();
    for(std::vector<PersetLock>::iterator it = m_locks.begin(); it != m_locks.end(); ++it)
       (*it).release();
 }
@@ -40,7 +50,10 @@ _SetLock::acquire_shared(UInt32 core_id)
 
    assert(core_id >= m_core_offset);
    assert(core_id < m_core_offset + m_locks.size());
-   m_locks.at(core_id - m_core_offset).acquire();
+   PersetLock &lock = m_locks.at(core_id - m_core_offset);
+   if (lock.acquire())
+      ++lock.m_contended;
+   ++lock.m_acquires;
 }
 
 // Release shared access
@@ -60,7 +73,26 @@ _SetLock::upgrade(UInt32 core_id)
 void
 _SetLock::downgrade(UInt32 core_id)
 {
+   write_end();
    for(unsigned int i = 0; i < m_locks.size(); ++i)
       if (i != (core_id - m_core_offset))
          m_locks.at(i).release();
 }
+
+UInt64
+_SetLock::getAcquires() const
+{
+   UInt64 acquires = m_exclusive_acquires;
+   for(std::vector<PersetLock>::const_iterator it = m_locks.begin(); it != m_locks.end(); ++it)
+      acquires += (*it).m_acquires;
+   return acquires;
+}
+
+UInt64
+_SetLock::getContended() const
+{
+   UInt64 contended = m_exclusive_contended;
+   for(std::vector<PersetLock>::const_iterator it = m_locks.begin(); it != m_locks.end(); ++it)
+      contended += (*it).m_contended;
+   return contended;
+}
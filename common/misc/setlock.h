@@ -7,7 +7,13 @@
 #include <vector>
 #include <pthread.h>
 
-/* Cache set lock */
+/* Cache set lock
+
+   Each sharer (core) has its own mutex, shared access only takes the sharer's own mutex while exclusive access takes all of them.
+   Exclusive sections also increment a sequence number twice (odd while inside), so a sharer can check without taking any lock
+   that no exclusive section ran while it was reading (read_begin/read_validate, only valid for data that shared holders
+   other than the reader itself do not modify).
+   Acquisitions and contended acquisitions (where the mutex was not free) are counted for the stats. */
 
 class _SetLock
 {
@@ -20,23 +26,64 @@ class _SetLock
       void upgrade(UInt32 core_id);
       void downgrade(UInt32 core_id);
 
+      // Sequence lock read: returns false if an exclusive section is in progress, in which case the lock should be taken instead
+      bool read_begin(UInt64 &sequence) const
+      {
+         sequence = __atomic_load_n(&m_sequence, __ATOMIC_ACQUIRE);
+         return (sequence & 1) == 0;
+      }
+      // Returns true if no exclusive section started since read_begin
+      bool read_validate(UInt64 sequence) const
+      {
+         __atomic_thread_fence(__ATOMIC_ACQUIRE);
+         return __atomic_load_n(&m_sequence, __ATOMIC_RELAXED) == sequence;
+      }
+
+      UInt64 getAcquires() const;
+      UInt64 getContended() const;
+
    private:
       class PersetLock
       {
          public:
-            PersetLock() { pthread_mutex_init(&_mutx, NULL); }
-            void acquire() { pthread_mutex_lock(&_mutx); }
+            PersetLock() : m_acquires(0), m_contended(0) { pthread_mutex_init(&_mutx, NULL); }
+            // Returns true if we had to wait for the lock
+            bool acquire()
+            {
+               if (pthread_mutex_trylock(&_mutx) == 0)
+                  return false;
+               pthread_mutex_lock(&_mutx);
+               return true;
+            }
             void release() { pthread_mutex_unlock(&_mutx); }
+
+            // Shared acquisitions by this sharer, protected by _mutx
+            UInt64 m_acquires;
+            UInt64 m_contended;
          private:
             pthread_mutex_t _mutx;
       } __attribute__ ((aligned (64)));
 
       std::vector<PersetLock> m_locks;
       UInt32 m_core_offset;
+      // Written only while holding all of m_locks
+      UInt64 m_sequence;
+      UInt64 m_exclusive_acquires;
+      UInt64 m_exclusive_contended;
       #ifdef TIME_LOCKS
       TotalTimer* _timer;
       #endif
-};
+
+      void write_begin()
+      {
+         __atomic_store_n(&m_sequence, m_sequence + 1, __ATOMIC_RELAXED);
+         __atomic_thread_fence(__ATOMIC_RELEASE);
+      }
+      void write_end()
+      {
+         __atomic_store_n(&m_sequence, m_sequence + 1, __ATOMIC_RELEASE);
+      }
+} __attribute__ ((aligned (64))); // m_sequence is read by all sharers, keep it away from the neighbouring set's
 
 class _SELock : SELock
 {
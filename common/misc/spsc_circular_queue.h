@@ -0,0 +1,152 @@
+#ifndef SPSC_CIRCULAR_QUEUE_H
+#define SPSC_CIRCULAR_QUEUE_H
+
+#include "fixed_types.h"
+#include "lock.h"
+#include "cond.h"
+
+#include <atomic>
+
+// Bounded queue between exactly one producer thread and one consumer thread.
+// Unlike MTCircularQueue, push and pop do not take a lock: each side owns one index and publishes it
+// to the other side. A side only takes the lock to go to sleep on a full (producer) or empty (consumer)
+// queue after spinning for a while, so as long as the producer stays ahead no system calls are made.
+
+template <class T> class SPSCCircularQueue
+{
+   private:
+      static const UInt32 spin_count = 1000;
+
+      const UInt32 m_size;
+      T* const m_queue;
+      std::atomic<UInt32> m_first; // next element to be inserted here, written by the producer
+      UInt8 padding1[60];
+      std::atomic<UInt32> m_last;  // last element is here, written by the consumer
+      UInt8 padding2[60];
+      std::atomic<bool> m_producer_waiting;
+      std::atomic<bool> m_consumer_waiting;
+      std::atomic<bool> m_aborted;
+      Lock m_lock;
+      ConditionVariable m_cond;
+
+      template <class F> bool wait(std::atomic<bool> &waiting, F ready, bool abortable);
+      void wakeup(std::atomic<bool> &waiting);
+
+   public:
+      SPSCCircularQueue(UInt32 size = 63);
+      ~SPSCCircularQueue();
+      // Producer side: returns false, without inserting, once the queue was aborted
+      bool push_wait(const T& t);
+      // Consumer side
+      T pop_wait(void);
+      bool empty(void) const;
+      UInt32 size(void) const;
+      // Consumer side: make the producer's current and future push_wait calls fail
+      void abort(void);
+};
+
+template <class T>
+SPSCCircularQueue<T>::SPSCCircularQueue(UInt32 size)
+   // As in CircularQueue, we can hold at most m_size-1 elements
+   : m_size(size + 1)
+   , m_queue(new T[m_size])
+   , m_first(0)
+   , m_last(0)
+   , m_producer_waiting(false)
+   , m_consumer_waiting(false)
+   , m_aborted(false)
+{
+}
+
+template <class T>
+SPSCCircularQueue<T>::~SPSCCircularQueue()
+{
+   delete [] m_queue;
+}
+
+template <class T>
+template <class F>
+bool
+SPSCCircularQueue<T>::wait(std::atomic<bool> &waiting, F ready, bool abortable)
+{
+   for(UInt32 i = 0; i < spin_count; ++i)
+   {
+      if (abortable && m_aborted)
+         return false;
+      if (ready())
+         return true;
+   }
+
+   // Announce that we're going to sleep before checking one last time, the other side checks
+   // for sleepers after updating its index so one of us is sure to see the other
+   ScopedLock sl(m_lock);
+   waiting = true;
+   while(!ready() && !(abortable && m_aborted))
+      m_cond.wait(m_lock);
+   waiting = false;
+   return !(abortable && m_aborted);
+}
+
+template <class T>
+void
+SPSCCircularQueue<T>::wakeup(std::atomic<bool> &waiting)
+{
+   if (waiting)
+   {
+      ScopedLock sl(m_lock);
+      m_cond.broadcast();
+   }
+}
+
+template <class T>
+bool
+SPSCCircularQueue<T>::push_wait(const T& t)
+{
+   UInt32 first = m_first.load(std::memory_order_relaxed);
+   UInt32 next = (first + 1) % m_size;
+   if (!wait(m_producer_waiting, [&]() { return next != m_last; }, true /*abortable*/))
+      return false;
+
+   m_queue[first] = t;
+   m_first = next;
+   wakeup(m_consumer_waiting);
+   return true;
+}
+
+template <class T>
+T
+SPSCCircularQueue<T>::pop_wait()
+{
+   UInt32 last = m_last.load(std::memory_order_relaxed);
+   wait(m_consumer_waiting, [&]() { return last != m_first; }, false /*abortable*/);
+
+   T t = m_queue[last];
+   m_last = (last + 1) % m_size;
+   wakeup(m_producer_waiting);
+   return t;
+}
+
+template <class T>
+bool
+SPSCCircularQueue<T>::empty() const
+{
+   return m_first == m_last;
+}
+
+template <class T>
+UInt32
+SPSCCircularQueue<T>::size() const
+{
+   return (m_first + m_size - m_last) % m_size;
+}
+
+template <class T>
+void
+SPSCCircularQueue<T>::abort()
+{
+   m_aborted = true;
+   ScopedLock sl(m_lock);
+   m_cond.broadcast();
+}
+
+#endif //SPSC_CIRCULAR_QUEUE_H
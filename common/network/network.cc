@@ -477,6 +477,14 @@ UInt32 Network::getModeledLength(const NetPacket& pkt)
    }
 }
 
+UInt32 Network::getPacketLength(const NetPacket& pkt)
+{
+   if (pkt.type == SHARED_MEM_1)
+      return pkt.length + getCore()->getMemoryManager()->getOmittedLength(pkt.data);
+   else
+      return pkt.length;
+}
+
 // -- NetPacket
 
 NetPacket::NetPacket()
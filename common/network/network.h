@@ -101,6 +101,8 @@ class Network
 
       // Modeling
       UInt32 getModeledLength(const NetPacket& pkt);
+      // Length of the packet including data the memory subsystem does not carry in timing-only mode
+      UInt32 getPacketLength(const NetPacket& pkt);
 
    private:
       NetworkModel * _models[NUM_STATIC_NETWORKS];
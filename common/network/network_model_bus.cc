@@ -70,7 +70,7 @@ NetworkModelBus::routePacket(const NetPacket &pkt, std::vector<Hop> &nextHops)
       ScopedLock sl(_bus->_lock);
       _bus->_num_packets ++;
       _bus->_num_bytes += getNetwork()->getModeledLength(pkt);
-      t_recv = _bus->useBus(pkt.time, pkt.length, (subsecond_time_t*)&pkt.queue_delay);
+      t_recv = _bus->useBus(pkt.time, getNetwork()->getPacketLength(pkt), (subsecond_time_t*)&pkt.queue_delay);
    } else
       t_recv = pkt.time;
 
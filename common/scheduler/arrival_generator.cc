@@ -0,0 +1,193 @@
+/**
+ * arrival_generator
+ * This class implements the task arrival processes of the open system scheduler.
+ */
+
+#include "arrival_generator.h"
+#include "simulator.h"
+#include "config.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+/** create
+ * Instantiate the arrival process with the given name, configured from base.cfg.
+ * Place to add a new arrival process.
+ */
+ArrivalGenerator* ArrivalGenerator::create(String distribution) {
+    int arrivalRate = atoi(Sim()->getCfg()->getString("scheduler/open/arrivalRate").c_str());
+    UInt64 arrivalInterval = atol(Sim()->getCfg()->getString("scheduler/open/arrivalInterval").c_str());
+
+    if (arrivalRate < 1) {
+        cout << "\n[Scheduler] [Error]: arrivalRate must be at least 1" << endl;
+        exit (1);
+    }
+
+    if (distribution == "uniform") {
+        return new UniformArrivals(arrivalRate, arrivalInterval);
+    } else if (distribution == "explicit") {
+        return new ExplicitArrivals();
+    } else if (distribution == "poisson" || distribution == "mmpp") {
+        // The generation can either use a user-defined seed or generate a new seed for every execution.
+        int seed = Sim()->getCfg()->getInt("scheduler/open/distributionSeed");
+        if (seed == 0) {
+            // Set a "truely random" seed
+            std::random_device rd;
+            seed = rd();
+        }
+
+        if (distribution == "poisson") {
+            return new PoissonArrivals(seed, arrivalRate, arrivalInterval);
+        }
+
+        int states = Sim()->getCfg()->getInt("scheduler/open/mmpp/states");
+        if (states < 1) {
+            cout << "\n[Scheduler] [Error]: MMPP arrivals need at least one state" << endl;
+            exit (1);
+        }
+        std::vector<UInt64> stateIntervals;
+        std::vector<UInt64> stateDwellTimes;
+        for (int s = 0; s < states; s++) {
+            stateIntervals.push_back(Sim()->getCfg()->getIntArray("scheduler/open/mmpp/intervals", s));
+            stateDwellTimes.push_back(Sim()->getCfg()->getIntArray("scheduler/open/mmpp/dwell_times", s));
+        }
+        return new MMPPArrivals(seed, arrivalRate, stateIntervals, stateDwellTimes);
+    } else if (distribution == "trace") {
+        return new TraceArrivals(Sim()->getCfg()->getString("scheduler/open/arrivalLog"));
+    } else {
+        cout << "\n[Scheduler] [Error]: Unknown Workload Arrival Distribution: '" << distribution << "'" << endl;
+        exit (1);
+    }
+}
+
+
+UniformArrivals::UniformArrivals(int arrivalRate, UInt64 arrivalInterval)
+    : arrivalRate(arrivalRate), arrivalInterval(arrivalInterval) {}
+
+bool UniformArrivals::next(taskArrival &arrival) {
+    if (count % arrivalRate == 0 && count != 0) {
+        time += arrivalInterval;
+    }
+    count++;
+    arrival.time = time;
+    return true;
+}
+
+
+ExplicitArrivals::ExplicitArrivals() {}
+
+bool ExplicitArrivals::next(taskArrival &arrival) {
+    arrival.time = Sim()->getCfg()->getIntArray("scheduler/open/explicitArrivalTimes", count);
+    count++;
+    return true;
+}
+
+
+PoissonArrivals::PoissonArrivals(int seed, int arrivalRate, UInt64 arrivalInterval)
+    : generator(seed), expdistribution(1.0 / arrivalInterval), arrivalRate(arrivalRate) {
+    // The expected time between arrivals is the configured value "arrivalInterval".
+    generator(); // read one dummy value (first value was very like the seed: small seed -> small first arrival time, big seed -> big first arrival time. We do not want to have this.)
+}
+
+bool PoissonArrivals::next(taskArrival &arrival) {
+    if (count % arrivalRate == 0 && count != 0) {
+        time += (UInt64)expdistribution(generator);
+    }
+    count++;
+    arrival.time = time;
+    return true;
+}
+
+
+MMPPArrivals::MMPPArrivals(int seed, int arrivalRate, const std::vector<UInt64> &stateIntervals, const std::vector<UInt64> &stateDwellTimes)
+    : generator(seed), uniform(0.0, 1.0), arrivalRate(arrivalRate), stateIntervals(stateIntervals), stateDwellTimes(stateDwellTimes) {
+    generator(); // see PoissonArrivals
+    for (unsigned int s = 0; s < stateIntervals.size(); s++) {
+        if (stateIntervals.at(s) == 0 || stateDwellTimes.at(s) == 0) {
+            cout << "\n[Scheduler] [Error]: MMPP state " << s << " needs a non-zero interval and dwell time" << endl;
+            exit (1);
+        }
+    }
+    stateEnd = exponential(stateDwellTimes.at(state));
+}
+
+double MMPPArrivals::exponential(double mean) {
+    // 1 - u is in (0, 1], so the logarithm is always defined
+    return -mean * std::log(1.0 - uniform(generator));
+}
+
+bool MMPPArrivals::next(taskArrival &arrival) {
+    if (count % arrivalRate == 0 && count != 0) {
+        // Both the arrival process and the state sojourn are memoryless, so when the
+        // candidate arrival falls beyond the end of the current state, we can restart
+        // sampling in the next state from the state boundary.
+        while (true) {
+            double candidate = time + exponential(stateIntervals.at(state));
+            if (candidate <= stateEnd) {
+                time = candidate;
+                break;
+            }
+            time = stateEnd;
+            state = (state + 1) % stateIntervals.size();
+            stateEnd = time + exponential(stateDwellTimes.at(state));
+        }
+    }
+    count++;
+    arrival.time = (UInt64)time;
+    return true;
+}
+
+
+TraceArrivals::TraceArrivals(String filename)
+    : filename(filename), log(filename.c_str()) {
+    if (!log.is_open()) {
+        cout << "\n[Scheduler] [Error]: Could not open arrival log '" << filename << "'" << endl;
+        exit (1);
+    }
+}
+
+bool TraceArrivals::next(taskArrival &arrival) {
+    std::string line;
+    while (std::getline(log, line)) {
+        lineNumber++;
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream issLine(line);
+
+        std::string timestamp;
+        if (!(issLine >> timestamp) || timestamp[0] == '#') {
+            continue; // empty line or comment
+        }
+
+        UInt64 t;
+        std::string benchmark;
+        try {
+            t = std::stoull(timestamp);
+        } catch (const std::exception &e) {
+            cout << "\n[Scheduler] [Error]: Invalid timestamp '" << timestamp << "' in arrival log " << filename << ":" << lineNumber << endl;
+            exit (1);
+        }
+        if (first) {
+            firstTimestamp = t;
+            first = false;
+        } else if (t < lastTimestamp) {
+            cout << "\n[Scheduler] [Error]: Arrival log " << filename << ":" << lineNumber << " is not sorted by timestamp" << endl;
+            exit (1);
+        }
+        lastTimestamp = t;
+
+        arrival.time = t - firstTimestamp;
+        arrival.benchmark = (issLine >> benchmark) ? String(benchmark.c_str()) : "";
+        if (!(issLine >> arrival.parallelism)) {
+            arrival.parallelism = -1;
+        }
+        if (!(issLine >> arrival.priority)) {
+            arrival.priority = -1;
+        }
+        return true;
+    }
+    return false;
+}
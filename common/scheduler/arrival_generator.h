@@ -0,0 +1,119 @@
+/**
+ * arrival_generator
+ * This header implements the task arrival processes of the open system scheduler.
+ * Arrivals are generated lazily: the scheduler pulls the next arrival only when
+ * simulated time has caught up with the previous one.
+ */
+
+#ifndef __ARRIVAL_GENERATOR_H
+#define __ARRIVAL_GENERATOR_H
+
+#include "fixed_types.h"
+
+#include <fstream>
+#include <random>
+#include <vector>
+
+struct taskArrival {
+    UInt64 time = 0;          // arrival time in ns
+    String benchmark = "";    // benchmark name from an arrival log (empty if not known)
+    int parallelism = -1;     // requested parallelism from an arrival log (-1 if not known)
+    int priority = -1;        // priority from an arrival log (-1 if not known)
+};
+
+class ArrivalGenerator {
+public:
+    virtual ~ArrivalGenerator() {}
+
+    // Produce the next arrival. Returns false when the arrival process is exhausted.
+    virtual bool next(taskArrival &arrival) = 0;
+
+    // Whether successive arrivals have non-decreasing arrival times.
+    // Only then can the scheduler stop generating once it is ahead of simulated time.
+    virtual bool isMonotonic() const { return true; }
+
+    static ArrivalGenerator* create(String distribution);
+};
+
+/** Groups of "arrivalRate" tasks arrive every "arrivalInterval" ns. */
+class UniformArrivals : public ArrivalGenerator {
+public:
+    UniformArrivals(int arrivalRate, UInt64 arrivalInterval);
+    virtual bool next(taskArrival &arrival);
+
+private:
+    int arrivalRate;
+    UInt64 arrivalInterval;
+    UInt64 count = 0;
+    UInt64 time = 0;
+};
+
+/** Arrival times are taken from the configuration ("explicitArrivalTimes"), one per task. */
+class ExplicitArrivals : public ArrivalGenerator {
+public:
+    ExplicitArrivals();
+    virtual bool next(taskArrival &arrival);
+    virtual bool isMonotonic() const { return false; }
+
+private:
+    int count = 0;
+};
+
+/** Groups of "arrivalRate" tasks arrive with exponentially distributed inter-arrival times. */
+class PoissonArrivals : public ArrivalGenerator {
+public:
+    PoissonArrivals(int seed, int arrivalRate, UInt64 arrivalInterval);
+    virtual bool next(taskArrival &arrival);
+
+private:
+    std::mt19937 generator;
+    std::exponential_distribution<float> expdistribution;
+    int arrivalRate;
+    UInt64 count = 0;
+    UInt64 time = 0;
+};
+
+/**
+ * Markov-modulated Poisson process: a continuous-time Markov chain cycles through
+ * states, each with its own mean inter-arrival interval and mean dwell time.
+ * This models bursty load (e.g., a calm state and a burst state).
+ */
+class MMPPArrivals : public ArrivalGenerator {
+public:
+    MMPPArrivals(int seed, int arrivalRate, const std::vector<UInt64> &stateIntervals, const std::vector<UInt64> &stateDwellTimes);
+    virtual bool next(taskArrival &arrival);
+
+private:
+    std::mt19937 generator;
+    std::uniform_real_distribution<double> uniform;
+    int arrivalRate;
+    std::vector<UInt64> stateIntervals;
+    std::vector<UInt64> stateDwellTimes;
+    unsigned int state = 0;
+    double stateEnd;
+    double time = 0;
+    UInt64 count = 0;
+    double exponential(double mean);
+};
+
+/**
+ * Replays a production arrival log. Each non-empty line that does not start with '#' holds
+ *   <timestamp in ns> [<benchmark> [<parallelism> [<priority>]]]
+ * separated by whitespace or commas. Timestamps are relative to the first entry.
+ * A parallelism widens the core reservation of the task to that of the benchmark at this thread count.
+ */
+class TraceArrivals : public ArrivalGenerator {
+public:
+    TraceArrivals(String filename);
+    virtual bool next(taskArrival &arrival);
+
+private:
+    String filename;
+    std::ifstream log;
+    int lineNumber = 0;
+    bool first = true;
+    UInt64 firstTimestamp = 0;
+    UInt64 lastTimestamp = 0;
+};
+
+#endif
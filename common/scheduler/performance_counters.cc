@@ -1,4 +1,6 @@
 #include "performance_counters.h"
+#include "simulator.h"
+#include "heartbeat_manager.h"
 
 #include <fstream>
 #include <sstream>
@@ -252,7 +254,24 @@ double PerformanceCounters::getRvalueOfCore (int coreId) const {
     return *std::min_element(r_values.begin(), r_values.end());
 }
 
+/**
+ * Notify which task is mapped to each core (-1 for unassigned cores)
+ */
+void PerformanceCounters::notifyTasksOfCores(std::vector<int> newTaskIds) {
+    taskIds = newTaskIds;
+}
+
+/** getLastBeat
+ * Return the timestamp (in ns) of the last heartbeat of the given app.
+ * Uses the simulator-side heartbeat tracking, and falls back to parsing the
+ * heartbeat library's text log for applications that did not report natively.
+ */
 int PerformanceCounters::getLastBeat(int appId) const {
+	HeartbeatManager *heartbeatManager = Sim()->getHeartbeatManager();
+	if (heartbeatManager->getBeats(appId) > 0) {
+		return heartbeatManager->getLastBeatTime(appId).getNS();
+	}
+
 	std::string target = std::to_string(appId) + ".hb.log";
 	std::ifstream appIdHbLogfile(target);
 	if (!appIdHbLogfile.is_open()) {
@@ -289,3 +308,37 @@ int PerformanceCounters::getLastBeat(int appId) const {
 
   return -1;
 }
+
+/**
+ * Return whether the given app declared a target heart-rate window.
+ */
+bool PerformanceCounters::hasQoSTarget(int appId) const {
+    return Sim()->getHeartbeatManager()->hasTarget(appId);
+}
+
+/**
+ * Return the window heart rate (in beats per second) of the given app.
+ */
+double PerformanceCounters::getHeartRateOfApp(int appId) const {
+    return Sim()->getHeartbeatManager()->getWindowRate(appId);
+}
+
+/**
+ * Return the QoS slack of the given app: < 0 when the app runs below its
+ * minimum target heart rate, > 0 when it runs above its maximum target heart
+ * rate, and 0 inside the target window or without a target.
+ */
+double PerformanceCounters::getQoSSlackOfApp(int appId) const {
+    return Sim()->getHeartbeatManager()->getSlack(appId);
+}
+
+/**
+ * Return the QoS slack of the task mapped to the given core, or 0 if the
+ * core is unassigned.
+ */
+double PerformanceCounters::getQoSSlackOfCore(int coreId) const {
+    if (coreId >= (int)taskIds.size() || taskIds.at(coreId) == -1) {
+        return 0;
+    }
+    return getQoSSlackOfApp(taskIds.at(coreId));
+}
@@ -27,11 +27,17 @@ public:
     double getRvalueOfCore (int coreId) const;
 
     void notifyFreqsOfCores(std::vector<int> frequencies);
+    void notifyTasksOfCores(std::vector<int> taskIds);
 
     int getLastBeat(int appId) const;
+    bool hasQoSTarget(int appId) const;
+    double getHeartRateOfApp(int appId) const;
+    double getQoSSlackOfApp(int appId) const;
+    double getQoSSlackOfCore(int coreId) const;
 
 private:
     std::vector<int> frequencies;
+    std::vector<int> taskIds;
 
     std::string outputDir;
     std::string instPowerFileName;
@@ -0,0 +1,26 @@
+#include "admissionTSP.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+AdmissionTSP::AdmissionTSP(const ThermalModel *thermalModel, float minCorePower)
+	: thermalModel(thermalModel), minCorePower(minCorePower) {
+
+}
+
+bool AdmissionTSP::admit(String taskName, int taskCoreRequirement, const std::vector<bool> &activeCores) {
+	int amtActiveCores = count(activeCores.begin(), activeCores.end(), true) + taskCoreRequirement;
+
+	// The task is not mapped yet, so assume the worst-case placement of its cores
+	double tsp = thermalModel->worstCaseTSP(amtActiveCores);
+	bool admitted = tsp >= minCorePower;
+
+	cout << "[Scheduler][AdmissionTSP]: " << taskName << " with " << taskCoreRequirement << " cores:";
+	cout << " TSP for " << amtActiveCores << " active cores is " << fixed << setprecision(3) << tsp << " W";
+	cout << " (required: " << fixed << setprecision(3) << minCorePower << " W)";
+	cout << (admitted ? " -> admitted" : " -> stays queued") << endl;
+
+	return admitted;
+}
@@ -0,0 +1,23 @@
+/**
+ * This header implements the TSP admission policy.
+ * A task is admitted only if the Thermal Safe Power per core, with the task's cores active
+ * in addition to the currently active ones, still allows each core to draw the given minimum power.
+ */
+
+#ifndef __ADMISSION_TSP_H
+#define __ADMISSION_TSP_H
+
+#include "admissionpolicy.h"
+#include "thermalModel.h"
+
+class AdmissionTSP : public AdmissionPolicy {
+public:
+    AdmissionTSP(const ThermalModel *thermalModel, float minCorePower);
+    virtual bool admit(String taskName, int taskCoreRequirement, const std::vector<bool> &activeCores);
+
+private:
+    const ThermalModel *thermalModel;
+    float minCorePower;
+};
+
+#endif
@@ -0,0 +1,19 @@
+/**
+ * This header implements the AdmissionPolicy interface.
+ * An admission policy decides whether a task in front of the queue may start now,
+ * or has to stay queued (e.g., because starting it would violate a power budget).
+ */
+
+#ifndef __ADMISSIONPOLICY_H
+#define __ADMISSIONPOLICY_H
+
+#include "fixed_types.h"
+#include <vector>
+
+class AdmissionPolicy {
+public:
+    virtual ~AdmissionPolicy() {}
+    virtual bool admit(String taskName, int taskCoreRequirement, const std::vector<bool> &activeCores) = 0;
+};
+
+#endif
@@ -0,0 +1,82 @@
+#include "dvfsHeartbeat.h"
+
+#include <iomanip>
+#include <iostream>
+using namespace std;
+DVFSHeartbeat::DVFSHeartbeat(const PerformanceCounters *performanceCounters,
+                             int coreRows, int coreColumns, int minFrequency,
+                             int maxFrequency, int frequencyStepSize,
+                             float slackTolerance,
+                             float catchupSlackStep,
+                             float dtmCriticalTemperature,
+                             float dtmRecoveredTemperature)
+    : performanceCounters(performanceCounters),
+      coreRows(coreRows),
+      coreColumns(coreColumns),
+      minFrequency(minFrequency),
+      maxFrequency(maxFrequency),
+      frequencyStepSize(frequencyStepSize),
+      slackTolerance(slackTolerance),
+      catchupSlackStep(catchupSlackStep),
+      dtmCriticalTemperature(dtmCriticalTemperature),
+      dtmRecoveredTemperature(dtmRecoveredTemperature) {}
+std::vector<int> DVFSHeartbeat::getFrequencies(
+    const std::vector<int> &oldFrequencies,
+    const std::vector<bool> &activeCores) {
+    if (throttle()) {
+        std::vector<int> minFrequencies(coreRows * coreColumns, minFrequency);
+        cout << "[Scheduler][heartbeat-DTM]: in throttle mode -> return min. frequencies " << endl;
+        return minFrequencies;
+    }
+
+    std::vector<int> frequencies(coreRows * coreColumns);
+    for (unsigned int coreCounter = 0; coreCounter < coreRows * coreColumns;
+         coreCounter++) {
+        if (!activeCores.at(coreCounter)) {
+            frequencies.at(coreCounter) = minFrequency;
+            continue;
+        }
+
+        int frequency = oldFrequencies.at(coreCounter);
+        double slack = performanceCounters->getQoSSlackOfCore(coreCounter);
+        cout << "[Scheduler][heartbeat]: Core " << setw(2) << coreCounter
+             << ":";
+        cout << " f=" << frequency << " MHz";
+        cout << " slack=" << fixed << setprecision(3) << slack << endl;
+
+        if (slack > slackTolerance) {
+            // ahead of the target window: save power
+            frequency -= frequencyStepSize;
+            if (frequency < minFrequency) {
+                frequency = minFrequency;
+            }
+        } else if (slack < -slackTolerance) {
+            // behind the target window: catch up faster the further behind we are,
+            // one extra frequency step per catchupSlackStep of slack
+            int steps = 1 + (int)(-slack / catchupSlackStep);
+            frequency += steps * frequencyStepSize;
+            if (frequency > maxFrequency) {
+                frequency = maxFrequency;
+            }
+        }
+        frequencies.at(coreCounter) = frequency;
+    }
+    return frequencies;
+}
+bool DVFSHeartbeat::throttle() {
+    if (performanceCounters->getPeakTemperature() > dtmCriticalTemperature) {
+        if (!in_throttle_mode) {
+            cout << "[Scheduler][heartbeat-DTM]: detected thermal violation"
+                 << endl;
+        }
+        in_throttle_mode = true;
+    } else if (performanceCounters->getPeakTemperature() <
+               dtmRecoveredTemperature) {
+        if (in_throttle_mode) {
+            cout << "[Scheduler][heartbeat-DTM]: thermal violation ended"
+                 << endl;
+        }
+        in_throttle_mode = false;
+    }
+    return in_throttle_mode;
+}
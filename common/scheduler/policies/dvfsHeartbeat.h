@@ -0,0 +1,39 @@
+/**
+ * This header implements a heartbeat-driven QoS governor with DTM.
+ * Applications declare a target heart-rate window (SimHeartbeatTarget);
+ * cores of applications running ahead of their window are scaled down,
+ * cores of applications falling behind are scaled up. Cores of applications
+ * inside their window, or without a heartbeat target, keep their frequency.
+ */
+#ifndef __DVFS_HEARTBEAT_H
+#define __DVFS_HEARTBEAT_H
+#include <vector>
+
+#include "dvfspolicy.h"
+#include "performance_counters.h"
+class DVFSHeartbeat : public DVFSPolicy {
+   public:
+    DVFSHeartbeat(const PerformanceCounters *performanceCounters, int coreRows,
+                  int coreColumns, int minFrequency, int maxFrequency,
+                  int frequencyStepSize, float slackTolerance,
+                  float catchupSlackStep,
+                  float dtmCriticalTemperature, float dtmRecoveredTemperature);
+    virtual std::vector<int> getFrequencies(
+        const std::vector<int> &oldFrequencies,
+        const std::vector<bool> &activeCores);
+
+   private:
+    const PerformanceCounters *performanceCounters;
+    unsigned int coreRows;
+    unsigned int coreColumns;
+    int minFrequency;
+    int maxFrequency;
+    int frequencyStepSize;
+    float slackTolerance;
+    float catchupSlackStep;
+    float dtmCriticalTemperature;
+    float dtmRecoveredTemperature;
+    bool in_throttle_mode = false;
+    bool throttle();
+};
+#endif
@@ -0,0 +1,36 @@
+#include "gatingIdleTimeout.h"
+#include <algorithm>
+
+using namespace std;
+
+GatingIdleTimeout::GatingIdleTimeout(UInt64 idleTimeout, int spareCores)
+	: idleTimeout(idleTimeout), spareCores(spareCores) {
+
+}
+
+std::vector<bool> GatingIdleTimeout::gate(const std::vector<bool> &idleCores, const std::vector<bool> &gatedCores, const std::vector<UInt64> &idleTimes) {
+	std::vector<bool> gated = gatedCores;
+
+	int poweredIdleCores = 0;
+	std::vector<int> candidates;
+	for (unsigned int c = 0; c < idleCores.size(); c++) {
+		if (idleCores.at(c) && !gatedCores.at(c)) {
+			poweredIdleCores++;
+			if (idleTimes.at(c) >= idleTimeout) {
+				candidates.push_back(c);
+			}
+		}
+	}
+
+	// gate the cores that have been idle longest, keep the most recently used ones as spares
+	stable_sort(candidates.begin(), candidates.end(), [&idleTimes](int a, int b) { return idleTimes.at(a) > idleTimes.at(b); });
+	for (const int &c : candidates) {
+		if (poweredIdleCores <= spareCores) {
+			break;
+		}
+		gated.at(c) = true;
+		poweredIdleCores--;
+	}
+
+	return gated;
+}
@@ -0,0 +1,22 @@
+/**
+ * This header implements the idle timeout power gating policy.
+ * A core is gated once it has been idle for the given timeout, except for a number of spare
+ * idle cores that are kept powered such that arriving tasks can start without wake-up latency.
+ */
+
+#ifndef __GATING_IDLE_TIMEOUT_H
+#define __GATING_IDLE_TIMEOUT_H
+
+#include "powergatingpolicy.h"
+
+class GatingIdleTimeout : public PowerGatingPolicy {
+public:
+    GatingIdleTimeout(UInt64 idleTimeout, int spareCores);
+    virtual std::vector<bool> gate(const std::vector<bool> &idleCores, const std::vector<bool> &gatedCores, const std::vector<UInt64> &idleTimes);
+
+private:
+    UInt64 idleTimeout;
+    int spareCores;
+};
+
+#endif
@@ -16,12 +16,15 @@ MapFirstUnused::MapFirstUnused(unsigned int coreRows, unsigned int coreColumns,
 std::vector<int> MapFirstUnused::map(String taskName, int taskCoreRequirement, const std::vector<bool> &availableCores, const std::vector<bool> &activeCores) {
 	std::vector<int> cores;
 
-	// try to fill with preferred cores
-	for (const int &c : preferredCoresOrder) {
-		if (availableCores.at(c)) {
-			cores.push_back(c);
-			if ((int)cores.size() == taskCoreRequirement) {
-				return cores;
+	// try to fill with preferred cores, powered cores first to avoid wake-up latency
+	for (int pass = 0; pass < 2; pass++) {
+		bool gated = pass == 1;
+		for (const int &c : preferredCoresOrder) {
+			if (availableCores.at(c) && isGated(c) == gated) {
+				cores.push_back(c);
+				if ((int)cores.size() == taskCoreRequirement) {
+					return cores;
+				}
 			}
 		}
 	}
@@ -13,6 +13,15 @@ class MappingPolicy {
 public:
     virtual ~MappingPolicy() {}
     virtual std::vector<int> map(String taskName, int taskCoreRequirement, const std::vector<bool> &availableCores, const std::vector<bool> &activeCores) = 0;
+
+    // The scheduler shares the power gating state of the cores, such that policies can avoid the wake-up cost of gated cores
+    void setGatedCores(const std::vector<bool> *gatedCores) { this->gatedCores = gatedCores; }
+
+protected:
+    bool isGated(int coreId) const { return gatedCores != NULL && gatedCores->at(coreId); }
+
+private:
+    const std::vector<bool> *gatedCores = NULL;
 };
 
 #endif
\ No newline at end of file
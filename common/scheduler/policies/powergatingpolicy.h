@@ -0,0 +1,20 @@
+/**
+ * This header implements the PowerGatingPolicy interface.
+ * A power gating policy decides which idle cores are put into a deep C-state (power gated).
+ */
+
+#ifndef __POWERGATINGPOLICY_H
+#define __POWERGATINGPOLICY_H
+
+#include "fixed_types.h"
+#include <vector>
+
+class PowerGatingPolicy {
+public:
+    virtual ~PowerGatingPolicy() {}
+    // Returns the new gating state of all cores. Only cores in "idleCores" (not assigned to a task) can be gated;
+    // "idleTimes" is the time in ns that each core has been idle. Waking a gated core costs wake-up latency and energy.
+    virtual std::vector<bool> gate(const std::vector<bool> &idleCores, const std::vector<bool> &gatedCores, const std::vector<UInt64> &idleTimes) = 0;
+};
+
+#endif
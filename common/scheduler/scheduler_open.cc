@@ -12,12 +12,15 @@
 #include "magic_server.h"
 #include "thread_manager.h"
 #include "stats.h"
+#include "task_heap.h"
 
 #include "policies/dvfsMaxFreq.h"
 #include "policies/dvfsFixedPower.h"
 #include "policies/dvfsTSP.h"
 #include "policies/dvfsTestStaticPower.h"
 #include "policies/mapFirstUnused.h"
+#include "policies/admissionTSP.h"
+#include "policies/gatingIdleTimeout.h"
 
 #include <iomanip>
 #include <random>
@@ -29,21 +32,19 @@
 #include "policies/coldestCore.h"
 #include "policies/dvfsOndemand.h"
 #include "policies/dvfsGrad.h"
+#include "policies/dvfsHeartbeat.h"
 #include "policies/hotPotato.h"
 
 using namespace std;
 
-int k=0;
-
 String queuePolicy; //Stores Queuing Policy for Open System from base.cfg.
+bool preemption; //Stores 1 if a task in front of the priority queue may preempt lower-priority tasks, from base.cfg.
 String distribution; //Stores the arrival distribution of the open workload from base.cfg.
 
 bool randomPriority; //Stores 1 if priority to be assigned randomly or 0 if priority is to be set by user explicitly from base.cfg.
 
-int arrivalRate; //Stores the arrival rate of the workload from base.cfg.
-int arrivalInterval; //Stores the arrival interval of the workload from base.cfg.
-
 int numberOfTasks; //Stores the number of tasks in the open workload.
+const UInt64 ARRIVAL_NOT_GENERATED = UINT64_MAX; //Arrival time of tasks not yet pulled from the arrival process.
 int numberOfCores; //Stores the number of cores in the system.
 
 int coreRequirementTranslation (String compositionString);
@@ -64,56 +65,56 @@ struct openTask {
 	UInt64 taskStartTime;
 	UInt64 taskDepartureTime; 
 	int priority;
+	int preemptions = 0;
+	vector<int> preemptedThreads; // threads stalled by the last preemption, resumed when the task is scheduled again
 	
 };
 
 vector <openTask> openTasks;
 
-struct ComparePriority {															//custom comparator for waitingTaskQ
-			bool operator()(openTask p1, openTask p2){
-			// return "true" if "p1" is ordered
-			// before "p2", for example:
-				if(p1.priority == p2.priority){
-					return p1.taskArrivalTime > p2.taskArrivalTime;
-				}
-				else{
-					return p1.priority < p2.priority;
-				}
-			}
-		};
+UInt64 numberOfPreemptions = 0;
+UInt64 numberOfAdmissionDeferrals = 0;
 
-struct ComparePriorityAQ {															//custom comparator for ActiveTaskQ
-			bool operator()(openTask p1, openTask p2){
-			// return "true" if "p1" is ordered
-			// before "p2", for example:
-				return p1.priority > p2.priority;
-			}
-		};
+/** waitingBefore
+    Order of the waiting queue: with the "priority" queuing policy, higher priority first and earlier arrival on ties.
+    With "FIFO", tasks are served in the order of their IDs.
+*/
+bool waitingBefore (int a, int b) {
+	if (queuePolicy == "priority") {
+		if (openTasks[a].priority != openTasks[b].priority) {
+			return openTasks[a].priority > openTasks[b].priority;
+		}
+		if (openTasks[a].taskArrivalTime != openTasks[b].taskArrivalTime) {
+			return openTasks[a].taskArrivalTime < openTasks[b].taskArrivalTime;
+		}
+	}
+	return a < b;
+}
 
-void showAQ(priority_queue<openTask, vector<openTask>, ComparePriorityAQ> gq)		//display taskID of tasks in ActiveTaskQ
-{
-    priority_queue<openTask, vector<openTask>, ComparePriorityAQ> g = gq;
-    while (!g.empty()) {
-        cout << g.top().taskID;
-        g.pop();
-    }
-    cout << '\n';
-};
+/** preemptionBefore
+    Order in which active tasks get preempted: lowest priority first, and the most recently started task on ties.
+*/
+bool preemptionBefore (int a, int b) {
+	if (openTasks[a].priority != openTasks[b].priority) {
+		return openTasks[a].priority < openTasks[b].priority;
+	}
+	if (openTasks[a].taskStartTime != openTasks[b].taskStartTime) {
+		return openTasks[a].taskStartTime > openTasks[b].taskStartTime;
+	}
+	return a > b;
+}
 
-void showtaskID(priority_queue<openTask, vector<openTask>, ComparePriority> gq)		//display taskID of tasks in waitingTaskQ
+TaskHeap waitingTaskQ(waitingBefore);		//This heap holds the IDs of the tasks in the waiting queue, task in front of the queue at top
+TaskHeap ActiveTaskQ(preemptionBefore);		//This heap holds the IDs of the active tasks, first task to preempt (lowest priority) at top
+
+void showQueue(const TaskHeap &queue)		//display taskIDs of a queue (in heap order, front of the queue first)
 {
-    priority_queue<openTask, vector<openTask>, ComparePriority> g = gq;
-    while (!g.empty()) {
-        cout << g.top().taskID;
-        g.pop();
+    for (int taskID : queue.handles()) {
+        cout << taskID << " ";
     }
     cout << '\n';
 };
 
-
-priority_queue<openTask, vector<openTask>, ComparePriority> waitingTaskQ;			//This priority queue holds the tasks in waiting queue in order of priority (with highest priority at top)
-priority_queue<openTask, vector<openTask>, ComparePriorityAQ> ActiveTaskQ;		//This priority queue holds the tasks that are active in order of priority (with lowest priority at top)
-
 		
 //This data structure maintains the state of the cores.
 struct systemCore {
@@ -123,9 +124,16 @@ struct systemCore {
 	int coreID;
 	int assignedTaskID = -1; // -1 means core assigned to no task
 	int assignedThreadID = -1;// -1 means core assigned to no thread.
+
+	UInt64 idleSince = 0; // Time in ns when the core was last assigned to a task.
+	UInt64 wakeupDone = 0; // Time in ns when the core is powered again after a wake-up.
+	int wakingThreadID = -1; // Thread mapped to the core that waits for the wake-up to complete, -1 if none.
+	UInt64 gatedTime = 0; // Total time in fs the core was power gated (stat core.gated_time)
+	UInt64 wakeups = 0; // Number of wake-ups from the gated state (stat core.wakeups)
 };
 
 vector <systemCore> systemCores;
+vector <bool> gatedCores; // Power gating state of the cores, shared with the mapping policy
 
 
 
@@ -161,11 +169,10 @@ SchedulerOpen::SchedulerOpen(ThreadManager *thread_manager)
 	mappingEpoch = atol (Sim()->getCfg()->getString("scheduler/open/epoch").c_str());
 	queuePolicy = Sim()->getCfg()->getString("scheduler/open/queuePolicy").c_str();
 	distribution = Sim()->getCfg()->getString("scheduler/open/distribution").c_str();
-	arrivalRate = atoi (Sim()->getCfg()->getString("scheduler/open/arrivalRate").c_str());
-	arrivalInterval = atoi (Sim()->getCfg()->getString("scheduler/open/arrivalInterval").c_str());
 	numberOfTasks = Sim()->getCfg()->getInt("traceinput/num_apps");
 	numberOfCores = Sim()->getConfig()->getApplicationCores();
 	randomPriority = Sim()->getCfg() ->getBool("scheduler/open/randompriority");
+	preemption = Sim()->getCfg()->getBool("scheduler/open/preemption");
 	
 
 	
@@ -192,6 +199,7 @@ SchedulerOpen::SchedulerOpen(ThreadManager *thread_manager)
 	for (int coreIterator=0; coreIterator < numberOfCores; coreIterator++) {
 		systemCores.push_back (coreIterator);
 	}
+	gatedCores.resize (numberOfCores, false);
 
 	//Initialize the task state array.
 	String benchmarks = Sim()->getCfg()->getString("traceinput/benchmarks");
@@ -201,83 +209,83 @@ SchedulerOpen::SchedulerOpen(ThreadManager *thread_manager)
 		benchmarks.erase(0, benchmarks.find(benchmarksDelimiter) + benchmarksDelimiter.length());		
 	}						
 
-	//Initialize the priority values (only when queuePolicy is "priority")
-	if(queuePolicy == "priority"){
+	//Initialize the arrival process. Arrival times (and priorities) are generated lazily as simulated time advances.
+	for (int taskIterator = 0; taskIterator < numberOfTasks; taskIterator++) {
+		openTasks[taskIterator].taskArrivalTime = ARRIVAL_NOT_GENERATED;
+	}
+	arrivalGenerator = ArrivalGenerator::create(distribution);
+	generateArrivals(SubsecondTime::Zero());
 
-		if(randomPriority == true){
-			for (int taskIterator = 0; taskIterator < numberOfTasks; taskIterator++) {
-				openTasks[taskIterator].priority = rand()%10;
-				
-				cout << "[Scheduler]: Setting Priority for Task " << taskIterator << " (" + openTasks[taskIterator].taskName + ")" << " to " << openTasks[taskIterator].priority << endl;
-			}
-		}
-		else{
-			for (int taskIterator = 0; taskIterator < numberOfTasks; taskIterator++) {
-			UInt64 priorityvalue = Sim()->getCfg()->getIntArray("scheduler/open/explicitPriorityValues", taskIterator);
-			cout << "[Scheduler]: Setting Priority for Task " << taskIterator << " (" + openTasks[taskIterator].taskName + ")" << " to " << priorityvalue << endl;
-			openTasks[taskIterator].priority = priorityvalue;
-			
-			}
-		}
+	initMappingPolicy(Sim()->getCfg()->getString("scheduler/open/logic").c_str());
+	initDVFSPolicy(Sim()->getCfg()->getString("scheduler/open/dvfs/logic").c_str());
+	initMigrationPolicy(Sim()->getCfg()->getString("scheduler/open/migration/logic").c_str());
+	initAdmissionPolicy(Sim()->getCfg()->getString("scheduler/open/admission/logic").c_str());
+	initPowerGatingPolicy(Sim()->getCfg()->getString("scheduler/open/powergating/logic").c_str());
+	initPerforationPolicy("", numberOfTasks);
 
+	registerStatsMetric("scheduler", 0, "preemptions", &numberOfPreemptions);
+	registerStatsMetric("scheduler", 0, "admission_deferrals", &numberOfAdmissionDeferrals);
+	for (int coreIterator = 0; coreIterator < numberOfCores; coreIterator++) {
+		// Used by tools/mcpat.py to remove the leakage of gated cores and add the wake-up energy
+		registerStatsMetric("core", coreIterator, "gated_time", &systemCores[coreIterator].gatedTime);
+		registerStatsMetric("core", coreIterator, "wakeups", &systemCores[coreIterator].wakeups);
 	}
+}
 
-	//Initialize the task arrival time based on queuing policy.
-	if (distribution == "uniform") {
-		UInt64 time = 0;
-		for (int taskIterator = 0; taskIterator < numberOfTasks; taskIterator++) {
-			if (taskIterator % arrivalRate == 0 && taskIterator != 0) time += arrivalInterval;  
-			cout << "[Scheduler]: Setting Arrival Time for Task " << taskIterator << " (" + openTasks[taskIterator].taskName + ")" << " to " << time << +" ns" << endl;
-			openTasks[taskIterator].taskArrivalTime = time;
-							
+/** generateArrivals
+ * Pull arrivals from the arrival process until one task is known to arrive after "time",
+ * and put the generated tasks into the waiting queue.
+ */
+void SchedulerOpen::generateArrivals(SubsecondTime time) {
+	while (nextArrivingTask < numberOfTasks) {
+		if (nextArrivingTask > 0 && arrivalGenerator->isMonotonic()
+			&& openTasks[nextArrivingTask - 1].taskArrivalTime > time.getNS()) {
+			break; // the next arrival is already known and lies in the future
 		}
-	} else if (distribution == "explicit") {
-		for (int taskIterator = 0; taskIterator < numberOfTasks; taskIterator++) {
-			UInt64 time = Sim()->getCfg()->getIntArray("scheduler/open/explicitArrivalTimes", taskIterator);
-			cout << "[Scheduler]: Setting Arrival Time for Task " << taskIterator << " (" + openTasks[taskIterator].taskName + ")" << " to " << time << +" ns" << endl;
-			openTasks[taskIterator].taskArrivalTime = time;
-			
+
+		int taskIterator = nextArrivingTask;
+		taskArrival arrival;
+		if (!arrivalGenerator->next(arrival)) {
+			cout << "\n[Scheduler] [Error]: Arrival process ended after " << taskIterator << " of " << numberOfTasks << " tasks" << endl;
+			exit (1);
 		}
-	} else if (distribution == "poisson") {
-		// calculate Poisson-distributed arrival rates for the task.
-		// The expected time between arrivales is the configured value "arrivalInterval".
-		// The generation can either use a user-defined seed or generate a new seed for every execution.
-		int seed = Sim()->getCfg()->getInt("scheduler/open/distributionSeed");
-		if (seed == 0) {
-			// Set a "truely random" seed
-			std::random_device rd;
-			seed = rd();
+		nextArrivingTask++;
+
+		if (arrival.benchmark != "" && openTasks[taskIterator].taskName.find(arrival.benchmark) != 0) {
+			cout << "[Scheduler] [Warning]: Arrival log names benchmark " << arrival.benchmark << " for Task " << taskIterator << ", but it runs " << openTasks[taskIterator].taskName << endl;
 		}
-		std::mt19937 generator(seed);
-		generator(); // read one dummy value (first value was very like the seed: small seed -> small first arrival time, big seed -> big first arrival time. We do not want to have this.)
-		double lambda = 1.0 / arrivalInterval;
-		std::exponential_distribution<float> expdistribution(lambda);
-
-		UInt64 time = 0;
-		for (int taskIterator = 0; taskIterator < numberOfTasks; taskIterator++) {
-			if (taskIterator % arrivalRate == 0 && taskIterator != 0) {
-				time += (UInt64)expdistribution(generator);
+
+		// The arrival log can request a wider core reservation: the task reserves the cores of the logged parallelism,
+		// but it still runs the threads of its own benchmark, so the reservation never drops below what those need
+		if (arrival.parallelism > 0) {
+			String taskName = openTasks[taskIterator].taskName;
+			int requirement = coreRequirementTranslation(taskName.substr(0, taskName.rfind('-') + 1) + itostr(arrival.parallelism));
+			if (requirement < openTasks[taskIterator].taskCoreRequirement) {
+				cout << "[Scheduler] [Warning]: Arrival log requests parallelism " << arrival.parallelism << " for Task " << taskIterator << ", which is below that of " << openTasks[taskIterator].taskName << endl;
+			} else {
+				openTasks[taskIterator].taskCoreRequirement = requirement;
+				cout << "[Scheduler]: Setting Core Requirement for Task " << taskIterator << " (" + openTasks[taskIterator].taskName + ")" << " to " << requirement << endl;
 			}
-			cout << "[Scheduler]: Setting Arrival Time for Task " << taskIterator << " (" + openTasks[taskIterator].taskName + ")" << " to " << time << +" ns" << endl;
-			openTasks[taskIterator].taskArrivalTime = time;
-				
 		}
 
-		
-	} else {
-		cout << "\n[Scheduler] [Error]: Unknown Workload Arrival Distribution: '" << distribution << "'" << endl;
- 		exit (1);
-	}
+		//Initialize the priority value (only when queuePolicy is "priority")
+		if (queuePolicy == "priority") {
+			if (arrival.priority >= 0) {
+				openTasks[taskIterator].priority = arrival.priority;
+			} else if (randomPriority == true) {
+				openTasks[taskIterator].priority = rand()%10;
+			} else {
+				openTasks[taskIterator].priority = Sim()->getCfg()->getIntArray("scheduler/open/explicitPriorityValues", taskIterator);
+			}
+			cout << "[Scheduler]: Setting Priority for Task " << taskIterator << " (" + openTasks[taskIterator].taskName + ")" << " to " << openTasks[taskIterator].priority << endl;
+		}
 
-	for(int taskIterator = 0; taskIterator < numberOfTasks; taskIterator++){
-		waitingTaskQ.push(openTasks[taskIterator]);
-		cout << "Pushing Task " << taskIterator << " to the waitingTaskQ" << endl;
+		// Arrival times of all unscheduled tasks are shifted when the system runs empty (see threadExit).
+		// The shift is signed, clamp at time zero instead of wrapping around.
+		SInt64 shiftedArrivalTime = (SInt64)arrival.time - arrivalTimeShift;
+		openTasks[taskIterator].taskArrivalTime = shiftedArrivalTime > 0 ? (UInt64)shiftedArrivalTime : 0;
+		cout << "[Scheduler]: Setting Arrival Time for Task " << taskIterator << " (" + openTasks[taskIterator].taskName + ")" << " to " << openTasks[taskIterator].taskArrivalTime << +" ns" << endl;
 	}
-	
-	initMappingPolicy(Sim()->getCfg()->getString("scheduler/open/logic").c_str());
-	initDVFSPolicy(Sim()->getCfg()->getString("scheduler/open/dvfs/logic").c_str());
-	initMigrationPolicy(Sim()->getCfg()->getString("scheduler/open/migration/logic").c_str());
-	initPerforationPolicy("", numberOfTasks);
 }
 
 /** initMappingPolicy
@@ -301,6 +309,7 @@ void SchedulerOpen::initMappingPolicy(String policyName) {
 		cout << "\n[Scheduler] [Error]: Unknown Mapping Algorithm" << endl;
  		exit (1);
 	}
+	mappingPolicy->setGatedCores(&gatedCores);
 }
 
 /** initDVFSPolicy
@@ -354,6 +363,31 @@ void SchedulerOpen::initDVFSPolicy(String policyName) {
 			dtmCriticalTemperature,
 			dtmRecoveredTemperature
 		);
+	} else if (policyName == "heartbeat") {
+		float slackTolerance = Sim()->getCfg()->getFloat(
+			"scheduler/open/dvfs/heartbeat/slack_tolerance");
+		float catchupSlackStep = Sim()->getCfg()->getFloat(
+			"scheduler/open/dvfs/heartbeat/catchup_slack_step");
+		if (catchupSlackStep <= 0) {
+			cout << "\n[Scheduler] [Error]: scheduler/open/dvfs/heartbeat/catchup_slack_step must be positive" << endl;
+			exit (1);
+		}
+		float dtmCriticalTemperature = Sim()->getCfg()->getFloat(
+			"scheduler/open/dvfs/heartbeat/dtm_cricital_temperature");
+		float dtmRecoveredTemperature = Sim()->getCfg()->getFloat(
+			"scheduler/open/dvfs/heartbeat/dtm_recovered_temperature");
+		dvfsPolicy = new DVFSHeartbeat(
+			performanceCounters,
+			coreRows,
+			coreColumns,
+			minFrequency,
+			maxFrequency,
+			frequencyStepSize,
+			slackTolerance,
+			catchupSlackStep,
+			dtmCriticalTemperature,
+			dtmRecoveredTemperature
+		);
 	} else if (policyName == "coldestCore") {
 		float criticalTemperature = Sim()->getCfg()->getFloat(
 			"scheduler/open/migration/coldestCore/criticalTemperature");
@@ -379,14 +413,7 @@ void SchedulerOpen::initDVFSPolicy(String policyName) {
 		float perCorePowerBudget = Sim()->getCfg()->getFloat("scheduler/open/dvfs/fixed_power/per_core_power_budget");
 		dvfsPolicy = new DVFSFixedPower(performanceCounters, coreRows, coreColumns, minFrequency, maxFrequency, frequencyStepSize, perCorePowerBudget);
 	} else if (policyName == "tsp") {
-		double ambientTemperature = Sim()->getCfg()->getFloat("periodic_thermal/ambient_temperature");
-    double maxTemperature = Sim()->getCfg()->getFloat("periodic_thermal/max_temperature");
-    double inactivePower = Sim()->getCfg()->getFloat("periodic_thermal/inactive_power");
-    double tdp = Sim()->getCfg()->getFloat("periodic_thermal/tdp");
-		String thermalModelFilename = Sim()->getCfg()->getString("periodic_thermal/thermal_model");
-		thermalModel = new ThermalModel((unsigned int)coreRows, (unsigned int)coreColumns, thermalModelFilename, ambientTemperature, maxTemperature, inactivePower, tdp);
-
-		dvfsPolicy = new DVFSTSP(thermalModel, performanceCounters, coreRows, coreColumns, minFrequency, maxFrequency, frequencyStepSize);
+		dvfsPolicy = new DVFSTSP(getThermalModel(), performanceCounters, coreRows, coreColumns, minFrequency, maxFrequency, frequencyStepSize);
 	} else {
 		cout << "\n[Scheduler] [Error]: Unknown DVFS Algorithm" << endl;
  		exit (1);
@@ -428,39 +455,68 @@ void SchedulerOpen::initMigrationPolicy(String policyName) {
 	}
 }
 
+/** initAdmissionPolicy
+ * Initialize the admission policy to the policy with the given name
+ */
+void SchedulerOpen::initAdmissionPolicy(String policyName) {
+	cout << "[Scheduler] [Info]: Initializing admission policy " + policyName << endl;
+	if (policyName == "off") {
+		admissionPolicy = NULL;
+	} else if (policyName == "tsp") {
+		float minCorePower = Sim()->getCfg()->getFloat("scheduler/open/admission/tsp/min_core_power");
+		admissionPolicy = new AdmissionTSP(getThermalModel(), minCorePower);
+	} //else if (policyName ="XYZ") {... } //Place to instantiate a new admission logic. Implementation is put in "policies" package.
+	else {
+		cout << "\n[Scheduler] [Error]: Unknown Admission Algorithm" << endl;
+ 		exit (1);
+	}
+}
+
+/** initPowerGatingPolicy
+ * Initialize the power gating policy to the policy with the given name
+ */
+void SchedulerOpen::initPowerGatingPolicy(String policyName) {
+	cout << "[Scheduler] [Info]: Initializing power gating policy " + policyName << endl;
+	if (policyName == "off") {
+		powerGatingPolicy = NULL;
+	} else if (policyName == "timeout") {
+		UInt64 idleTimeout = Sim()->getCfg()->getInt("scheduler/open/powergating/timeout/idle_timeout");
+		int spareCores = Sim()->getCfg()->getInt("scheduler/open/powergating/timeout/spare_cores");
+		powerGatingPolicy = new GatingIdleTimeout(idleTimeout, spareCores);
+	} //else if (policyName ="XYZ") {... } //Place to instantiate a new power gating logic. Implementation is put in "policies" package.
+	else {
+		cout << "\n[Scheduler] [Error]: Unknown Power Gating Algorithm" << endl;
+ 		exit (1);
+	}
+	powerGatingEpoch = atol (Sim()->getCfg()->getString("scheduler/open/powergating/epoch").c_str());
+	wakeupLatency = Sim()->getCfg()->getInt("scheduler/open/powergating/wakeup_latency");
+}
+
+/** getThermalModel
+ * Return the thermal model of the chip, loading it on first use.
+ */
+ThermalModel* SchedulerOpen::getThermalModel() {
+	if (thermalModel == NULL) {
+		double ambientTemperature = Sim()->getCfg()->getFloat("periodic_thermal/ambient_temperature");
+		double maxTemperature = Sim()->getCfg()->getFloat("periodic_thermal/max_temperature");
+		double inactivePower = Sim()->getCfg()->getFloat("periodic_thermal/inactive_power");
+		double tdp = Sim()->getCfg()->getFloat("periodic_thermal/tdp");
+		String thermalModelFilename = Sim()->getCfg()->getString("periodic_thermal/thermal_model");
+		thermalModel = new ThermalModel((unsigned int)coreRows, (unsigned int)coreColumns, thermalModelFilename, ambientTemperature, maxTemperature, inactivePower, tdp);
+	}
+	return thermalModel;
+}
+
 /** taskFrontOfQueue
-    Returns the ID of the task in front of queue. Place to implement a new queuing policy.
+    Returns the ID of the task in front of queue (-1 if the queue is empty). Place to implement a new queuing policy.
 */
 int taskFrontOfQueue () {
 	int IDofTaskInFrontOfQueue = -1;
 
-	if (queuePolicy == "FIFO") {
-		for (int taskIterator = 0; taskIterator < numberOfTasks; taskIterator++) {
-			if (openTasks [taskIterator].waitingInQueue) {
-				IDofTaskInFrontOfQueue = taskIterator;
-				break;
-			}
-		}
+	if (queuePolicy == "FIFO" || queuePolicy == "priority") { // The order is defined by waitingBefore
+		IDofTaskInFrontOfQueue = waitingTaskQ.top();
 	}
 	//else if (queuePolicy ="XYZ") {... } //Place to implement a new queuing policy.
-	else if (queuePolicy == "priority"){ 
-		SubsecondTime time = Sim()->getClockSkewMinimizationServer()->getGlobalTime();
-		if ((openTasks [waitingTaskQ.top().taskID].waitingInQueue) && (openTasks[waitingTaskQ.top().taskID].taskArrivalTime <= time.getNS())){
-
-			IDofTaskInFrontOfQueue = waitingTaskQ.top().taskID;
-
-		}
-
-		else {
-			while ((!openTasks [waitingTaskQ.top().taskID].waitingInQueue) || (!(openTasks[waitingTaskQ.top().taskID].taskArrivalTime <= time.getNS()))){
-
-				waitingTaskQ.pop();
-
-			}
-			IDofTaskInFrontOfQueue = waitingTaskQ.top().taskID;
-		}
-		
-	}
 	else {
 	
 		cout<<"\n[Scheduler] [Error]: Unknown Queuing Policy"<< endl;
@@ -470,6 +526,15 @@ int taskFrontOfQueue () {
 	return IDofTaskInFrontOfQueue;
 }
 
+/** enqueueTask
+    Put an arrived (or preempted) task into the waiting queue.
+*/
+void enqueueTask (int taskID) {
+	openTasks [taskID].waitingInQueue = true;
+	openTasks [taskID].waitingToSchedule = false;
+	waitingTaskQ.push(taskID);
+}
+
 /** numberOfFreeCores
     Returns number of free cores in the system.
 */
@@ -483,6 +548,18 @@ int numberOfFreeCores () {
 	return freeCoresCounter;
 }
 
+/** isWaitingForWakeup
+    Returns true if the thread is mapped to a core that is still waking up from the gated state.
+*/
+bool isWaitingForWakeup (int threadID) {
+	for (int coreCounter = 0; coreCounter < numberOfCores; coreCounter++) {
+		if (systemCores[coreCounter].wakingThreadID == threadID) {
+			return true;
+		}
+	}
+	return false;
+}
+
 /** numberOfTasksInQueue
     Returns the number of tasks in the queue.
 */
@@ -636,16 +713,98 @@ int SchedulerOpen::setAffinity (thread_id_t thread_id) {
 		threadSetAffinity(INVALID_THREAD_ID, thread_id, sizeof(cpu_set_t), &my_set); 
 	} else {
 		cout << "\n[Scheduler]: Setting Affinity for Thread " << thread_id << " from Task " << app_id << " to Core " << coreFound << "\n" << endl;
-		cpu_set_t my_set; 
-		CPU_ZERO(&my_set); 
-		CPU_SET(coreFound, &my_set);
-		threadSetAffinity(INVALID_THREAD_ID, thread_id, sizeof(cpu_set_t), &my_set); 
+		pinThread(thread_id, coreFound);
 		systemCores[coreFound].assignedThreadID = thread_id; 
 	}
 
 	return coreFound;
 }
 
+/** pinThread
+ * Set the affinity of the given thread to the given core. If the core is still waking up from the gated state,
+ * the thread is stalled (empty affinity) and pinned by updatePowerGating once the wake-up is complete.
+ */
+void SchedulerOpen::pinThread(thread_id_t thread_id, core_id_t core_id) {
+	SubsecondTime time = Sim()->getClockSkewMinimizationServer()->getGlobalTime();
+	if (gatedCores.at(core_id)) {
+		wakeCore(core_id, time);
+	}
+
+	cpu_set_t my_set; 
+	CPU_ZERO(&my_set); 
+	if (systemCores[core_id].wakeupDone > time.getNS()) {
+		cout << "\n[Scheduler]: Thread " << thread_id << " waits for Core " << core_id << " to wake up until " << systemCores[core_id].wakeupDone << " ns\n";
+		systemCores[core_id].wakingThreadID = thread_id;
+	} else {
+		CPU_SET(core_id, &my_set);
+	}
+	threadSetAffinity(INVALID_THREAD_ID, thread_id, sizeof(cpu_set_t), &my_set); 
+}
+
+/** wakeCore
+ * Start waking up a power gated core. Threads mapped to the core can only run after the wake-up latency.
+ */
+void SchedulerOpen::wakeCore(int coreId, SubsecondTime time) {
+	cout << "[Scheduler]: Waking up Core " << coreId << " from the gated state" << endl;
+	gatedCores.at(coreId) = false;
+	systemCores[coreId].wakeupDone = time.getNS() + wakeupLatency;
+	systemCores[coreId].wakeups++;
+}
+
+/** isGated
+ * Return whether the given core is power gated.
+ */
+bool SchedulerOpen::isGated(int coreId) {
+	return gatedCores.at(coreId);
+}
+
+/** updatePowerGating
+ * Account the time spent gated since the last call, pin the threads whose core finished waking up,
+ * and invoke the power gating policy on its epoch.
+ */
+void SchedulerOpen::updatePowerGating(SubsecondTime time) {
+	SubsecondTime delta = time - m_last_periodic;
+	for (int coreCounter = 0; coreCounter < numberOfCores; coreCounter++) {
+		if (gatedCores.at(coreCounter)) {
+			systemCores[coreCounter].gatedTime += delta.getFS();
+		}
+		if (isAssignedToTask(coreCounter)) {
+			systemCores[coreCounter].idleSince = time.getNS();
+		}
+		if (systemCores[coreCounter].wakingThreadID != -1 && systemCores[coreCounter].wakeupDone <= time.getNS()) {
+			thread_id_t thread_id = systemCores[coreCounter].wakingThreadID;
+			systemCores[coreCounter].wakingThreadID = -1;
+			cout << "\n[Scheduler]: Core " << coreCounter << " woke up, running Thread " << thread_id << "\n";
+			cpu_set_t my_set; 
+			CPU_ZERO(&my_set); 
+			CPU_SET(coreCounter, &my_set);
+			threadSetAffinity(INVALID_THREAD_ID, thread_id, sizeof(cpu_set_t), &my_set); 
+		}
+	}
+
+	if ((powerGatingPolicy != NULL) && (time.getNS() % powerGatingEpoch == 0)) {
+		vector<bool> idleCores(numberOfCores);
+		vector<UInt64> idleTimes(numberOfCores);
+		for (int coreCounter = 0; coreCounter < numberOfCores; coreCounter++) {
+			idleCores.at(coreCounter) = !isAssignedToTask(coreCounter) && systemCores[coreCounter].wakeupDone <= time.getNS();
+			idleTimes.at(coreCounter) = time.getNS() - systemCores[coreCounter].idleSince;
+		}
+
+		vector<bool> gated = powerGatingPolicy->gate(idleCores, gatedCores, idleTimes);
+		for (int coreCounter = 0; coreCounter < numberOfCores; coreCounter++) {
+			if (!idleCores.at(coreCounter) || gated.at(coreCounter) == gatedCores.at(coreCounter)) {
+				continue;
+			}
+			if (gated.at(coreCounter)) {
+				cout << "[Scheduler]: Power gating idle Core " << coreCounter << endl;
+				gatedCores.at(coreCounter) = true;
+			} else {
+				wakeCore(coreCounter, time);
+			}
+		}
+	}
+}
+
 
 /** migrateThread
  * Move the given thread to the given core.
@@ -672,10 +831,7 @@ void SchedulerOpen::migrateThread(thread_id_t thread_id, core_id_t core_id)
 			exit(1);
 		}
 		
-		cpu_set_t my_set; 
-		CPU_ZERO(&my_set); 
-		CPU_SET(core_id, &my_set);
-		threadSetAffinity(INVALID_THREAD_ID, thread_id, sizeof(cpu_set_t), &my_set); 
+		pinThread(thread_id, core_id);
 
 		systemCores[core_id].assignedTaskID = systemCores[from_core_id].assignedTaskID;
 		systemCores[core_id].assignedThreadID = thread_id;
@@ -729,11 +885,43 @@ bool SchedulerOpen::executeMappingPolicy(int taskID, SubsecondTime time) {
 	for (unsigned int i = 0; i < bestCores.size(); i++) {
 		cout << "[Scheduler]: Assigning Core " << bestCores.at(i) << " to Task " << taskID << endl;
 		systemCores[bestCores.at(i)].assignedTaskID = taskID;
+		if (gatedCores.at(bestCores.at(i))) {
+			wakeCore(bestCores.at(i), time); // Start the wake-up now, before the threads are pinned
+		}
 	}
 
 	return true;
 }
 
+/** selectPreemptionVictims
+    With priority queuing and preemption enabled, select active tasks of lower priority than "taskID" (lowest priority first),
+    such that their cores together with the free cores satisfy the core requirement of "taskID".
+    Returns false and selects nothing if this is not possible: tasks are never preempted in vain.
+*/
+bool selectPreemptionVictims (int taskID, vector<int> &victims) {
+	if (queuePolicy != "priority" || !preemption) {
+		return false;
+	}
+
+	int cores = numberOfFreeCores ();
+	while (cores < openTasks[taskID].taskCoreRequirement && !ActiveTaskQ.empty() && openTasks[ActiveTaskQ.top()].priority < openTasks[taskID].priority) {
+		victims.push_back(ActiveTaskQ.top());
+		cores += openTasks[ActiveTaskQ.top()].taskCoreRequirement;
+		ActiveTaskQ.pop();
+	}
+
+	// This is only a selection: the victims stay active until preemptTask
+	for (unsigned int i = 0; i < victims.size(); i++) {
+		ActiveTaskQ.push(victims.at(i));
+	}
+
+	if (cores < openTasks[taskID].taskCoreRequirement) {
+		victims.clear();
+		return false;
+	}
+	return true;
+}
+
 /** schedule
     This function attempt to schedule a task with logic defined in base.cfg.
 */
@@ -749,21 +937,7 @@ bool SchedulerOpen::schedule (int taskID, bool isInitialCall, SubsecondTime time
 	
 	else {
 		cout <<"\n[Scheduler]: Task " << taskID << " put into execution queue. \n";
-		openTasks [taskID].waitingInQueue = true;
-		openTasks [taskID].waitingToSchedule = false;
-			
-		if(waitingTaskQ.size()>1){
-			openTask tempo = waitingTaskQ.top();
-			waitingTaskQ.pop();
-			
-			if(tempo.taskID != waitingTaskQ.top().taskID){		//making sure that one task doesn't get pushed to waitingTaskQ twice
-				waitingTaskQ.push(tempo);
-			}
-			else{
-				waitingTaskQ.pop();
-				waitingTaskQ.push(openTasks[tempo.taskID]);
-			}
-		}	
+		enqueueTask (taskID);
 	}
 
 	if (taskFrontOfQueue () != taskID) {
@@ -772,71 +946,44 @@ bool SchedulerOpen::schedule (int taskID, bool isInitialCall, SubsecondTime time
 		return false; //Not turn of this task to be mapped.
 	}
 
-	if (numberOfFreeCores () < openTasks[taskID].taskCoreRequirement) { //If priority queuing is adopted, then we need to check for it and readjust tasks if required
- 		if((queuePolicy == "priority") && (openTasks [ActiveTaskQ.top().taskID].priority < openTasks[taskID].priority)){
-		   	 while((numberOfFreeCores () < openTasks[taskID].taskCoreRequirement) && (openTasks[ActiveTaskQ.top().taskID].priority < openTasks[taskID].priority) ){
-				for(int t=0; t < Sim()->getThreadManager()->getNumThreads() ; t++ ){
-					app_id_t app_id =  Sim()->getThreadManager()->getThreadFromID(t)->getAppId();
-					if(ActiveTaskQ.top().taskID == app_id ){
-						 SubsecondTime time = Sim()->getClockSkewMinimizationServer()->getGlobalTime();
-						
-						for (int i = 0; i < numberOfCores; i++) {
-							if (systemCores[i].assignedThreadID == t){
-								systemCores[i].assignedThreadID = -1;
-								cout << "\n[Scheduler]: Releasing Core " << i << " from Thread " << t << "\n";
-								
-								cpu_set_t my_set; 
-								CPU_ZERO(&my_set); 
-								CPU_SET(INVALID_CORE_ID, &my_set);
-								Sim()->getThreadManager()->getLock();
-								m_thread_info[t].clearAffinity();	
-							}
-
-						}
-					
-						if (t < numberOfTasks) {									
-							
-
-							for (int i = 0; i < numberOfCores; i++) {
-								if (systemCores[i].assignedTaskID == app_id) {
-									systemCores[i].assignedTaskID = -1;
-								}
-							}
-						}				 	
-					}
-				}
-				 	
-				openTasks[ActiveTaskQ.top().taskID].active = false;
-				openTasks[ActiveTaskQ.top().taskID].waitingInQueue = true;
-				if(waitingTaskQ.top().taskID != ActiveTaskQ.top().taskID){
-					waitingTaskQ.push(ActiveTaskQ.top());
-				}
-				ActiveTaskQ.pop();
-				k++;
-			}																								
-	 	}
-		 
-		else{						
+	vector<int> victims; //Lower-priority tasks to preempt to make room for this task
+	if (numberOfFreeCores () < openTasks[taskID].taskCoreRequirement) {
+		if (!selectPreemptionVictims (taskID, victims)) {
 			cout <<"\n[Scheduler]: Not Enough Free Cores (" << numberOfFreeCores () << ") to Schedule the Task " << taskID << " with cores requirement " << openTasks[taskID].taskCoreRequirement  << endl;
 			return false;
 		}
 	}
 
+	if (!admitTask (taskID, victims)) {
+		cout <<"\n[Scheduler]: Admission control keeps Task " << taskID << " in the queue. \n";
+		numberOfAdmissionDeferrals++;
+		return false;
+	}
+
+	for (unsigned int i = 0; i < victims.size(); i++) {
+		preemptTask (victims.at(i), time);
+	}
+
 	mappingSuccesfull = executeMappingPolicy(taskID, time);
-		if (mappingSuccesfull) {
-			if (!isInitialCall) 
+	if (mappingSuccesfull) {
+		if (!openTasks [taskID].preemptedThreads.empty()) {
+			for (unsigned int i = 0; i < openTasks [taskID].preemptedThreads.size(); i++) {
+				int thread = openTasks [taskID].preemptedThreads.at(i);
+				cout << "\n[Scheduler]: Resuming Thread " << thread << " of Task " << taskID << " at core " << setAffinity (thread) << endl;
+			}
+			openTasks [taskID].preemptedThreads.clear();
+		}
+		else if (!isInitialCall) 
 			cout << "\n[Scheduler]: Waking Task " << taskID << " at core " << setAffinity (taskID) << endl;
-				
-		openTasks [taskID].taskStartTime = time.getNS();
+
+		if (openTasks [taskID].preemptions == 0) {
+			openTasks [taskID].taskStartTime = time.getNS(); //Keep the first start time of preempted tasks, service time includes the preemption
+		}
 		
 		openTasks [taskID].active = true;		
-		ActiveTaskQ.push(openTasks[taskID]);
+		ActiveTaskQ.push(taskID);
 		openTasks [taskID].waitingInQueue = false;
-		
-		if((queuePolicy=="priority") && (waitingTaskQ.top().taskID == taskID)){
-			waitingTaskQ.pop();
-		}
-			
+		waitingTaskQ.remove(taskID);
 		openTasks [taskID].waitingToSchedule = false;
 	} 
 
@@ -844,6 +991,58 @@ bool SchedulerOpen::schedule (int taskID, bool isInitialCall, SubsecondTime time
 
 }
 
+/** admitTask
+    Ask the admission policy whether "taskID" may start, given the active cores after preempting "victims".
+*/
+bool SchedulerOpen::admitTask (int taskID, const vector<int> &victims) {
+	if (admissionPolicy == NULL) {
+		return true;
+	}
+
+	vector<bool> activeCores(numberOfCores);
+	bool anyActive = false;
+	for (int i = 0; i < numberOfCores; i++) {
+		activeCores.at(i) = isAssignedToTask(i) && find(victims.begin(), victims.end(), systemCores[i].assignedTaskID) == victims.end();
+		anyActive = anyActive || activeCores.at(i);
+	}
+	if (!anyActive) {
+		return true; //Never keep an idle system waiting, the task would not be admitted later either.
+	}
+
+	return admissionPolicy->admit(openTasks[taskID].taskName, openTasks[taskID].taskCoreRequirement, activeCores);
+}
+
+/** preemptTask
+    Suspend an active task and put it back into the waiting queue. Its threads are stalled: without any core
+    in their affinity they are taken off their cores, and they get their cores back when the task is scheduled again.
+*/
+void SchedulerOpen::preemptTask (int taskID, SubsecondTime time) {
+	cout << "\n[Scheduler]: Preempting Task " << taskID << " (priority " << openTasks[taskID].priority << ") at Time " << formatTime(time) << endl;
+
+	for (int i = 0; i < numberOfCores; i++) {
+		if (systemCores[i].assignedTaskID == taskID) {
+			int thread = systemCores[i].assignedThreadID;
+			if (thread != -1) {
+				cout << "\n[Scheduler]: Stalling Thread " << thread << " of Task " << taskID << " on Core " << i << "\n";
+				cpu_set_t my_set; 
+				CPU_ZERO(&my_set); 
+				threadSetAffinity(INVALID_THREAD_ID, thread, sizeof(cpu_set_t), &my_set);
+				openTasks[taskID].preemptedThreads.push_back(thread);
+				systemCores[i].wakingThreadID = -1;
+			}
+			cout << "\n[Scheduler]: Releasing Core " << i << " from Task " << taskID << "\n";
+			systemCores[i].assignedTaskID = -1;
+			systemCores[i].assignedThreadID = -1;
+		}
+	}
+
+	openTasks[taskID].active = false;
+	openTasks[taskID].preemptions++;
+	numberOfPreemptions++;
+	ActiveTaskQ.remove(taskID);
+	enqueueTask(taskID);
+}
+
 /** threadCreate
     This original Sniper function is called when a thread is created.
 */
@@ -896,9 +1095,15 @@ core_id_t SchedulerOpen::threadCreate(thread_id_t thread_id) {
    	else {
 	
 		if (thread_id >= numberOfTasks && free_core_id == INVALID_CORE_ID) {
-
-			cout <<"\n[Scheudler] [Error]: A non-intial Thread " << thread_id << " From Task " << app_id << " failed to get a core.\n";
-			exit (1);
+			if (!openTasks[app_id].active && openTasks[app_id].preemptions > 0) {
+				// Task is preempted: the new thread gets a core once the task is resumed
+				openTasks[app_id].preemptedThreads.push_back(thread_id);
+			} else if (isWaitingForWakeup(thread_id)) {
+				// The core of the thread is waking up from the gated state, see updatePowerGating
+			} else {
+				cout <<"\n[Scheudler] [Error]: A non-intial Thread " << thread_id << " From Task " << app_id << " failed to get a core.\n";
+				exit (1);
+			}
 		}
 	cout <<"\n[Scheduler]: Putting Thread " << thread_id << " From Task " << app_id << " to sleep.\n";
       	m_thread_info[thread_id].setCoreRunning(INVALID_CORE_ID);
@@ -910,38 +1115,10 @@ core_id_t SchedulerOpen::threadCreate(thread_id_t thread_id) {
     This function pulls tasks into the openSystem Queue.
 */
 void fetchTasksIntoQueue (SubsecondTime time) {
-
-	if(queuePolicy == "priority"){
-		for (int taskCounter = 0; taskCounter < numberOfTasks; taskCounter++) {
-			if (openTasks [taskCounter].waitingToSchedule && openTasks [taskCounter].taskArrivalTime <= time.getNS ()) {
-				
-				cout <<"\n[Scheduler]: Task " << taskCounter << " put into execution queue. \n";
-				openTasks [taskCounter].waitingInQueue = true;
-				
-				
-					if(waitingTaskQ.top().taskID != taskCounter){
-					waitingTaskQ.push(openTasks [taskCounter]);
-					}
-					
-					if(waitingTaskQ.top().taskID == ActiveTaskQ.top().taskID){
-						waitingTaskQ.pop();
-					}
-			
-			
-				openTasks [taskCounter].waitingToSchedule = false;
-
-				cout << "Task " << taskCounter << " has been pushed to waitingTaskQ" << endl;
-			}
-		}
-	}
-
-	else{
-		for (int taskCounter = 0; taskCounter < numberOfTasks; taskCounter++) {
-			if (openTasks [taskCounter].waitingToSchedule && openTasks [taskCounter].taskArrivalTime <= time.getNS ()) {
-				cout <<"\n[Scheduler]: Task " << taskCounter << " put into execution queue. \n";
-				openTasks [taskCounter].waitingInQueue = true;
-				openTasks [taskCounter].waitingToSchedule = false;
-			}
+	for (int taskCounter = 0; taskCounter < numberOfTasks; taskCounter++) {
+		if (openTasks [taskCounter].waitingToSchedule && openTasks [taskCounter].taskArrivalTime <= time.getNS ()) {
+			cout <<"\n[Scheduler]: Task " << taskCounter << " put into execution queue. \n";
+			enqueueTask (taskCounter);
 		}
 	}
 }
@@ -986,30 +1163,7 @@ void SchedulerOpen::threadExit(thread_id_t thread_id, SubsecondTime time) {
 			openTasks[app_id].taskDepartureTime = time.getNS();
 			openTasks[app_id].completed = true;
 			openTasks[app_id].active = false;
-			if(queuePolicy == "priority"){
-				priority_queue<openTask, vector<openTask>, ComparePriority> tempQ;
-
-				if(ActiveTaskQ.top().taskID == app_id){
-
-					ActiveTaskQ.pop();
-
-				}
-				else{
-					while(ActiveTaskQ.top().taskID != app_id){
-
-						tempQ.push(ActiveTaskQ.top());
-						ActiveTaskQ.pop();
-
-					}
-
-					while(tempQ.size() != 0){
-
-						ActiveTaskQ.push(tempQ.top());
-						tempQ.pop();
-
-					}
-				}
-			}
+			ActiveTaskQ.remove(app_id);
 			
 		cout << "\n[Scheduler][Result]: Task " << app_id << " (Response/Service/Wait) Time (ns) "  << " :\t" <<  time.getNS() - openTasks[app_id].taskArrivalTime << "\t" <<  time.getNS() - openTasks[app_id].taskStartTime << "\t" << openTasks[app_id].taskStartTime - openTasks[app_id].taskArrivalTime << "\n";
 	
@@ -1046,12 +1200,14 @@ void SchedulerOpen::threadExit(thread_id_t thread_id, SubsecondTime time) {
 			cout << "\n[Scheduler]: Readjusting Arrival Time by " << timeJump << " ns \n"; // This will not effect the result of response time as arrival time of all unscheduled tasks are adjusted relatively.
 
 			for (int taskIterator = 0; taskIterator < numberOfTasks; taskIterator++) {
-				if (openTasks[taskIterator].waitingToSchedule) {
+				if (openTasks[taskIterator].waitingToSchedule && openTasks[taskIterator].taskArrivalTime != ARRIVAL_NOT_GENERATED) {
 					openTasks[taskIterator].taskArrivalTime -= timeJump;
 					cout << "\n[Scheduler]: New Arrival Time from Task " << taskIterator << " set at " << openTasks[taskIterator].taskArrivalTime << " ns" <<  "\n"; 
 				}
 			}
+			arrivalTimeShift += timeJump;
 
+			generateArrivals (time);
 			fetchTasksIntoQueue (time);
 
 			schedule (taskFrontOfQueue (), false, time);
@@ -1315,6 +1471,11 @@ void SchedulerOpen::executeDVFSPolicy() {
 	    static bool reserved_cores_are_active = Sim()->getCfg()->getBool("scheduler/open/dvfs/reserved_cores_are_active");
 		activeCores.push_back(reserved_cores_are_active ? isAssignedToTask(coreCounter) : isAssignedToThread(coreCounter));
 	}
+	std::vector<int> taskIds;
+	for (int coreCounter = 0; coreCounter < numberOfCores; coreCounter++) {
+		taskIds.push_back(systemCores.at(coreCounter).assignedTaskID);
+	}
+	performanceCounters->notifyTasksOfCores(taskIds);
 	vector<int> frequencies = dvfsPolicy->getFrequencies(oldFrequencies, activeCores);
 	for (int coreCounter = 0; coreCounter < numberOfCores; coreCounter++) {
 		setFrequency(coreCounter, frequencies.at(coreCounter));
@@ -1395,8 +1556,8 @@ void SchedulerOpen::periodic(SubsecondTime time) {
 	if (time.getNS () % 1000000 == 0) { //Error Checking at every 1ms. Can be faster but will have overhead in simulation time.
 		cout << "\n[Scheduler]: Time " << formatTime(time) << " [Active Tasks =  " << numberOfActiveTasks () << " | Completed Tasks = " <<  numberOfTasksCompleted () << " | Queued Tasks = "  << numberOfTasksInQueue () << " | Non-Queued Tasks  = " <<  numberOfTasksWaitingToSchedule () <<  " | Free Cores = " << numberOfFreeCores () << " | Active Tasks Requirements = " << totalCoreRequirementsOfActiveTasks () << " ] \n" << endl;
 
-		// showtaskID(waitingTaskQ);
-		// showAQ(ActiveTaskQ);
+		// showQueue(waitingTaskQ);
+		// showQueue(ActiveTaskQ);
 		//Following error checking code makes sure that the system state is not messed up.
 
 		if (numberOfCores - totalCoreRequirementsOfActiveTasks () != numberOfFreeCores ()) {
@@ -1410,6 +1571,8 @@ void SchedulerOpen::periodic(SubsecondTime time) {
 		}
 	}
 
+	updatePowerGating(time);
+
 	if ((migrationPolicy != NULL) && (time.getNS() % migrationEpoch == 0)) {
 		cout << "\n[Scheduler]: Migration invoked at " << formatTime(time) << endl;
 
@@ -1436,6 +1599,7 @@ void SchedulerOpen::periodic(SubsecondTime time) {
 		
 		cout << "\n[Scheduler]: Scheduler Invoked at " << formatTime(time) << "\n" << endl;
 
+		generateArrivals (time);
 		fetchTasksIntoQueue (time);
 				
 
@@ -1452,7 +1616,9 @@ void SchedulerOpen::periodic(SubsecondTime time) {
 					cout << " ";
 				}
 				int coreId = getCoreNb(y, x);
-				if (!isAssignedToTask(coreId)) {
+				if (isGated(coreId)) {
+					cout << "  _ ";
+				} else if (!isAssignedToTask(coreId)) {
 					cout << "  . ";
 				} else {
 					if (systemCores[coreId].assignedTaskID < 10) {
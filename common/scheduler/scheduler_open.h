@@ -10,9 +10,12 @@
 #include "scheduler_pinned_base.h"
 #include "thermalModel.h"
 #include "performance_counters.h"
+#include "arrival_generator.h"
 #include "policies/dvfspolicy.h"
 #include "policies/mappingpolicy.h"
 #include "policies/migrationpolicy.h"
+#include "policies/admissionpolicy.h"
+#include "policies/powergatingpolicy.h"
 
 
 class SchedulerOpen : public SchedulerPinnedBase {
@@ -56,6 +59,11 @@ class SchedulerOpen : public SchedulerPinnedBase {
 		int maxFrequency;
 		int frequencyStepSize;
 
+		ArrivalGenerator *arrivalGenerator = NULL;
+		int nextArrivingTask = 0;
+		SInt64 arrivalTimeShift = 0;
+		void generateArrivals(SubsecondTime time);
+
 		void initPerforationPolicy(String policyName, int taskCount);
 		void executePerforationPolicy();
 
@@ -65,6 +73,21 @@ class SchedulerOpen : public SchedulerPinnedBase {
 		void executeMigrationPolicy(SubsecondTime time);
 		void migrateThread(thread_id_t thread_id, core_id_t core_id);
 
+		AdmissionPolicy *admissionPolicy = NULL;
+		void initAdmissionPolicy(String policyName);
+		bool admitTask(int taskID, const std::vector<int> &victims);
+		void preemptTask(int taskID, SubsecondTime time);
+		ThermalModel* getThermalModel();
+
+		PowerGatingPolicy *powerGatingPolicy = NULL;
+		long powerGatingEpoch;
+		UInt64 wakeupLatency; // ns before a thread mapped to a gated core can run
+		void initPowerGatingPolicy(String policyName);
+		void updatePowerGating(SubsecondTime time);
+		void wakeCore(int coreId, SubsecondTime time);
+		bool isGated(int coreId);
+		void pinThread(thread_id_t thread_id, core_id_t core_id);
+
 		std::string formatTime(SubsecondTime time);
 
 		core_id_t getNextCore(core_id_t core_first);
@@ -0,0 +1,99 @@
+/**
+ * task_heap
+ * This class implements the run queues of the open system scheduler.
+ */
+
+#include "task_heap.h"
+
+#include <cassert>
+
+TaskHeap::TaskHeap(Before before, unsigned int arity)
+    : before(before), arity(arity) {
+    assert(arity >= 2);
+}
+
+bool TaskHeap::contains(int taskID) const {
+    return taskID >= 0 && taskID < (int)position.size() && position.at(taskID) != -1;
+}
+
+int TaskHeap::top() const {
+    return heap.empty() ? -1 : heap.front();
+}
+
+void TaskHeap::place(unsigned int index, int taskID) {
+    heap.at(index) = taskID;
+    position.at(taskID) = index;
+}
+
+void TaskHeap::siftUp(unsigned int index) {
+    int taskID = heap.at(index);
+    while (index > 0) {
+        unsigned int parent = (index - 1) / arity;
+        if (!before(taskID, heap.at(parent))) {
+            break;
+        }
+        place(index, heap.at(parent));
+        index = parent;
+    }
+    place(index, taskID);
+}
+
+void TaskHeap::siftDown(unsigned int index) {
+    int taskID = heap.at(index);
+    while (true) {
+        unsigned int first = index * arity + 1;
+        if (first >= heap.size()) {
+            break;
+        }
+        unsigned int best = first;
+        for (unsigned int child = first + 1; child < first + arity && child < heap.size(); child++) {
+            if (before(heap.at(child), heap.at(best))) {
+                best = child;
+            }
+        }
+        if (!before(heap.at(best), taskID)) {
+            break;
+        }
+        place(index, heap.at(best));
+        index = best;
+    }
+    place(index, taskID);
+}
+
+void TaskHeap::push(int taskID) {
+    assert(taskID >= 0);
+    if (contains(taskID)) {
+        // The key of the task may have changed: restore the heap property in both directions
+        unsigned int index = position.at(taskID);
+        siftUp(index);
+        siftDown(position.at(taskID));
+        return;
+    }
+    if ((int)position.size() <= taskID) {
+        position.resize(taskID + 1, -1);
+    }
+    heap.push_back(taskID);
+    siftUp(heap.size() - 1);
+}
+
+void TaskHeap::pop() {
+    assert(!heap.empty());
+    remove(heap.front());
+}
+
+void TaskHeap::remove(int taskID) {
+    if (!contains(taskID)) {
+        return;
+    }
+    unsigned int index = position.at(taskID);
+    position.at(taskID) = -1;
+
+    int last = heap.back();
+    heap.pop_back();
+    if (index < heap.size()) {
+        // Move the last element into the hole, it may have to go either way
+        place(index, last);
+        siftUp(index);
+        siftDown(position.at(last));
+    }
+}
@@ -0,0 +1,45 @@
+/**
+ * task_heap
+ * This header implements the run queues of the open system scheduler: an indexed d-ary heap of task handles.
+ * The heap only stores task IDs; the ordering is defined by a comparator that looks up the task state,
+ * so tasks are never copied and a task whose key changed can be repositioned (or removed) in O(log n).
+ */
+
+#ifndef __TASK_HEAP_H
+#define __TASK_HEAP_H
+
+#include <functional>
+#include <vector>
+
+class TaskHeap {
+public:
+    // Returns true if task "a" must be served before task "b"
+    typedef std::function<bool(int a, int b)> Before;
+
+    TaskHeap(Before before, unsigned int arity = 4);
+
+    bool empty() const { return heap.empty(); }
+    unsigned int size() const { return heap.size(); }
+    bool contains(int taskID) const;
+    int top() const;
+
+    // Insert a task, or reposition it if it is already in the heap
+    void push(int taskID);
+    void pop();
+    void remove(int taskID);
+
+    // Task IDs in heap order (the first one is the top); for debug output
+    const std::vector<int> &handles() const { return heap; }
+
+private:
+    Before before;
+    unsigned int arity;
+    std::vector<int> heap;
+    std::vector<int> position; // index of each task in "heap", -1 if not contained
+
+    void place(unsigned int index, int taskID);
+    void siftUp(unsigned int index);
+    void siftDown(unsigned int index);
+};
+
+#endif
@@ -16,14 +16,18 @@
 #include <algorithm>
 
 BarrierSyncServer::BarrierSyncServer()
-   : m_local_clock_list(Sim()->getConfig()->getApplicationCores(), SubsecondTime::Zero())
+   : m_slack(SubsecondTime::Zero())
+   , m_local_clock_list(Sim()->getConfig()->getApplicationCores(), SubsecondTime::Zero())
    , m_barrier_acquire_list(Sim()->getConfig()->getApplicationCores(), false)
    , m_core_cond(Sim()->getConfig()->getApplicationCores(), NULL)
    , m_core_group(Sim()->getConfig()->getApplicationCores(), INVALID_CORE_ID)
+   , m_core_siblings(Sim()->getConfig()->getApplicationCores())
    , m_core_thread(Sim()->getConfig()->getApplicationCores(), INVALID_THREAD_ID)
    , m_global_time(SubsecondTime::Zero())
    , m_fastforward(false)
    , m_disable(false)
+   , m_reached_cursor(0)
+   , m_reached_any(false)
 {
    try
    {
@@ -43,6 +47,7 @@ BarrierSyncServer::BarrierSyncServer()
    Sim()->getHooksManager()->registerHook(HookType::HOOK_THREAD_EXIT, BarrierSyncServer::hookThreadExit, (UInt64)this, HooksManager::ORDER_NOTIFY_POST);
    Sim()->getHooksManager()->registerHook(HookType::HOOK_THREAD_STALL, BarrierSyncServer::hookThreadStall, (UInt64)this, HooksManager::ORDER_NOTIFY_POST);
    Sim()->getHooksManager()->registerHook(HookType::HOOK_THREAD_MIGRATE, BarrierSyncServer::hookThreadMigrate, (UInt64)this, HooksManager::ORDER_NOTIFY_POST);
+   Sim()->getHooksManager()->registerHook(HookType::HOOK_THREAD_RESUME, BarrierSyncServer::hookThreadResume, (UInt64)this, HooksManager::ORDER_NOTIFY_POST);
 
    registerStatsMetric("barrier", 0, "global_time", &m_global_time);
 }
@@ -83,6 +88,17 @@ BarrierSyncServer::synchronize(core_id_t core_id, SubsecondTime time)
       return;
    }
 
+   if (time < m_next_barrier_time + m_slack && !m_fastforward)
+   {
+      // Within the slack window: record our progress and keep running. If we were the last core holding back
+      // global time, advance it now, which may release cores that ran out of slack.
+      m_local_clock_list[master_core_id] = time;
+      if (isBarrierReached())
+         barrierRelease(thread_me);
+      CLOG("barrier", "Core %d slack exit", core_id);
+      return;
+   }
+
    // One thread entered the barrier, another one can resume
    doRelease(1);
 
@@ -142,6 +158,7 @@ BarrierSyncServer::releaseThread(thread_id_t thread_id)
          m_local_clock_list[core_id] = SubsecondTime::Zero();
       }
    }
+   resetReached();
    // One thread stopped running, release another one now
    doRelease(1);
 }
@@ -170,13 +187,10 @@ BarrierSyncServer::isCoreRunning(core_id_t core_id, bool siblings)
 
    if (siblings && !m_fastforward)
    {
-      for (core_id_t sibling_core_id = 0; sibling_core_id < (core_id_t) Sim()->getConfig()->getApplicationCores(); sibling_core_id++)
+      for (std::vector<core_id_t>::const_iterator it = m_core_siblings[core_id].begin(); it != m_core_siblings[core_id].end(); ++it)
       {
-         if (m_core_group[sibling_core_id] == core_id)
-         {
-            if (isCoreRunning(sibling_core_id, false))
-               return true;
-         }
+         if (isCoreRunning(*it, false))
+            return true;
       }
    }
 
@@ -192,19 +206,19 @@ BarrierSyncServer::advance()
 bool
 BarrierSyncServer::isBarrierReached()
 {
-   bool single_core_barrier_reached = false;
-
    // Check if all cores have reached the barrier
    // All least one core must have (sync_time > m_next_barrier_time)
-   for (core_id_t core_id = 0; core_id < (core_id_t) Sim()->getConfig()->getApplicationCores(); core_id++)
+   // Continue where the previous call stopped, see m_reached_cursor
+   for ( ; m_reached_cursor < (core_id_t) Sim()->getConfig()->getApplicationCores(); m_reached_cursor++)
    {
+      core_id_t core_id = m_reached_cursor;
       // In fastforward mode, it's enough that a core is waiting. In detailed mode, it needs to have advanced up to the predefined barrier time
       if (m_fastforward)
       {
          if (m_barrier_acquire_list[core_id])
          {
             // At least one core has reached the barrier
-            single_core_barrier_reached = true;
+            m_reached_any = true;
          }
          else if (isCoreRunning(core_id))
          {
@@ -228,12 +242,12 @@ BarrierSyncServer::isBarrierReached()
          else
          {
             // At least one core has reached the barrier
-            single_core_barrier_reached = true;
+            m_reached_any = true;
          }
       }
    }
 
-   return single_core_barrier_reached;
+   return m_reached_any;
 }
 
 bool
@@ -246,7 +260,8 @@ BarrierSyncServer::barrierRelease(thread_id_t caller_id, bool continue_until_rel
    // Advance m_next_barrier_time
    // Release the Barrier
 
-   LOG_ASSERT_ERROR(m_to_release.size() == 0, "Reached the barrier while some threads haven't even restarted?");
+   // With slack, threads that were released may already be past the next barrier time before they have restarted
+   LOG_ASSERT_ERROR(m_to_release.size() == 0 || m_slack > SubsecondTime::Zero(), "Reached the barrier while some threads haven't even restarted?");
 
    if (m_fastforward)
    {
@@ -286,9 +301,10 @@ BarrierSyncServer::barrierRelease(thread_id_t caller_id, bool continue_until_rel
       m_next_barrier_time += m_barrier_interval;
       LOG_PRINT("m_next_barrier_time updated to (%s)", itostr(m_next_barrier_time).c_str());
 
+      SubsecondTime release_time = m_fastforward ? m_next_barrier_time : m_next_barrier_time + m_slack;
       for (core_id_t core_id = 0; core_id < (core_id_t) Sim()->getConfig()->getApplicationCores(); core_id++)
       {
-         if (m_local_clock_list[core_id] < m_next_barrier_time)
+         if (m_local_clock_list[core_id] < release_time)
          {
             // Check if this core was running. If yes, release that core
             if (m_barrier_acquire_list[core_id] == true)
@@ -310,6 +326,16 @@ BarrierSyncServer::barrierRelease(thread_id_t caller_id, bool continue_until_rel
             }
          }
       }
+
+      resetReached();
+      if (m_slack > SubsecondTime::Zero() && !m_fastforward && !core_resumed)
+      {
+         // Cores that are still running within their slack window are forward progress too,
+         // only keep advancing global time while all of them are past it
+         if (!isBarrierReached())
+            break;
+         resetReached();
+      }
    }
 
    // To avoid overwhelming the OS scheduler, we only release N threads at a time (N ~= host cores).
@@ -350,6 +376,7 @@ BarrierSyncServer::abortBarrier()
          m_core_cond[core_id]->signal();
       }
    }
+   resetReached();
 }
 
 void
@@ -366,7 +393,16 @@ BarrierSyncServer::setGroup(core_id_t core_id, core_id_t master_core_id)
    if (master_core_id != INVALID_CORE_ID)
       LOG_ASSERT_ERROR(m_barrier_acquire_list[core_id] == false, "Core(%d) is in the barrier, cannot set participate to false", core_id);
 
+   if (m_core_group[core_id] != INVALID_CORE_ID)
+   {
+      std::vector<core_id_t> &siblings = m_core_siblings[m_core_group[core_id]];
+      siblings.erase(std::remove(siblings.begin(), siblings.end(), core_id), siblings.end());
+   }
+   if (master_core_id != INVALID_CORE_ID)
+      m_core_siblings[master_core_id].push_back(core_id);
+
    m_core_group[core_id] = master_core_id;
+   resetReached();
 }
 
 void
@@ -379,6 +415,7 @@ BarrierSyncServer::setFastForward(bool fastforward, SubsecondTime next_barrier_t
    {
       m_next_barrier_time = std::max(m_next_barrier_time, next_barrier_time);
    }
+   resetReached();
 }
 
 void
@@ -11,20 +11,32 @@ class CoreManager;
 
 class BarrierSyncServer : public ClockSkewMinimizationServer
 {
-   private:
+   protected:
       SubsecondTime m_barrier_interval;
       SubsecondTime m_next_barrier_time;
+      // How far cores may run past m_next_barrier_time before they have to wait in the barrier:
+      // zero for the barrier scheme, adapted at runtime by SlackSyncServer
+      SubsecondTime m_slack;
       std::vector<SubsecondTime> m_local_clock_list;
       std::vector<bool> m_barrier_acquire_list;
       std::vector<ConditionVariable*> m_core_cond;
       std::vector<core_id_t> m_to_release;
       std::vector<core_id_t> m_core_group;
+      std::vector<std::vector<core_id_t> > m_core_siblings; // Cores that have this core as their group master
       std::vector<thread_id_t> m_core_thread;
       SubsecondTime m_global_time;
       bool m_fastforward;
       volatile bool m_disable;
+      // Incremental isBarrierReached(): all cores below m_reached_cursor have been checked and are either
+      // not running or have reached the barrier. Cores only ever move towards reaching the barrier when they
+      // arrive, anything else that can make a core block the barrier again (a thread resuming or migrating,
+      // a new barrier time, ...) resets the cursor. This way, every arrival does not have to rescan all cores.
+      core_id_t m_reached_cursor;
+      bool m_reached_any;        // A running core below m_reached_cursor has reached the barrier
 
+   private:
       bool isBarrierReached(void);
+      void resetReached(void) { m_reached_cursor = 0; m_reached_any = false; }
       bool barrierRelease(thread_id_t thread_id = INVALID_THREAD_ID, bool continue_until_release = false);
       void abortBarrier(void);
       bool isCoreRunning(core_id_t core_id, bool siblings = true);
@@ -41,13 +53,16 @@ class BarrierSyncServer : public ClockSkewMinimizationServer
       static SInt64 hookThreadMigrate(UInt64 object, UInt64 argument) {
          ((BarrierSyncServer*)object)->threadMigrate((HooksManager::ThreadMigrate*)argument); return 0;
       }
+      static SInt64 hookThreadResume(UInt64 object, UInt64 argument) {
+         ((BarrierSyncServer*)object)->resetReached(); return 0;
+      }
       void threadExit(HooksManager::ThreadTime *argument);
       void threadStall(HooksManager::ThreadStall *argument);
       void threadMigrate(HooksManager::ThreadMigrate *argument);
 
    public:
       BarrierSyncServer();
-      ~BarrierSyncServer();
+      virtual ~BarrierSyncServer();
 
       virtual void setDisable(bool disable);
       virtual void setGroup(core_id_t core_id, core_id_t master_core_id);
@@ -1,6 +1,7 @@
 #include "clock_skew_minimization_object.h"
 #include "barrier_sync_client.h"
 #include "barrier_sync_server.h"
+#include "slack_sync_server.h"
 #include "simulator.h"
 #include "log.h"
 #include "config.hpp"
@@ -10,6 +11,8 @@ ClockSkewMinimizationObject::parseScheme(String scheme)
 {
    if (scheme == "barrier")
       return BARRIER;
+   else if (scheme == "slack")
+      return SLACK;
    else
    {
       config::Error("Unrecognized clock skew minimization scheme: %s", scheme.c_str());
@@ -24,6 +27,7 @@ ClockSkewMinimizationClient::create(Core* core)
    switch (scheme)
    {
       case BARRIER:
+      case SLACK:
          return new BarrierSyncClient(core);
 
       default:
@@ -40,6 +44,7 @@ ClockSkewMinimizationManager::create()
    switch (scheme)
    {
       case BARRIER:
+      case SLACK:
          return (ClockSkewMinimizationManager*) NULL;
 
       default:
@@ -58,6 +63,9 @@ ClockSkewMinimizationServer::create()
       case BARRIER:
          return new BarrierSyncServer();
 
+      case SLACK:
+         return new SlackSyncServer();
+
       default:
          LOG_PRINT_ERROR("Unrecognized scheme: %u", scheme);
          return (ClockSkewMinimizationServer*) NULL;
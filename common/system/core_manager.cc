@@ -28,6 +28,8 @@ CoreManager::CoreManager()
       m_cores.push_back(new Core(i));
    }
 
+   Cache::printMemoryUsage();
+
    LOG_PRINT("Finished CoreManager Constructor.");
 }
 
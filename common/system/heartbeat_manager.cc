@@ -0,0 +1,196 @@
+#include "heartbeat_manager.h"
+#include "simulator.h"
+#include "config.hpp"
+#include "stats.h"
+#include "log.h"
+
+HeartbeatManager::AppHeartbeat::AppHeartbeat(UInt32 window_size)
+   : m_has_target(false)
+   , m_min_rate(0)
+   , m_max_rate(0)
+   , m_beats(0)
+   , m_beats_below_target(0)
+   , m_beats_above_target(0)
+   , m_last_tag(0)
+   , m_first_time(SubsecondTime::Zero())
+   , m_last_time(SubsecondTime::Zero())
+   , m_window(window_size, SubsecondTime::Zero())
+   , m_window_index(0)
+   , m_window_fill(0)
+   , m_window_total(SubsecondTime::Zero())
+   , m_window_rate(0)
+   , m_instant_rate(0)
+   , m_global_rate(0)
+{
+}
+
+HeartbeatManager::HeartbeatManager()
+   : m_window_size(Sim()->getCfg()->getInt("heartbeat/window_size"))
+{
+   LOG_ASSERT_ERROR(m_window_size > 0, "heartbeat/window_size must be at least 1");
+}
+
+HeartbeatManager::~HeartbeatManager()
+{
+   for(std::vector<AppHeartbeat*>::iterator it = m_apps.begin(); it != m_apps.end(); ++it)
+      if (*it)
+         delete *it;
+}
+
+HeartbeatManager::AppHeartbeat* HeartbeatManager::getApp(app_id_t app_id)
+{
+   LOG_ASSERT_ERROR(app_id >= 0, "Invalid application id %d", app_id);
+
+   if (m_apps.size() <= (size_t)app_id)
+      m_apps.resize(app_id + 1, NULL);
+
+   if (m_apps[app_id] == NULL)
+   {
+      AppHeartbeat *app = new AppHeartbeat(m_window_size);
+      m_apps[app_id] = app;
+
+      registerStatsMetric("heartbeat", app_id, "beats", &app->m_beats);
+      registerStatsMetric("heartbeat", app_id, "beats_below_target", &app->m_beats_below_target);
+      registerStatsMetric("heartbeat", app_id, "beats_above_target", &app->m_beats_above_target);
+      registerStatsMetric("heartbeat", app_id, "first_beat_time", &app->m_first_time);
+      registerStatsMetric("heartbeat", app_id, "last_beat_time", &app->m_last_time);
+   }
+
+   return m_apps[app_id];
+}
+
+const HeartbeatManager::AppHeartbeat* HeartbeatManager::findApp(app_id_t app_id) const
+{
+   if (app_id < 0 || m_apps.size() <= (size_t)app_id)
+      return NULL;
+   return m_apps[app_id];
+}
+
+void HeartbeatManager::setTarget(app_id_t app_id, double min_rate, double max_rate)
+{
+   ScopedLock sl(m_lock);
+
+   LOG_ASSERT_ERROR(min_rate <= max_rate || max_rate == 0, "Heartbeat target window for app %d is empty (min %f > max %f)", app_id, min_rate, max_rate);
+
+   AppHeartbeat *app = getApp(app_id);
+   app->m_has_target = true;
+   app->m_min_rate = min_rate;
+   app->m_max_rate = max_rate;
+}
+
+void HeartbeatManager::beat(app_id_t app_id, thread_id_t thread_id, UInt64 tag, SubsecondTime time)
+{
+   ScopedLock sl(m_lock);
+
+   AppHeartbeat *app = getApp(app_id);
+   app->m_last_tag = tag;
+
+   if (app->m_beats == 0)
+   {
+      app->m_first_time = time;
+      app->m_last_time = time;
+      app->m_beats = 1;
+      return;
+   }
+
+   // Beats from different threads of the same application can arrive slightly out of order
+   SubsecondTime interval = time > app->m_last_time ? time - app->m_last_time : SubsecondTime::Zero();
+
+   if (app->m_window_fill == m_window_size)
+      app->m_window_total -= app->m_window[app->m_window_index];
+   else
+      ++app->m_window_fill;
+   app->m_window[app->m_window_index] = interval;
+   app->m_window_total += interval;
+   app->m_window_index = (app->m_window_index + 1) % m_window_size;
+
+   app->m_last_time = std::max(app->m_last_time, time);
+   ++app->m_beats;
+
+   // Rates are in beats per second, SubsecondTime is kept in femtoseconds
+   app->m_instant_rate = interval.getFS() ? 1e15 / interval.getFS() : 0;
+   app->m_window_rate = app->m_window_total.getFS() ? 1e15 * app->m_window_fill / app->m_window_total.getFS() : 0;
+   SubsecondTime elapsed = app->m_last_time - app->m_first_time;
+   app->m_global_rate = elapsed.getFS() ? 1e15 * (app->m_beats - 1) / elapsed.getFS() : 0;
+
+   if (app->m_has_target)
+   {
+      if (app->m_window_rate < app->m_min_rate)
+         ++app->m_beats_below_target;
+      else if (app->m_max_rate > 0 && app->m_window_rate > app->m_max_rate)
+         ++app->m_beats_above_target;
+   }
+}
+
+bool HeartbeatManager::hasTarget(app_id_t app_id) const
+{
+   ScopedLock sl(m_lock);
+   const AppHeartbeat *app = findApp(app_id);
+   return app && app->m_has_target;
+}
+
+UInt64 HeartbeatManager::getBeats(app_id_t app_id) const
+{
+   ScopedLock sl(m_lock);
+   const AppHeartbeat *app = findApp(app_id);
+   return app ? app->m_beats : 0;
+}
+
+SubsecondTime HeartbeatManager::getLastBeatTime(app_id_t app_id) const
+{
+   ScopedLock sl(m_lock);
+   const AppHeartbeat *app = findApp(app_id);
+   return app ? app->m_last_time : SubsecondTime::Zero();
+}
+
+double HeartbeatManager::getMinTarget(app_id_t app_id) const
+{
+   ScopedLock sl(m_lock);
+   const AppHeartbeat *app = findApp(app_id);
+   return app ? app->m_min_rate : 0;
+}
+
+double HeartbeatManager::getMaxTarget(app_id_t app_id) const
+{
+   ScopedLock sl(m_lock);
+   const AppHeartbeat *app = findApp(app_id);
+   return app ? app->m_max_rate : 0;
+}
+
+double HeartbeatManager::getWindowRate(app_id_t app_id) const
+{
+   ScopedLock sl(m_lock);
+   const AppHeartbeat *app = findApp(app_id);
+   return app ? app->m_window_rate : 0;
+}
+
+double HeartbeatManager::getInstantRate(app_id_t app_id) const
+{
+   ScopedLock sl(m_lock);
+   const AppHeartbeat *app = findApp(app_id);
+   return app ? app->m_instant_rate : 0;
+}
+
+double HeartbeatManager::getGlobalRate(app_id_t app_id) const
+{
+   ScopedLock sl(m_lock);
+   const AppHeartbeat *app = findApp(app_id);
+   return app ? app->m_global_rate : 0;
+}
+
+double HeartbeatManager::getSlack(app_id_t app_id) const
+{
+   ScopedLock sl(m_lock);
+   const AppHeartbeat *app = findApp(app_id);
+   // Without a target, or before the first full interval, there is no meaningful slack
+   if (!app || !app->m_has_target || app->m_window_fill == 0 || app->m_min_rate <= 0)
+      return 0;
+
+   // A max_rate of zero means the target window is unbounded from above
+   if (app->m_window_rate < app->m_min_rate)
+      return (app->m_window_rate - app->m_min_rate) / app->m_min_rate;
+   else if (app->m_max_rate > 0 && app->m_window_rate > app->m_max_rate)
+      return (app->m_window_rate - app->m_max_rate) / app->m_max_rate;
+   else
+      return 0;
+}
@@ -0,0 +1,72 @@
+#ifndef __HEARTBEAT_MANAGER_H
+#define __HEARTBEAT_MANAGER_H
+
+#include "fixed_types.h"
+#include "subsecond_time.h"
+#include "lock.h"
+
+#include <vector>
+
+// Tracks application progress reported through SimHeartbeat() / SimHeartbeatTarget() magic instructions.
+// Heart rates (window, instant and global) are computed natively in simulated time, so scheduling
+// policies can use them as a QoS target without parsing the heartbeat library's text logs.
+
+class HeartbeatManager
+{
+   public:
+      HeartbeatManager();
+      ~HeartbeatManager();
+
+      // Called from MagicServer. Rates are in beats per second.
+      void setTarget(app_id_t app_id, double min_rate, double max_rate);
+      void beat(app_id_t app_id, thread_id_t thread_id, UInt64 tag, SubsecondTime time);
+
+      bool hasTarget(app_id_t app_id) const;
+      UInt64 getBeats(app_id_t app_id) const;
+      SubsecondTime getLastBeatTime(app_id_t app_id) const;
+      double getMinTarget(app_id_t app_id) const;
+      double getMaxTarget(app_id_t app_id) const;
+      double getWindowRate(app_id_t app_id) const;
+      double getInstantRate(app_id_t app_id) const;
+      double getGlobalRate(app_id_t app_id) const;
+
+      // Relative distance of the window heart rate to the target window: < 0 when the application
+      // is below its minimum rate, > 0 when it exceeds its maximum rate, 0 inside the window or without a target.
+      double getSlack(app_id_t app_id) const;
+
+   private:
+      class AppHeartbeat
+      {
+         public:
+            AppHeartbeat(UInt32 window_size);
+
+            bool m_has_target;
+            double m_min_rate;
+            double m_max_rate;
+
+            UInt64 m_beats;
+            UInt64 m_beats_below_target;
+            UInt64 m_beats_above_target;
+            UInt64 m_last_tag;
+            SubsecondTime m_first_time;
+            SubsecondTime m_last_time;
+
+            std::vector<SubsecondTime> m_window;   // Circular buffer of the most recent inter-beat intervals
+            UInt32 m_window_index;
+            UInt32 m_window_fill;
+            SubsecondTime m_window_total;
+
+            double m_window_rate;
+            double m_instant_rate;
+            double m_global_rate;
+      };
+
+      mutable Lock m_lock;
+      const UInt32 m_window_size;
+      std::vector<AppHeartbeat*> m_apps;
+
+      AppHeartbeat* getApp(app_id_t app_id);
+      const AppHeartbeat* findApp(app_id_t app_id) const;
+};
+
+#endif // __HEARTBEAT_MANAGER_H
@@ -33,6 +33,8 @@ UInt64 handleMagicInstruction(thread_id_t thread_id, UInt64 cmd, UInt64 arg0, UI
    case SIM_CMD_INSTRUMENT_MODE:
    case SIM_CMD_MHZ_GET:
    case SIM_CMD_SET_THREAD_NAME:
+   case SIM_CMD_HEARTBEAT_TARGET:
+   case SIM_CMD_HEARTBEAT:
       return handleMagic(thread_id, cmd, arg0, arg1);
    case SIM_CMD_PROC_ID:
    {
@@ -11,6 +11,7 @@
 #include "stats.h"
 #include "timer.h"
 #include "thread.h"
+#include "heartbeat_manager.h"
 
 MagicServer::MagicServer()
       : m_performance_enabled(false)
@@ -99,6 +100,19 @@ UInt64 MagicServer::Magic_unlocked(thread_id_t thread_id, core_id_t core_id, UIn
          return setInstrumentationMode(arg0);
       case SIM_CMD_MHZ_GET:
          return getFrequency(arg0);
+      case SIM_CMD_HEARTBEAT_TARGET:
+      {
+         app_id_t app_id = Sim()->getThreadManager()->getThreadFromID(thread_id)->getAppId();
+         Sim()->getHeartbeatManager()->setTarget(app_id, arg0 / 1000., arg1 / 1000.);
+         return 0;
+      }
+      case SIM_CMD_HEARTBEAT:
+      {
+         app_id_t app_id = Sim()->getThreadManager()->getThreadFromID(thread_id)->getAppId();
+         SubsecondTime time = Sim()->getCoreManager()->getCoreFromID(core_id)->getPerformanceModel()->getElapsedTime();
+         Sim()->getHeartbeatManager()->beat(app_id, thread_id, arg0, time);
+         return time.getNS();
+      }
       default:
          LOG_ASSERT_ERROR(false, "Got invalid Magic %lu, arg0(%lu) arg1(%lu)", cmd, arg0, arg1);
    }
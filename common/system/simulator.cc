@@ -26,6 +26,7 @@
 #include "tags.h"
 #include "instruction_tracer.h"
 #include "memory_tracker.h"
+#include "heartbeat_manager.h"
 #include "circular_log.h"
 
 #include <sstream>
@@ -122,6 +123,7 @@ Simulator::Simulator()
    , m_faultinjection_manager(NULL)
    , m_rtn_tracer(NULL)
    , m_memory_tracker(NULL)
+   , m_heartbeat_manager(NULL)
    , m_running(false)
    , m_inst_mode_output(true)
 {
@@ -138,9 +140,12 @@ void Simulator::start()
    m_syscall_server = new SyscallServer();
    m_sync_server = new SyncServer();
    m_magic_server = new MagicServer();
+   m_heartbeat_manager = new HeartbeatManager();
    m_transport = Transport::create();
    m_dvfs_manager = new DvfsManager();
    m_faultinjection_manager = FaultinjectionManager::create();
+   LOG_ASSERT_ERROR(!(m_faultinjection_manager && m_config.getTimingOnlyMemory()),
+                    "Fault injection needs cache line data, which is not kept with caching_protocol/timing_only");
    m_thread_stats_manager = new ThreadStatsManager();
    m_clock_skew_minimization_manager = ClockSkewMinimizationManager::create();
    m_clock_skew_minimization_server = ClockSkewMinimizationServer::create();
@@ -252,6 +257,7 @@ Simulator::~Simulator()
    delete m_thread_stats_manager;      m_thread_stats_manager = NULL;
    delete m_core_manager;              m_core_manager = NULL;
    delete m_dvfs_manager;              m_dvfs_manager = NULL;
+   delete m_heartbeat_manager;         m_heartbeat_manager = NULL;
    delete m_magic_server;              m_magic_server = NULL;
    delete m_sync_server;               m_sync_server = NULL;
    delete m_syscall_server;            m_syscall_server = NULL;
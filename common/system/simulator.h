@@ -29,6 +29,7 @@ class FaultinjectionManager;
 class TagsManager;
 class RoutineTracer;
 class MemoryTracker;
+class HeartbeatManager;
 namespace config { class Config; }
 
 class Simulator
@@ -70,6 +71,7 @@ public:
    TagsManager *getTagsManager() { return m_tags_manager; }
    RoutineTracer *getRoutineTracer() { return m_rtn_tracer; }
    MemoryTracker *getMemoryTracker() { return m_memory_tracker; }
+   HeartbeatManager *getHeartbeatManager() { return m_heartbeat_manager; }
    void setMemoryTracker(MemoryTracker *memory_tracker) { m_memory_tracker = memory_tracker; }
 
    bool isRunning() { return m_running; }
@@ -106,6 +108,7 @@ private:
    FaultinjectionManager *m_faultinjection_manager;
    RoutineTracer *m_rtn_tracer;
    MemoryTracker *m_memory_tracker;
+   HeartbeatManager *m_heartbeat_manager;
 
    bool m_running;
    bool m_inst_mode_output;
@@ -0,0 +1,163 @@
+#include "slack_sync_server.h"
+#include "simulator.h"
+#include "config.h"
+#include "config.hpp"
+#include "thread_manager.h"
+#include "stats.h"
+#include "log.h"
+#include "circular_log.h"
+
+SlackSyncServer::SlackSyncServer()
+   : m_epoch_end(SubsecondTime::Zero())
+   , m_coherence_metrics_found(false)
+   , m_coherence_last(0)
+   , m_epoch_sync_events(0)
+   , m_epoch_max_skew(SubsecondTime::Zero())
+   , m_epoch_stall_time(SubsecondTime::Zero())
+   , m_num_epochs(0)
+   , m_num_shrink(0)
+   , m_num_grow(0)
+   , m_sync_events(0)
+   , m_coherence_events(0)
+   , m_max_skew(SubsecondTime::Zero())
+   , m_total_skew(SubsecondTime::Zero())
+   , m_stall_time(SubsecondTime::Zero())
+{
+   m_slack_min = SubsecondTime::NS() * Sim()->getCfg()->getInt("clock_skew_minimization/slack/min");
+   m_slack_max = SubsecondTime::NS() * Sim()->getCfg()->getInt("clock_skew_minimization/slack/max");
+   m_epoch_length = SubsecondTime::NS() * Sim()->getCfg()->getInt("clock_skew_minimization/slack/epoch");
+   m_sharing_threshold = Sim()->getCfg()->getInt("clock_skew_minimization/slack/sharing_threshold");
+
+   LOG_ASSERT_ERROR(m_slack_min > SubsecondTime::Zero() && m_slack_min <= m_slack_max,
+                    "Invalid clock_skew_minimization/slack window, need 0 < min <= max");
+   LOG_ASSERT_ERROR(m_epoch_length >= m_barrier_interval,
+                    "clock_skew_minimization/slack/epoch should be at least one barrier quantum");
+
+   // Start out accurate, the window grows as long as cores do not interact
+   m_slack = m_slack_min;
+   m_epoch_end = m_epoch_length;
+
+   Sim()->getHooksManager()->registerHook(HookType::HOOK_PERIODIC, SlackSyncServer::hookPeriodic, (UInt64)this, HooksManager::ORDER_NOTIFY_PRE);
+   Sim()->getHooksManager()->registerHook(HookType::HOOK_THREAD_STALL, SlackSyncServer::hookThreadStall, (UInt64)this, HooksManager::ORDER_NOTIFY_PRE);
+   Sim()->getHooksManager()->registerHook(HookType::HOOK_THREAD_RESUME, SlackSyncServer::hookThreadResume, (UInt64)this, HooksManager::ORDER_NOTIFY_PRE);
+
+   registerStatsMetric("slack", 0, "window", &m_slack);
+   registerStatsMetric("slack", 0, "epochs", &m_num_epochs);
+   registerStatsMetric("slack", 0, "epochs-shrink", &m_num_shrink);
+   registerStatsMetric("slack", 0, "epochs-grow", &m_num_grow);
+   registerStatsMetric("slack", 0, "sync-events", &m_sync_events);
+   registerStatsMetric("slack", 0, "coherence-events", &m_coherence_events);
+   registerStatsMetric("slack", 0, "max-skew", &m_max_skew);
+   registerStatsMetric("slack", 0, "total-skew", &m_total_skew);
+   registerStatsMetric("slack", 0, "stall-time", &m_stall_time);
+}
+
+SlackSyncServer::~SlackSyncServer()
+{
+}
+
+void
+SlackSyncServer::threadStall(HooksManager::ThreadStall *argument)
+{
+   switch(argument->reason)
+   {
+      case ThreadManager::STALL_JOIN:
+      case ThreadManager::STALL_MUTEX:
+      case ThreadManager::STALL_COND:
+      case ThreadManager::STALL_BARRIER:
+      case ThreadManager::STALL_FUTEX:
+         ++m_epoch_sync_events;
+         break;
+      default:
+         // Scheduling, sleeping and system calls do not imply communication with other threads
+         break;
+   }
+}
+
+void
+SlackSyncServer::threadResume(HooksManager::ThreadResume *argument)
+{
+   // Woken up by another thread, e.g. a futex wake or mutex unlock
+   if (argument->thread_by != INVALID_THREAD_ID)
+      ++m_epoch_sync_events;
+}
+
+UInt64
+SlackSyncServer::getCoherenceEvents()
+{
+   if (!m_coherence_metrics_found)
+   {
+      // Stats are registered by the memory hierarchy, which may not use these names
+      for(core_id_t core_id = 0; core_id < (core_id_t)Sim()->getConfig()->getApplicationCores(); ++core_id)
+      {
+         if (StatsMetricBase *metric = Sim()->getStatsManager()->getMetricObject("L1-D", core_id, "coherency-invalidates"))
+            m_coherence_metrics.push_back(metric);
+         if (StatsMetricBase *metric = Sim()->getStatsManager()->getMetricObject("L1-D", core_id, "coherency-downgrades"))
+            m_coherence_metrics.push_back(metric);
+      }
+      m_coherence_metrics_found = true;
+   }
+
+   UInt64 events = 0;
+   for(std::vector<StatsMetricBase*>::iterator it = m_coherence_metrics.begin(); it != m_coherence_metrics.end(); ++it)
+      events += (*it)->recordMetric();
+   return events;
+}
+
+void
+SlackSyncServer::periodic(SubsecondTime time)
+{
+   if (m_fastforward)
+      return;
+
+   for(core_id_t core_id = 0; core_id < (core_id_t)Sim()->getConfig()->getApplicationCores(); ++core_id)
+   {
+      if (m_core_group[core_id] != INVALID_CORE_ID)
+         continue;
+      if (m_local_clock_list[core_id] > time)
+      {
+         SubsecondTime skew = m_local_clock_list[core_id] - time;
+         m_epoch_max_skew = std::max(m_epoch_max_skew, skew);
+         m_total_skew += skew;
+      }
+      // Cores that ran out of slack are waiting for this barrier
+      if (m_barrier_acquire_list[core_id])
+         m_epoch_stall_time += m_barrier_interval;
+   }
+
+   if (time >= m_epoch_end)
+      endEpoch(time);
+}
+
+void
+SlackSyncServer::endEpoch(SubsecondTime time)
+{
+   UInt64 coherence = getCoherenceEvents();
+   UInt64 epoch_coherence = coherence >= m_coherence_last ? coherence - m_coherence_last : coherence;
+   m_coherence_last = coherence;
+
+   if (m_epoch_sync_events > 0 || epoch_coherence > m_sharing_threshold)
+   {
+      m_slack = std::max(m_slack_min, m_slack / 2);
+      ++m_num_shrink;
+   }
+   else
+   {
+      m_slack = std::min(m_slack_max, m_slack * 2);
+      ++m_num_grow;
+   }
+
+   CLOG("barrier", "Slack epoch %" PRId64 "ns: sync %" PRIu64 " coherence %" PRIu64 " max-skew %" PRId64 "ns stall %" PRId64 "ns, window now %" PRId64 "ns",
+        time.getNS(), m_epoch_sync_events, epoch_coherence, m_epoch_max_skew.getNS(), m_epoch_stall_time.getNS(), m_slack.getNS());
+
+   ++m_num_epochs;
+   m_sync_events += m_epoch_sync_events;
+   m_coherence_events += epoch_coherence;
+   m_max_skew = std::max(m_max_skew, m_epoch_max_skew);
+   m_stall_time += m_epoch_stall_time;
+
+   m_epoch_sync_events = 0;
+   m_epoch_max_skew = SubsecondTime::Zero();
+   m_epoch_stall_time = SubsecondTime::Zero();
+   m_epoch_end = time + m_epoch_length;
+}
@@ -0,0 +1,62 @@
+#ifndef __SLACK_SYNC_SERVER_H__
+#define __SLACK_SYNC_SERVER_H__
+
+#include "clock_skew_minimization_object.h"
+#include "barrier_sync_server.h"
+
+class StatsMetricBase;
+
+// Slack scheme: global time advances in barrier quanta as with the barrier scheme, but cores only wait
+// once they are more than a slack window ahead of it. The window is adapted every epoch: it is halved
+// when the previous epoch saw synchronization (threads blocking on or waking up each other) or coherence
+// traffic between cores, and doubled when it did not, between clock_skew_minimization/slack/min and max.
+class SlackSyncServer : public BarrierSyncServer
+{
+   private:
+      SubsecondTime m_slack_min;
+      SubsecondTime m_slack_max;
+      SubsecondTime m_epoch_length;
+      UInt64 m_sharing_threshold;
+      SubsecondTime m_epoch_end;
+
+      std::vector<StatsMetricBase*> m_coherence_metrics;
+      bool m_coherence_metrics_found;
+      UInt64 m_coherence_last;
+
+      // Current epoch
+      UInt64 m_epoch_sync_events;
+      SubsecondTime m_epoch_max_skew;
+      SubsecondTime m_epoch_stall_time;
+
+      // Totals
+      UInt64 m_num_epochs;
+      UInt64 m_num_shrink;
+      UInt64 m_num_grow;
+      UInt64 m_sync_events;
+      UInt64 m_coherence_events;
+      SubsecondTime m_max_skew;
+      SubsecondTime m_total_skew;
+      SubsecondTime m_stall_time;
+
+      UInt64 getCoherenceEvents();
+      void endEpoch(SubsecondTime time);
+
+      static SInt64 hookPeriodic(UInt64 object, UInt64 time) {
+         ((SlackSyncServer*)object)->periodic(*(subsecond_time_t*)&time); return 0;
+      }
+      static SInt64 hookThreadStall(UInt64 object, UInt64 argument) {
+         ((SlackSyncServer*)object)->threadStall((HooksManager::ThreadStall*)argument); return 0;
+      }
+      static SInt64 hookThreadResume(UInt64 object, UInt64 argument) {
+         ((SlackSyncServer*)object)->threadResume((HooksManager::ThreadResume*)argument); return 0;
+      }
+      void periodic(SubsecondTime time);
+      void threadStall(HooksManager::ThreadStall *argument);
+      void threadResume(HooksManager::ThreadResume *argument);
+
+   public:
+      SlackSyncServer();
+      ~SlackSyncServer();
+};
+
+#endif /* __SLACK_SYNC_SERVER_H__ */
@@ -4,6 +4,7 @@
 #include "instruction.h"
 #include "hooks_manager.h"
 #include "config.h"
+#include "config.hpp"
 #include "log.h"
 #include "stats.h"
 #include "transport.h"
@@ -11,6 +12,7 @@
 #include "clock_skew_minimization_object.h"
 #include "core.h"
 #include "thread.h"
+#include "thread_stats_manager.h"
 #include "scheduler.h"
 #include "syscall_server.h"
 #include "circular_log.h"
@@ -25,14 +27,18 @@ static_assert(ThreadManager::STALL_TYPES_MAX == sizeof(ThreadManager::stall_type
               "Not enough values in ThreadManager::stall_type_names");
 
 ThreadManager::ThreadManager()
-   : m_thread_tls(TLS::create())
+   : m_thread_lock("thread_manager")
+   , m_thread_state(ThreadStatsManager::MAX_THREADS)
+   , m_num_active(0)
+   , m_thread_tls(TLS::create())
    , m_scheduler(Scheduler::create(this))
 {
+   m_thread_lock.setProfiling(Sim()->getCfg()->getBool("general/profile_thread_lock"));
 }
 
 ThreadManager::~ThreadManager()
 {
-   for (UInt32 i = 0; i < m_thread_state.size(); i++)
+   for (UInt32 i = 0; i < m_threads.size(); i++)
    {
       #if 0 // Disabled: applications are not required to do proper cleanup
       if (m_thread_state[i].status != Core::IDLE)
@@ -74,10 +80,10 @@ Thread* ThreadManager::createThread(app_id_t app_id, thread_id_t creator_thread_
 Thread* ThreadManager::createThread_unlocked(app_id_t app_id, thread_id_t creator_thread_id,String app_name)
 {
    thread_id_t thread_id = m_threads.size();
+   LOG_ASSERT_ERROR((UInt32)thread_id < m_thread_state.size(), "Too many application threads, increase ThreadStatsManager::MAX_THREADS");
    Thread *thread = new Thread(thread_id, app_id,app_name);
    m_threads.push_back(thread);
-   m_thread_state.push_back(ThreadState());
-   m_thread_state[thread->getId()].status = Core::INITIALIZING;
+   setThreadStatus(thread_id, Core::INITIALIZING);
 
    core_id_t core_id = m_scheduler->threadCreate(thread_id);
    if (core_id != INVALID_CORE_ID)
@@ -107,7 +113,7 @@ void ThreadManager::onThreadStart(thread_id_t thread_id, SubsecondTime time)
    thread->updateCoreTLS();
 
    // Set thread state to running for the duration of HOOK_THREAD_START, we'll move it to stalled later on if it didn't have a core
-   m_thread_state[thread_id].status = Core::RUNNING;
+   setThreadStatus(thread_id, Core::RUNNING);
 
    HooksManager::ThreadTime args = { thread_id: thread_id, time: time };
    Sim()->getHooksManager()->callHooks(HookType::HOOK_THREAD_START, (UInt64)&args);
@@ -127,14 +133,14 @@ void ThreadManager::onThreadStart(thread_id_t thread_id, SubsecondTime time)
       pm->queuePseudoInstruction(new SpawnInstruction(time));
 
       LOG_PRINT("Setting status[%i] -> RUNNING", thread_id);
-      m_thread_state[thread_id].status = Core::RUNNING;
+      setThreadStatus(thread_id, Core::RUNNING);
 
       HooksManager::ThreadMigrate args = { thread_id: thread_id, core_id: core->getId(), time: time };
       Sim()->getHooksManager()->callHooks(HookType::HOOK_THREAD_MIGRATE, (UInt64)&args);
    }
    else
    {
-      m_thread_state[thread_id].status = Core::STALLED;
+      setThreadStatus(thread_id, Core::STALLED);
       m_thread_state[thread_id].stalled_reason = STALL_UNSCHEDULED;
    }
 
@@ -149,7 +155,7 @@ void ThreadManager::onThreadExit(thread_id_t thread_id)
 {
    ScopedLock sl(m_thread_lock);
 
-   LOG_ASSERT_ERROR((UInt32)thread_id < m_thread_state.size(), "Thread id out of range: %d", thread_id);
+   LOG_ASSERT_ERROR((UInt32)thread_id < m_threads.size(), "Thread id out of range: %d", thread_id);
 
    Thread *thread = getThreadFromID(thread_id);
    Core *core = thread->getCore();
@@ -158,7 +164,7 @@ void ThreadManager::onThreadExit(thread_id_t thread_id)
    SubsecondTime time = core->getPerformanceModel()->getElapsedTime();
 
    assert(m_thread_state[thread_id].status == Core::RUNNING);
-   m_thread_state[thread_id].status = Core::IDLE;
+   setThreadStatus(thread_id, Core::IDLE);
 
    // Implement pthread_join
    wakeUpWaiter(thread_id, time);
@@ -276,7 +282,7 @@ bool ThreadManager::areAllCoresRunning()
 {
    // Check if all the cores are running
    bool is_all_running = true;
-   for (SInt32 i = 0; i < (SInt32) m_thread_state.size(); i++)
+   for (SInt32 i = 0; i < (SInt32) m_threads.size(); i++)
    {
       if (m_thread_state[i].status == Core::IDLE)
       {
@@ -336,10 +342,17 @@ void ThreadManager::wakeUpWaiter(thread_id_t thread_id, SubsecondTime time)
    LOG_PRINT("Exiting wakeUpWaiter");
 }
 
+void ThreadManager::postStallThread(thread_id_t thread_id, stall_type_t reason, SubsecondTime time)
+{
+   // The stalling thread does not need the outcome (a blocking system call marking itself as asleep),
+   // so rather than waiting for the lock, leave the stall and its hooks to whoever holds it
+   m_thread_lock.post([=]() { stallThread_async(thread_id, reason, time); });
+}
+
 void ThreadManager::stallThread_async(thread_id_t thread_id, stall_type_t reason, SubsecondTime time)
 {
    LOG_PRINT("Core(%i) -> STALLED", thread_id);
-   m_thread_state[thread_id].status = Core::STALLED;
+   setThreadStatus(thread_id, Core::STALLED);
    m_thread_state[thread_id].stalled_reason = reason;
 
    HooksManager::ThreadStall args = { thread_id: thread_id, reason: reason, time: time };
@@ -368,7 +381,7 @@ SubsecondTime ThreadManager::stallThread(thread_id_t thread_id, stall_type_t rea
 void ThreadManager::resumeThread_async(thread_id_t thread_id, thread_id_t thread_by, SubsecondTime time, void *msg)
 {
    LOG_PRINT("Core(%i) -> RUNNING", thread_id);
-   m_thread_state[thread_id].status = Core::RUNNING;
+   setThreadStatus(thread_id, Core::RUNNING);
 
    HooksManager::ThreadResume args = { thread_id: thread_id, thread_by: thread_by, time: time };
    Sim()->getHooksManager()->callHooks(HookType::HOOK_THREAD_RESUME, (UInt64)&args);
@@ -395,10 +408,16 @@ bool ThreadManager::isThreadInitializing(thread_id_t thread_id)
 
 bool ThreadManager::anyThreadRunning()
 {
-   for(thread_id_t thread_id = 0; thread_id < (thread_id_t)getNumThreads(); ++thread_id)
-   {
-      if (isThreadRunning(thread_id) || isThreadInitializing(thread_id))
-         return true;
-   }
-   return false;
+   return m_num_active > 0;
+}
+
+void ThreadManager::setThreadStatus(thread_id_t thread_id, Core::State status)
+{
+   Core::State previous = m_thread_state[thread_id].status.exchange(status);
+   bool was_active = previous == Core::RUNNING || previous == Core::INITIALIZING;
+   bool is_active = status == Core::RUNNING || status == Core::INITIALIZING;
+   if (is_active && !was_active)
+      ++m_num_active;
+   else if (was_active && !is_active)
+      --m_num_active;
 }
\ No newline at end of file
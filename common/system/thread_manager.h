@@ -4,11 +4,12 @@
 #include "fixed_types.h"
 #include "semaphore.h"
 #include "core.h"
-#include "lock.h"
+#include "profiled_lock.h"
 #include "subsecond_time.h"
 
 #include <vector>
 #include <queue>
+#include <atomic>
 
 class TLS;
 class Thread;
@@ -45,6 +46,7 @@ public:
    Thread *getThreadFromID(thread_id_t thread_id);
    Thread *getCurrentThread(int threadIndex = -1);
    UInt64 getNumThreads() const { return m_threads.size(); }
+   // Thread state queries do not need the thread lock (m_thread_state is never reallocated)
    Core::State getThreadState(thread_id_t thread_id) const { return m_thread_state.at(thread_id).status; }
    stall_type_t getThreadStallReason(thread_id_t thread_id) const { return m_thread_state.at(thread_id).stalled_reason; }
 
@@ -64,6 +66,8 @@ public:
    // misc
    SubsecondTime stallThread(thread_id_t thread_id, stall_type_t reason, SubsecondTime time);
    void stallThread_async(thread_id_t thread_id, stall_type_t reason, SubsecondTime time);
+   // stallThread_async without holding the thread lock, and without waiting for it when it is busy
+   void postStallThread(thread_id_t thread_id, stall_type_t reason, SubsecondTime time);
    void resumeThread(thread_id_t thread_id, thread_id_t thread_id_by, SubsecondTime time, void *msg = NULL);
    void resumeThread_async(thread_id_t thread_id, thread_id_t thread_id_by, SubsecondTime time, void *msg = NULL);
    bool isThreadRunning(thread_id_t thread_id);
@@ -84,16 +88,20 @@ private:
 
    struct ThreadState
    {
-      Core::State status;
-      stall_type_t stalled_reason; //< If status == Core::STALLED, why?
+      // Changed while holding m_thread_lock, read without it
+      std::atomic<Core::State> status;
+      std::atomic<stall_type_t> stalled_reason; //< If status == Core::STALLED, why?
       thread_id_t waiter;
 
-      ThreadState() : status(Core::IDLE), waiter(INVALID_THREAD_ID) {}
+      ThreadState() : status(Core::IDLE), stalled_reason(STALL_UNSCHEDULED), waiter(INVALID_THREAD_ID) {}
    };
 
-   Lock m_thread_lock;
+   ProfiledLock m_thread_lock;
 
+   // Sized for the maximum number of threads up front and never resized, such that unlocked readers
+   // do not race with createThread relocating the states
    std::vector<ThreadState> m_thread_state;
+   std::atomic<UInt32> m_num_active;    //< Number of threads that are RUNNING or INITIALIZING, kept up to date by setThreadStatus
    std::queue<ThreadSpawnRequest> m_thread_spawn_list;
 
    std::vector<Thread*> m_threads;
@@ -101,6 +109,7 @@ private:
 
    Scheduler *m_scheduler;
 
+   void setThreadStatus(thread_id_t thread_id, Core::State status);
    Thread* createThread_unlocked(app_id_t app_id, thread_id_t creator_thread_id,String app_name="X");
    void wakeUpWaiter(thread_id_t thread_id, SubsecondTime time);
 };
@@ -11,6 +11,9 @@ class StatsMetricBase;
 class ThreadStatsManager
 {
    public:
+      // Upper bound on the number of application threads (ThreadManager sizes its thread states by it as well)
+      static const int MAX_THREADS = 4096;
+
       typedef UInt32 ThreadStatType;
       typedef std::vector<ThreadStatType> ThreadStatTypeList;
       enum ThreadStatTypeEnum
@@ -70,7 +73,6 @@ private:
       };
       // Make sure m_threads_stats is statically allocated, as we may do inserts and reads simultaneously
       // which does not work on an unordered_map
-      static const int MAX_THREADS = 4096;
       std::vector<ThreadStats*> m_threads_stats;
       ThreadStatTypeList m_thread_stat_types;
       std::unordered_map<ThreadStatType, StatCallback> m_thread_stat_callbacks;
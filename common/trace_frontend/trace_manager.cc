@@ -1,5 +1,7 @@
 #include "trace_manager.h"
 #include "trace_thread.h"
+#include "trace_pool.h"
+#include "translation_cache.h"
 #include "simulator.h"
 #include "thread_manager.h"
 #include "hooks_manager.h"
@@ -29,8 +31,37 @@ TraceManager::TraceManager()
    , m_app_info(m_num_apps)
    , m_tracefiles(m_num_apps)
    , m_responsefiles(m_num_apps)
+   , m_trace_pool(NULL)
+   , m_translation_cache_size(Sim()->getCfg()->getInt("traceinput/shared_decoder_cache_size"))
 {
-   setupTraceFiles(0);
+   if (Sim()->getCfg()->getBool("traceinput/pool/enabled"))
+   {
+      if (m_emulate_syscalls)
+      {
+         std::cerr << "Error: pooled traces cannot emulate syscalls." << std::endl;
+         exit(1);
+      }
+      m_trace_pool = new TracePool(Sim()->getCfg()->getString("traceinput/pool/directory"));
+
+      // Application i replays the i-th benchmark of the workload
+      String benchmarks = Sim()->getCfg()->getString("traceinput/benchmarks");
+      for (UInt32 i = 0 ; i < m_num_apps ; i++ )
+      {
+         size_t end = benchmarks.find("+");
+         m_app_benchmarks.push_back(benchmarks.substr(0, end));
+         benchmarks = end == String::npos ? "" : benchmarks.substr(end + 1);
+         if (m_app_benchmarks[i] == "")
+         {
+            std::cerr << "Error: no pooled benchmark given for application " << i << "." << std::endl;
+            exit(1);
+         }
+         m_trace_pool->preload(m_app_benchmarks[i]);
+      }
+   }
+   else
+   {
+      setupTraceFiles(0);
+   }
 }
 
 void TraceManager::setupTraceFiles(int index)
@@ -115,17 +146,41 @@ thread_id_t TraceManager::newThread(app_id_t app_id, bool first, bool init_fifo,
       thread_num = m_app_info[app_id].thread_count++;
    }
 
-   if (init_fifo)
+   const TracePool::Trace *pooled_trace = NULL;
+   UInt64 address_space = 0;
+   if (m_trace_pool)
+   {
+      // Pooled traces were checked to hold a single thread when they were preloaded (see TracePool::validate)
+      LOG_ASSERT_ERROR(first && !init_fifo, "Application %d (%s) replays a pooled trace, which cannot create new threads or applications",
+                       app_id, app_id < (app_id_t)m_app_benchmarks.size() ? m_app_benchmarks[app_id].c_str() : "?");
+      pooled_trace = m_trace_pool->acquire(m_app_benchmarks[app_id]);
+      address_space = m_trace_pool->getAddressSpace();
+      tracefile = pooled_trace->filename;
+      responsefile = "";
+   }
+   else if (init_fifo)
    {
       tracefile = getFifoName(app_id, thread_num, false /*response*/, true /*create*/);
       if (m_responsefiles.size())
          responsefile = getFifoName(app_id, thread_num, true /*response*/, true /*create*/);
    }
 
+   // Threads of an application translate code addresses the same way, so they can share decoded instructions.
+   // Not so for pooled instances (each has its own address space) or the sequential scheduler (app_id follows the core).
+   TranslationCache *translation_cache = NULL;
+   if (m_translation_cache_size && !m_trace_pool && Sim()->getCfg()->getString("scheduler/type") != "sequential")
+   {
+      if (m_translation_caches.size() <= (size_t)app_id)
+         m_translation_caches.resize(app_id + 1, NULL);
+      if (m_translation_caches[app_id] == NULL)
+         m_translation_caches[app_id] = new TranslationCache(m_translation_cache_size);
+      translation_cache = m_translation_caches[app_id];
+   }
+
    m_num_threads_running++;
    Thread *thread = Sim()->getThreadManager()->createThread(app_id, creator_thread_id, app_name);
 	
-   TraceThread *tthread = new TraceThread(thread, time, tracefile, responsefile, app_id, init_fifo /*cleaup*/);
+   TraceThread *tthread = new TraceThread(thread, time, tracefile, responsefile, app_id, init_fifo /*cleaup*/, pooled_trace, address_space, translation_cache);
    m_threads.push_back(tthread);
 
    if (spawn)
@@ -240,6 +295,10 @@ void TraceManager::cleanup()
 TraceManager::~TraceManager()
 {
    cleanup();
+   if (m_trace_pool)
+      delete m_trace_pool;
+   for(std::vector<TranslationCache *>::iterator it = m_translation_caches.begin(); it != m_translation_caches.end(); ++it)
+      delete *it;
 }
 
 void TraceManager::start()
@@ -271,6 +330,10 @@ void TraceManager::stop()
 
 void TraceManager::mark_done()
 {
+   // Pooled traces are replayed without a recorder, nobody to notify
+   if (m_trace_pool)
+      return;
+
    FILE *fp = fopen((m_trace_prefix + ".sift_done").c_str(), "w");
    fclose(fp);
 }
@@ -9,6 +9,8 @@
 #include <vector>
 
 class TraceThread;
+class TracePool;
+class TranslationCache;
 
 class TraceManager
 {
@@ -51,6 +53,10 @@ class TraceManager
       std::vector<String> m_tracefiles;
       std::vector<String> m_responsefiles;
       String m_trace_prefix;
+      TracePool *m_trace_pool;              //< Pre-recorded traces shared by all instances of a benchmark (NULL if disabled)
+      std::vector<String> m_app_benchmarks; //< Benchmark replayed from the pool by each application
+      const UInt64 m_translation_cache_size;
+      std::vector<TranslationCache *> m_translation_caches; //< Decoded instructions shared by all threads (and runs) of each application
       Lock m_lock;
 
       String getFifoName(app_id_t app_id, UInt64 thread_num, bool response, bool create);
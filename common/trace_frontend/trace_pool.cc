@@ -0,0 +1,127 @@
+#include "trace_pool.h"
+#include "sift_reader.h"
+#include "stats.h"
+#include "log.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+TracePool::TracePool(String directory)
+   : m_directory(directory)
+   , m_num_instances(0)
+{
+}
+
+TracePool::~TracePool()
+{
+   for(std::map<String, Trace*>::iterator it = m_traces.begin(); it != m_traces.end(); ++it)
+   {
+      munmap(const_cast<uint8_t*>(it->second->data), it->second->size);
+      delete it->second;
+   }
+}
+
+namespace
+{
+   // Handlers for the validation pass: note the record and stop reading, the trace is unusable
+   struct ScanState
+   {
+      Sift::Reader *reader;
+      const char *record;
+   };
+
+   int32_t scanNewThread(void *arg)
+   {
+      ScanState *state = static_cast<ScanState*>(arg);
+      state->record = "creates a new thread";
+      state->reader->Abort();
+      return -1;
+   }
+
+   int32_t scanFork(void *arg)
+   {
+      ScanState *state = static_cast<ScanState*>(arg);
+      state->record = "forks a new process";
+      state->reader->Abort();
+      return -1;
+   }
+}
+
+void TracePool::validate(const Trace *trace)
+{
+   // Pooled traces are replayed without a response file, so there is no recorder to answer thread or process
+   // creation. Read through the trace once, rather than failing when an instance reaches such a record mid-simulation.
+   Sift::Reader reader(trace->filename.c_str(), "", 0, trace->data, trace->size);
+   ScanState state = { &reader, NULL };
+   reader.setHandleNewThreadFunc(scanNewThread, &state);
+   reader.setHandleForkFunc(scanFork, &state);
+
+   Sift::Instruction inst;
+   while (reader.Read(inst))
+      ;
+
+   LOG_ASSERT_ERROR(state.record == NULL,
+                    "Pooled trace %s %s, only single-threaded benchmarks can be pooled (disable traceinput/pool/enabled to run %s from a live recorder)",
+                    trace->filename.c_str(), state.record, trace->benchmark.c_str());
+}
+
+TracePool::Trace* TracePool::load(String benchmark)
+{
+   String filename = m_directory + "/" + benchmark + ".sift";
+
+   int fd = open(filename.c_str(), O_RDONLY);
+   LOG_ASSERT_ERROR(fd >= 0, "Cannot open pooled trace %s for benchmark %s", filename.c_str(), benchmark.c_str());
+
+   struct stat filestatus;
+   fstat(fd, &filestatus);
+   LOG_ASSERT_ERROR(filestatus.st_size > 0, "Pooled trace %s is empty", filename.c_str());
+
+   // All instances read from the same pages: no per-instance copy, and the page cache is shared
+   void *data = mmap(NULL, filestatus.st_size, PROT_READ, MAP_SHARED, fd, 0);
+   LOG_ASSERT_ERROR(data != MAP_FAILED, "Cannot map pooled trace %s", filename.c_str());
+   close(fd);
+   madvise(data, filestatus.st_size, MADV_SEQUENTIAL);
+
+   Trace *trace = new Trace();
+   trace->benchmark = benchmark;
+   trace->filename = filename;
+   trace->data = static_cast<const uint8_t*>(data);
+   trace->size = filestatus.st_size;
+   trace->instances = 0;
+
+   validate(trace);
+
+   registerStatsMetric("tracepool", m_traces.size(), "instances", &trace->instances);
+   m_traces[benchmark] = trace;
+
+   return trace;
+}
+
+void TracePool::preload(String benchmark)
+{
+   ScopedLock sl(m_lock);
+
+   if (m_traces.count(benchmark) == 0)
+      load(benchmark);
+}
+
+const TracePool::Trace* TracePool::acquire(String benchmark)
+{
+   ScopedLock sl(m_lock);
+
+   std::map<String, Trace*>::iterator it = m_traces.find(benchmark);
+   Trace *trace = it == m_traces.end() ? load(benchmark) : it->second;
+   ++trace->instances;
+
+   return trace;
+}
+
+UInt64 TracePool::getAddressSpace()
+{
+   ScopedLock sl(m_lock);
+
+   // Address space ids occupy the upper 16 bits of the physical address, wrap around when exhausted
+   return address_space_base + (m_num_instances++ % address_space_base);
+}
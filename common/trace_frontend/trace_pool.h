@@ -0,0 +1,51 @@
+#ifndef __TRACE_POOL_H
+#define __TRACE_POOL_H
+
+#include "fixed_types.h"
+#include "lock.h"
+
+#include <map>
+#include <vector>
+
+// Pool of pre-recorded SIFT traces, one per distinct benchmark.
+// Each trace file is mapped read-only once and shared by all task instances replaying it,
+// so repeated instances of a benchmark need neither a new recorder process nor new FIFOs.
+// Instances are given their own address space by TraceThread::va2pa (see getAddressSpace()).
+
+class TracePool
+{
+   public:
+      struct Trace
+      {
+         String benchmark;
+         String filename;
+         const uint8_t *data;
+         UInt64 size;
+         UInt64 instances;          //< Number of task instances that replayed this trace
+      };
+
+      // Address space ids handed out to pooled instances start at this value, to keep them
+      // apart from the app_id-based address spaces of threads that are not pooled
+      static const UInt64 address_space_base = 1 << 15;
+
+      TracePool(String directory);
+      ~TracePool();
+
+      // Map and check the trace for this benchmark ahead of its first instance, such that unusable traces are reported at startup
+      void preload(String benchmark);
+      // Map the trace for this benchmark (first use) and account a new instance
+      const Trace* acquire(String benchmark);
+      // Address space id for the next instance, used instead of the app_id in the upper physical address bits
+      UInt64 getAddressSpace();
+
+   private:
+      Lock m_lock;
+      const String m_directory;
+      std::map<String, Trace*> m_traces;
+      UInt64 m_num_instances;
+
+      Trace* load(String benchmark);
+      void validate(const Trace *trace);
+};
+
+#endif // __TRACE_POOL_H
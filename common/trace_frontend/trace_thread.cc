@@ -34,19 +34,30 @@
 //bool TraceThread::xed_initialized = false;
 int TraceThread::m_isa = 0;
 
-TraceThread::TraceThread(Thread *thread, SubsecondTime time_start, String tracefile, String responsefile, app_id_t app_id, bool cleanup)
+TraceThread::TraceThread(Thread *thread, SubsecondTime time_start, String tracefile, String responsefile, app_id_t app_id, bool cleanup, const TracePool::Trace *pooled_trace, UInt64 address_space, TranslationCache *translation_cache)
    : m__thread(NULL)
    , m_thread(thread)
    , m_time_start(time_start)
-   , m_trace(tracefile.c_str(), responsefile.c_str(), thread->getId())
+   , m_trace(tracefile.c_str(), responsefile.c_str(), thread->getId(), pooled_trace ? pooled_trace->data : NULL, pooled_trace ? pooled_trace->size : 0)
    , m_trace_has_pa(false)
    , m_address_randomization(Sim()->getCfg()->getBool("traceinput/address_randomization"))
    , m_appid_from_coreid(Sim()->getCfg()->getString("scheduler/type") == "sequential" ? true : false)
+   , m_pooled_trace(pooled_trace)
+   , m_address_space(address_space)
    , m_stop(false)
+   , m_translation_cache(translation_cache ? translation_cache : new TranslationCache(0))
+   , m_translation_cache_private(translation_cache == NULL)
    , m_bbv_base(0)
    , m_bbv_count(0)
    , m_bbv_last(0)
    , m_bbv_end(false)
+   , m_block_queued(0)
+   , m_prefetch_size(Sim()->getCfg()->getInt("traceinput/prefetch_depth"))
+   , m_prefetcher(NULL)
+   , m_prefetch_queue(NULL)
+   , m_prefetch_callback(NULL)
+   , m_prefetch_stopping(false)
+   , m_prefetch_exited(false)
    , m_output_leftover_size(0)
    , m_tracefile(tracefile)
    , m_responsefile(responsefile)
@@ -84,7 +95,8 @@ TraceThread::TraceThread(Thread *thread, SubsecondTime time_start, String tracef
       // Fisher-Yates shuffle, simultaneously initializing array to m_address_randomization_table[i] = i
       // See http://en.wikipedia.org/wiki/Fisher%E2%80%93Yates_shuffle#The_.22inside-out.22_algorithm
       // By using the app_id as a random seed, we get an app_id-specific pseudo-random permutation of 0..255
-      UInt64 state = rng_seed(app_id);
+      // (pooled instances of the same benchmark use their address space id to get different permutations)
+      UInt64 state = rng_seed(m_pooled_trace ? m_address_space : app_id);
       m_address_randomization_table[0] = 0;
       for(unsigned int i = 1; i < 256; ++i)
       {
@@ -101,15 +113,15 @@ TraceThread::TraceThread(Thread *thread, SubsecondTime time_start, String tracef
 TraceThread::~TraceThread()
 {
    delete m__thread;
+   delete m_prefetcher;
+   delete m_prefetch_queue;
    if (m_cleanup)
    {
       unlink(m_tracefile.c_str());
       unlink(m_responsefile.c_str());
    }
-   for(std::unordered_map<IntPtr, const dl::DecodedInst *>::iterator i = m_decoder_cache.begin() ; i != m_decoder_cache.end() ; ++i)
-   {
-      delete (*i).second;
-   }
+   if (m_translation_cache_private)
+      delete m_translation_cache;
 }
 
 UInt64 TraceThread::va2pa(UInt64 va, bool *noMapping)
@@ -140,6 +152,11 @@ UInt64 TraceThread::va2pa(UInt64 va, bool *noMapping)
    {
         haddr = UInt64(m_thread->getCore()->getId());
    }
+   else if (m_pooled_trace)
+   {
+        // Instances replaying the same pooled trace share virtual addresses, relocate each one to a private range
+        haddr = m_address_space;
+   }
    else
    {
         haddr = UInt64(m_thread->getAppId());
@@ -213,6 +230,8 @@ void TraceThread::handleOutputFunc(uint8_t fd, const uint8_t *data, uint32_t siz
 
 uint64_t TraceThread::handleSyscallFunc(uint16_t syscall_number, const uint8_t *data, uint32_t size)
 {
+   flushBlock();
+
    // We may have been blocked in a system call, if we start executing instructions again that means we're continuing
    if (m_blocked)
    {
@@ -248,27 +267,33 @@ uint64_t TraceThread::handleSyscallFunc(uint16_t syscall_number, const uint8_t *
 
 int32_t TraceThread::handleNewThreadFunc()
 {
+   flushBlock();
    return Sim()->getTraceManager()->createThread(m_app_id, getCurrentTime(), m_thread->getId());
 }
 
 int32_t TraceThread::handleForkFunc()
 {
+   flushBlock();
    return Sim()->getTraceManager()->createApplication(getCurrentTime(), m_thread->getId());
 }
 
 int32_t TraceThread::handleJoinFunc(int32_t join_thread_id)
 {
+   flushBlock();
    Sim()->getThreadManager()->joinThread(m_thread->getId(), join_thread_id);
    return 0;
 }
 
 uint64_t TraceThread::handleMagicFunc(uint64_t a, uint64_t b, uint64_t c)
 {
+   flushBlock();
    return handleMagicInstruction(m_thread->getId(), a, b, c);
 }
 
 void TraceThread::handleRoutineChangeFunc(Sift::RoutineOpType event, uint64_t eip, uint64_t esp, uint64_t callEip)
 {
+   flushBlock();
+
    switch(event)
    {
       case Sift::RoutineEnter:
@@ -287,6 +312,8 @@ void TraceThread::handleRoutineChangeFunc(Sift::RoutineOpType event, uint64_t ei
 
 bool TraceThread::handleEmuFunc(Sift::EmuType type, Sift::EmuRequest &req, Sift::EmuReply &res)
 {
+   flushBlock();
+
    // We may have been blocked in a system call, if we start executing instructions again that means we're continuing
    if (m_blocked)
    {
@@ -391,28 +418,60 @@ SubsecondTime TraceThread::getCurrentTime() const
    return m_thread->getCore()->getPerformanceModel()->getElapsedTime();
 }
 
-Instruction* TraceThread::decode(Sift::Instruction &inst)
+TraceThread::Translation& TraceThread::getTranslation(Sift::Instruction &inst)
+{
+   // The reader returns the same StaticInstruction for every execution of a PC, and finds it without hashing
+   // for the common case of the next instruction being a successor seen before
+   if (inst.sinst->user_data == NULL)
+   {
+      // Other threads of this application may have decoded this instruction already
+      Translation *translation = m_translation_cache->find(inst.sinst->addr);
+      if (translation == NULL)
+      {
+         const dl::DecodedInst *dec_inst = staticDecode(inst);
+         translation = new Translation(dec_inst);
+
+         // Memory operand template, such that executions only have to fill in the addresses
+         // Ignore memory-referencing operands in NOP instructions
+         if (!dec_inst->is_nop())
+         {
+            dl::Decoder *decoder = Sim()->getDecoder();
+            for(uint32_t mem_idx = 0; mem_idx < decoder->num_memory_operands(dec_inst); ++mem_idx)
+            {
+               if (decoder->op_read_mem(dec_inst, mem_idx))
+               {
+                  MemoryOperand operand = { mem_idx, Operand::READ, decoder->size_mem_op(dec_inst, mem_idx) };
+                  translation->memory_operands.push_back(operand);
+               }
+            }
+
+            for(uint32_t mem_idx = 0; mem_idx < decoder->num_memory_operands(dec_inst); ++mem_idx)
+            {
+               if (decoder->op_write_mem(dec_inst, mem_idx))
+               {
+                  MemoryOperand operand = { mem_idx, Operand::WRITE, decoder->size_mem_op(dec_inst, mem_idx) };
+                  translation->memory_operands.push_back(operand);
+               }
+            }
+         }
+
+         translation = m_translation_cache->publish(inst.sinst->addr, translation);
+      }
+      inst.sinst->user_data = translation;
+   }
+   return *static_cast<Translation*>(inst.sinst->user_data);
+}
+
+Instruction* TraceThread::decode(Sift::Instruction &inst, const Translation &translation)
 {
+   const dl::DecodedInst &dec_inst = *translation.decoded;
 
    //printf("PC: %lx Size: %d num_addresses=%d is_branch=%d\n", inst.sinst->addr, inst.sinst->size, inst.num_addresses, inst.is_branch);
-   if (m_decoder_cache.count(inst.sinst->addr) == 0)
-      m_decoder_cache[inst.sinst->addr] = staticDecode(inst);
-   
-   const dl::DecodedInst& dec_inst = *(m_decoder_cache[inst.sinst->addr]);
 
    OperandList list;
 
-   // Ignore memory-referencing operands in NOP instructions
-   if (!(dec_inst.is_nop()))
-   {
-      for(uint32_t mem_idx = 0; mem_idx < Sim()->getDecoder()->num_memory_operands(&dec_inst); ++mem_idx)
-         if (Sim()->getDecoder()->op_read_mem(&dec_inst, mem_idx))
-            list.push_back(Operand(Operand::MEMORY, 0, Operand::READ));
-
-      for(uint32_t mem_idx = 0; mem_idx < Sim()->getDecoder()->num_memory_operands(&dec_inst); ++mem_idx)
-         if (Sim()->getDecoder()->op_write_mem(&dec_inst, mem_idx))
-            list.push_back(Operand(Operand::MEMORY, 0, Operand::WRITE));
-   }
+   for(std::vector<MemoryOperand>::const_iterator it = translation.memory_operands.begin(); it != translation.memory_operands.end(); ++it)
+      list.push_back(Operand(Operand::MEMORY, 0, it->direction));
 
    Instruction *instruction;
    if (inst.is_branch)
@@ -437,6 +496,8 @@ Instruction* TraceThread::decode(Sift::Instruction &inst)
 
 Sift::Mode TraceThread::handleInstructionCountFunc(uint32_t icount)
 {
+   flushBlock();
+
    if (!m_started)
    {
       // Received first instruction, let TraceManager know our SIFT connection is up and running
@@ -538,10 +599,7 @@ const dl::DecodedInst* TraceThread::staticDecode(Sift::Instruction &inst)
 
 void TraceThread::handleInstructionWarmup(Sift::Instruction &inst, Sift::Instruction &next_inst, Core *core, bool do_icache_warmup, UInt64 icache_warmup_addr, UInt64 icache_warmup_size)
 {
-   if (m_decoder_cache.count(inst.sinst->addr) == 0)
-      m_decoder_cache[inst.sinst->addr] = staticDecode(inst);
-   
-   const dl::DecodedInst &dec_inst = *(m_decoder_cache[inst.sinst->addr]);
+   const Translation &translation = getTranslation(inst);
 
    // Warmup instruction caches
 
@@ -563,84 +621,48 @@ void TraceThread::handleInstructionWarmup(Sift::Instruction &inst, Sift::Instruc
 
    if (inst.executed)
    {
-      const bool is_atomic_update = dec_inst.is_atomic();
-      const bool is_prefetch = dec_inst.is_prefetch();
-
-      // Ignore memory-referencing operands in NOP instructions
-      if (!dec_inst.is_nop())
+      for(std::vector<MemoryOperand>::const_iterator it = translation.memory_operands.begin(); it != translation.memory_operands.end(); ++it)
       {
-         for(uint32_t mem_idx = 0; mem_idx <  Sim()->getDecoder()->num_memory_operands(&dec_inst); ++mem_idx)
+         UInt64 mem_address;
+         // LDP/STP ARM instructions, second element to be loaded/stored, using the address of the first element
+         if (translation.is_mem_pair && ((int)it->index == (inst.num_addresses + 1)))
          {
-            if (Sim()->getDecoder()->op_read_mem(&dec_inst, mem_idx))
-            {
-               UInt64 mem_address;
-               // LDP ARM instructions, second element to be loaded, using the address of the first element
-               if (dec_inst.is_mem_pair() && ((int)mem_idx == (inst.num_addresses + 1)))  
-               {
-                  LOG_ASSERT_ERROR((int)mem_idx < (inst.num_addresses + 1), "Did not receive enough data addresses");
-                  
-                  mem_address = inst.addresses[mem_idx - 1] + Sim()->getDecoder()->size_mem_op(&dec_inst, mem_idx);
-               }
-               else
-               {
-                  LOG_ASSERT_ERROR(mem_idx < inst.num_addresses, "Did not receive enough data addresses");
-                 
-                  mem_address = inst.addresses[mem_idx];
-               }
-               
-               bool no_mapping = false;
-               UInt64 pa = va2pa(mem_address, is_prefetch ? &no_mapping : NULL);
-               if (no_mapping)
-                  continue;
-
-               core->accessMemory(
-                     /*(is_atomic_update) ? Core::LOCK :*/ Core::NONE,
-                     (is_atomic_update) ? Core::READ_EX : Core::READ,
-                     pa,
-                     NULL,
-                     Sim()->getDecoder()->size_mem_op(&dec_inst, mem_idx),
-                     Core::MEM_MODELED_COUNT,
-                     va2pa(inst.sinst->addr));
-            }
-         }
+            LOG_ASSERT_ERROR((int)it->index < (inst.num_addresses + 1), "Did not receive enough data addresses");
 
-         for(uint32_t mem_idx = 0; mem_idx < Sim()->getDecoder()->num_memory_operands(&dec_inst); ++mem_idx)
+            mem_address = inst.addresses[it->index - 1] + it->size;
+         }
+         else
          {
-            if (Sim()->getDecoder()->op_write_mem(&dec_inst, mem_idx))
-            {
-               UInt64 mem_address;
-               // STP ARM instructions, second element to be stored, using the address of the first element
-               if (dec_inst.is_mem_pair() && ((int)mem_idx == (inst.num_addresses + 1)))  
-               {
-                  LOG_ASSERT_ERROR((int)mem_idx < (inst.num_addresses + 1), "Did not receive enough data addresses");
-                  
-                  mem_address = inst.addresses[mem_idx - 1] + Sim()->getDecoder()->size_mem_op(&dec_inst, mem_idx);
-               }
-               else
-               {
-                  LOG_ASSERT_ERROR(mem_idx < inst.num_addresses, "Did not receive enough data addresses");
-                 
-                  mem_address = inst.addresses[mem_idx];
-               }
-               
-               bool no_mapping = false;
-               UInt64 pa = va2pa(mem_address, is_prefetch ? &no_mapping : NULL);
-               if (no_mapping)
-                  continue;
-
-               if (is_atomic_update)
-                  core->logMemoryHit(false, Core::WRITE, pa, Core::MEM_MODELED_COUNT, va2pa(inst.sinst->addr));
-               else
-                  core->accessMemory(
-                        /*(is_atomic_update) ? Core::UNLOCK :*/ Core::NONE,
-                        Core::WRITE,
-                        pa,
-                        NULL,
-                        Sim()->getDecoder()->size_mem_op(&dec_inst, mem_idx),
-                        Core::MEM_MODELED_COUNT,
-                        va2pa(inst.sinst->addr));
-            }
+            LOG_ASSERT_ERROR(it->index < inst.num_addresses, "Did not receive enough data addresses");
+
+            mem_address = inst.addresses[it->index];
          }
+
+         bool no_mapping = false;
+         UInt64 pa = va2pa(mem_address, translation.is_prefetch ? &no_mapping : NULL);
+         if (no_mapping)
+            continue;
+
+         if (it->direction == Operand::READ)
+            core->accessMemory(
+                  /*(is_atomic_update) ? Core::LOCK :*/ Core::NONE,
+                  (translation.is_atomic) ? Core::READ_EX : Core::READ,
+                  pa,
+                  NULL,
+                  it->size,
+                  Core::MEM_MODELED_COUNT,
+                  va2pa(inst.sinst->addr));
+         else if (translation.is_atomic)
+            core->logMemoryHit(false, Core::WRITE, pa, Core::MEM_MODELED_COUNT, va2pa(inst.sinst->addr));
+         else
+            core->accessMemory(
+                  /*(is_atomic_update) ? Core::UNLOCK :*/ Core::NONE,
+                  Core::WRITE,
+                  pa,
+                  NULL,
+                  it->size,
+                  Core::MEM_MODELED_COUNT,
+                  va2pa(inst.sinst->addr));
       }
    }
 }
@@ -650,13 +672,12 @@ void TraceThread::handleInstructionDetailed(Sift::Instruction &inst, Sift::Instr
 
    // Set up instruction
 
-   if (m_icache.count(inst.sinst->addr) == 0)
-      m_icache[inst.sinst->addr] = decode(inst);
-   // Here get the decoder instruction without checking, because we must have it for sure
-   const dl::DecodedInst &dec_inst = *(m_decoder_cache[inst.sinst->addr]);
+   Translation &translation = getTranslation(inst);
+   Instruction *instruction = translation.instruction.load(std::memory_order_acquire);
+   if (instruction == NULL)
+      instruction = m_translation_cache->publish(&translation, decode(inst, translation));
 
-   Instruction *ins = m_icache[inst.sinst->addr];
-   DynamicInstruction *dynins = prfmdl->createDynamicInstruction(ins, va2pa(inst.sinst->addr));
+   DynamicInstruction *dynins = prfmdl->createDynamicInstruction(instruction, va2pa(inst.sinst->addr));
 
    // Add dynamic instruction info
 
@@ -665,54 +686,52 @@ void TraceThread::handleInstructionDetailed(Sift::Instruction &inst, Sift::Instr
       dynins->addBranch(inst.taken, va2pa(next_inst.sinst->addr));
    }
 
-   // Ignore memory-referencing operands in NOP instructions
-   if (!dec_inst.is_nop())
+   for(std::vector<MemoryOperand>::const_iterator it = translation.memory_operands.begin(); it != translation.memory_operands.end(); ++it)
    {
-      const bool is_prefetch = dec_inst.is_prefetch();
-
-      for(uint32_t mem_idx = 0; mem_idx < Sim()->getDecoder()->num_memory_operands(&dec_inst); ++mem_idx)
-      {
-         if (Sim()->getDecoder()->op_read_mem(&dec_inst, mem_idx))
-         {
-            addDetailedMemoryInfo(dynins, inst, dec_inst, mem_idx, Operand::READ, is_prefetch, prfmdl);
-         }
-      }
-
-      for(uint32_t mem_idx = 0; mem_idx < Sim()->getDecoder()->num_memory_operands(&dec_inst); ++mem_idx)
-      {
-         if (Sim()->getDecoder()->op_write_mem(&dec_inst, mem_idx))
-         {
-            addDetailedMemoryInfo(dynins, inst, dec_inst, mem_idx, Operand::WRITE, is_prefetch, prfmdl);
-         }
-      }
+      addDetailedMemoryInfo(dynins, inst, translation, *it);
    }
 
    // Push instruction
 
    prfmdl->queueInstruction(dynins);
+   ++m_block_queued;
+
+   // simulate, once per basic block
 
-   // simulate
+   if (inst.is_branch || next_inst.sinst->addr != inst.sinst->addr + inst.sinst->size || m_block_queued >= max_block_queued)
+   {
+      flushBlock();
+   }
+}
 
-   prfmdl->iterate();
+void TraceThread::flushBlock()
+{
+   // Simulate the instructions queued for the current basic block. Called at the end of each block,
+   // and before anything that depends on the thread's time or core (system calls, magic instructions, rescheduling, ...)
+   if (m_block_queued)
+   {
+      m_thread->getCore()->getPerformanceModel()->iterate();
+      m_block_queued = 0;
+   }
 }
 
-void TraceThread::addDetailedMemoryInfo(DynamicInstruction *dynins, Sift::Instruction &inst, const dl::DecodedInst &decoded_inst, uint32_t mem_idx, Operand::Direction op_type, bool is_prefetch, PerformanceModel *prfmdl)
+void TraceThread::addDetailedMemoryInfo(DynamicInstruction *dynins, Sift::Instruction &inst, const Translation &translation, const MemoryOperand &operand)
 {
    UInt64 mem_address;
    // LDP/STP ARM instructions, second element to be ld/st, using the address of the first element
-   if (decoded_inst.is_mem_pair() && ((int)mem_idx == inst.num_addresses))  
+   if (translation.is_mem_pair && ((int)operand.index == inst.num_addresses))
    {
-      assert((int)mem_idx < (inst.num_addresses + 1));
-      mem_address = inst.addresses[mem_idx - 1] + Sim()->getDecoder()->size_mem_op(&decoded_inst, mem_idx);
+      assert((int)operand.index < (inst.num_addresses + 1));
+      mem_address = inst.addresses[operand.index - 1] + operand.size;
    }
    else
    {
-      assert(mem_idx < inst.num_addresses);
-      mem_address = inst.addresses[mem_idx];
+      assert(operand.index < inst.num_addresses);
+      mem_address = inst.addresses[operand.index];
    }
                
    bool no_mapping = false;
-   UInt64 pa = va2pa(mem_address, is_prefetch ? &no_mapping : NULL);
+   UInt64 pa = va2pa(mem_address, translation.is_prefetch ? &no_mapping : NULL);
 
    if (no_mapping)
    {
@@ -720,8 +739,8 @@ void TraceThread::addDetailedMemoryInfo(DynamicInstruction *dynins, Sift::Instru
          inst.executed,
          SubsecondTime::Zero(),
          0,
-         Sim()->getDecoder()->size_mem_op(&decoded_inst, mem_idx),
-         op_type,
+         operand.size,
+         operand.direction,
          0,
          HitWhere::PREFETCH_NO_MAPPING);
    }
@@ -731,8 +750,8 @@ void TraceThread::addDetailedMemoryInfo(DynamicInstruction *dynins, Sift::Instru
          inst.executed,
          SubsecondTime::Zero(),
          pa,
-         Sim()->getDecoder()->size_mem_op(&decoded_inst, mem_idx),
-         op_type,
+         operand.size,
+         operand.direction,
          0,
          HitWhere::UNKNOWN);
    }
@@ -778,6 +797,19 @@ void TraceThread::run()
    m_trace.initStream();
    m_trace_has_pa = m_trace.getTraceHasPhysicalAddresses();
 
+   // Sampled simulation: start at a checkpoint of the trace index instead of replaying the whole prefix
+   UInt64 seek_icount = Sim()->getCfg()->getIntArray("traceinput/seek_icount", m_thread->getId());
+   if (seek_icount)
+   {
+      bool seeked = m_trace.Seek(seek_icount);
+      LOG_ASSERT_ERROR(seeked, "Cannot seek trace %s to instruction %" PRIu64 ", is there a trace index (see sift/siftindex)?", m_tracefile.c_str(), seek_icount);
+      printf("[TRACE:%u] -- SEEK to instruction %" PRIu64 " --\n", m_thread->getId(), m_trace.getInstructionCount());
+   }
+
+   // The reader updates its va2pa table while decoding, which we can only consult from the thread that reads
+   if (m_prefetch_size && !m_trace_has_pa)
+      startPrefetch();
+
    if (m_thread->getCore() == NULL)
    {
       // We didn't get scheduled on startup, wait here
@@ -790,12 +822,12 @@ void TraceThread::run()
 
    Sift::Instruction inst, next_inst;
 
-   bool have_first = m_trace.Read(inst);
+   bool have_first = readInstruction(inst);
    // Received first instruction, let TraceManager know our SIFT connection is up and running
    Sim()->getTraceManager()->signalStarted();
    m_started = true;
 
-   while(have_first && m_trace.Read(next_inst))
+   while(have_first && readInstruction(next_inst))
    {
       if (m_blocked)
       {
@@ -834,9 +866,11 @@ void TraceThread::run()
       switch(Sim()->getInstrumentationMode())
       {
          case InstMode::FAST_FORWARD:
+            flushBlock();
             break;
 
          case InstMode::CACHE_ONLY:
+            flushBlock();
             handleInstructionWarmup(inst, next_inst, core, do_icache_warmup, icache_warmup_addr, icache_warmup_size);
             break;
 
@@ -852,11 +886,15 @@ void TraceThread::run()
       // We may have been rescheduled to a different core
       // by prfmdl->iterate (in handleInstructionDetailed),
       // or core->countInstructions (when using a fast-forward performance model)
-      SubsecondTime time = prfmdl->getElapsedTime();
-      if (m_thread->reschedule(time, core))
+      // Only move between basic blocks, the instructions queued so far must be simulated on this core
+      if (m_block_queued == 0)
       {
-         core = m_thread->getCore();
-         prfmdl = core->getPerformanceModel();
+         SubsecondTime time = prfmdl->getElapsedTime();
+         if (m_thread->reschedule(time, core))
+         {
+            core = m_thread->getCore();
+            prfmdl = core->getPerformanceModel();
+         }
       }
 
 
@@ -866,6 +904,9 @@ void TraceThread::run()
       inst = next_inst;
    }
 
+   flushBlock();
+   stopPrefetch();
+
    printf("[TRACE:%u] -- %s --\n", m_thread->getId(), m_stop ? "STOP" : "DONE");
 
    SubsecondTime time_end = prfmdl->getElapsedTime();
@@ -874,6 +915,142 @@ void TraceThread::run()
    Sim()->getTraceManager()->signalDone(this, time_end, m_stop /*aborted*/);
 }
 
+void TraceThread::startPrefetch()
+{
+   m_prefetch_queue = new SPSCCircularQueue<PrefetchEntry>(m_prefetch_size);
+   m_prefetcher = new Prefetcher(this);
+   m_prefetcher->spawn();
+}
+
+void TraceThread::stopPrefetch()
+{
+   if (m_prefetcher == NULL)
+      return;
+
+   // Normally the prefetcher has already seen the end of the trace. When we stop early, interrupt its read (which may be
+   // waiting for the recorder) and keep the reader from answering the recorder for callbacks that we will not execute.
+   // Then make it drop the rest of the trace, and release it from the callback it may be waiting on.
+   m_trace.Abort();
+   m_prefetch_queue->abort();
+
+   ScopedLock sl(m_prefetch_lock);
+   m_prefetch_stopping = true;
+   m_prefetch_cond.broadcast();
+   while(!m_prefetch_exited)
+      m_prefetch_cond.wait(m_prefetch_lock);
+}
+
+void TraceThread::prefetch()
+{
+   PrefetchEntry entry;
+   do
+   {
+      entry.type = m_trace.Read(entry.inst) ? PrefetchEntry::INSTRUCTION : PrefetchEntry::END;
+      if (!m_prefetch_queue->push_wait(entry))
+         break;
+   }
+   while(entry.type != PrefetchEntry::END);
+
+   ScopedLock sl(m_prefetch_lock);
+   m_prefetch_exited = true;
+   m_prefetch_cond.broadcast();
+}
+
+bool TraceThread::readInstruction(Sift::Instruction &inst)
+{
+   if (m_prefetcher == NULL)
+      return m_trace.Read(inst);
+
+   while(true)
+   {
+      PrefetchEntry entry = m_prefetch_queue->pop_wait();
+      switch(entry.type)
+      {
+         case PrefetchEntry::INSTRUCTION:
+            inst = entry.inst;
+            return true;
+         case PrefetchEntry::CACHEONLY:
+            handleCacheOnlyFunc(entry.icount, entry.cacheonly_type, entry.eip, entry.address);
+            break;
+         case PrefetchEntry::CALLBACK:
+         {
+            (*m_prefetch_callback)();
+            ScopedLock sl(m_prefetch_lock);
+            m_prefetch_callback = NULL;
+            m_prefetch_cond.broadcast();
+            break;
+         }
+         case PrefetchEntry::END:
+            return false;
+      }
+   }
+}
+
+void TraceThread::callback(const std::function<void()> &func)
+{
+   if (m_prefetcher == NULL)
+   {
+      func();
+      return;
+   }
+
+   // We're in the prefetcher: have run() execute the callback when it gets to this point in the trace, and wait for the
+   // result that the reader may have to send to the recorder. When run() stopped early, the callback is dropped
+   // (the reader was aborted, so it does not send the result).
+   PrefetchEntry entry;
+   entry.type = PrefetchEntry::CALLBACK;
+   m_prefetch_callback = &func;
+   if (!m_prefetch_queue->push_wait(entry))
+      return;
+
+   ScopedLock sl(m_prefetch_lock);
+   while(m_prefetch_callback && !m_prefetch_stopping)
+      m_prefetch_cond.wait(m_prefetch_lock);
+}
+
+void TraceThread::callbackCacheOnly(uint8_t icount, Sift::CacheOnlyType type, uint64_t eip, uint64_t address)
+{
+   if (m_prefetcher == NULL)
+   {
+      handleCacheOnlyFunc(icount, type, eip, address);
+      return;
+   }
+
+   PrefetchEntry entry;
+   entry.type = PrefetchEntry::CACHEONLY;
+   entry.icount = icount;
+   entry.cacheonly_type = type;
+   entry.eip = eip;
+   entry.address = address;
+   m_prefetch_queue->push_wait(entry);
+}
+
+TraceThread::Prefetcher::Prefetcher(TraceThread *trace_thread)
+   : m_thread(NULL)
+   , m_trace_thread(trace_thread)
+{
+}
+
+TraceThread::Prefetcher::~Prefetcher()
+{
+   delete m_thread;
+}
+
+void TraceThread::Prefetcher::run()
+{
+   // Set thread name for Sniper-in-Sniper simulations
+   String threadName = String("trace-prefetch-") + itostr(m_trace_thread->m_thread->getId());
+   SimSetThreadName(threadName.c_str());
+
+   m_trace_thread->prefetch();
+}
+
+void TraceThread::Prefetcher::spawn()
+{
+   m_thread = _Thread::create(this);
+   m_thread->run();
+}
+
 void TraceThread::spawn()
 {
    m__thread = _Thread::create(this);
@@ -8,6 +8,11 @@
 #include "sift_reader.h"
 #include "operand.h"
 #include "semaphore.h"
+#include "trace_pool.h"
+#include "translation_cache.h"
+#include "spsc_circular_queue.h"
+#include "lock.h"
+#include "cond.h"
 
 #include <decoder.h>
 
@@ -16,6 +21,8 @@
 //}
 
 #include <unordered_map>
+#include <functional>
+#include <atomic>
 
 #define NUM_PAPI_COUNTERS 6
 
@@ -57,17 +64,58 @@ class TraceThread : public Runnable
       bool m_trace_has_pa;
       bool m_address_randomization;
       bool m_appid_from_coreid;
+      const TracePool::Trace *m_pooled_trace;   //< Shared trace this thread replays, NULL when reading from m_tracefile
+      UInt64 m_address_space;                   //< Upper physical address bits of a pooled instance
       uint8_t m_address_randomization_table[256];
       bool m_stop;
-      std::unordered_map<IntPtr, Instruction *> m_icache;
-      //std::unordered_map<IntPtr, const xed_decoded_inst_t *> m_decoder_cache;  // TODO convert to DecoderLib
+      // Translations are attached to their Sift::StaticInstruction (through user_data) so the per-instruction path
+      // needs no lookup by PC; m_translation_cache is shared by all threads of the application unless it is private
+      typedef TranslationCache::MemoryOperand MemoryOperand;
+      typedef TranslationCache::Translation Translation;
+      TranslationCache *m_translation_cache;
+      bool m_translation_cache_private;        //< m_translation_cache is ours to delete
       //static bool xed_initialized;  // TODO convert to DecoderLib
       //xed_state_t m_xed_state_init;  // TODO convert to DecoderLib
-      std::unordered_map<IntPtr, const dl::DecodedInst *> m_decoder_cache;  // TODO convert to DecoderLib
       UInt64 m_bbv_base;
       UInt64 m_bbv_count;
       UInt64 m_bbv_last;
       bool m_bbv_end;
+      UInt32 m_block_queued;                   //< Instructions of the current basic block queued but not yet simulated
+      static const UInt32 max_block_queued = 32;
+
+      // Optional decoupled front end: the prefetcher thread reads ahead in the trace (waiting on the recorder, inflating
+      // compressed input, decoding records) and hands instructions to run() through a single-producer, single-consumer queue.
+      // Reader callbacks act as a barrier: they are queued in trace order, and the prefetcher waits until run() has executed them.
+      class Prefetcher : public Runnable
+      {
+         private:
+            void run();
+            _Thread *m_thread;
+            TraceThread *m_trace_thread;
+         public:
+            Prefetcher(TraceThread *trace_thread);
+            ~Prefetcher();
+            void spawn();
+      };
+      struct PrefetchEntry
+      {
+         enum Type { INSTRUCTION, CACHEONLY, CALLBACK, END } type;
+         Sift::Instruction inst;
+         // CACHEONLY records carry no pointers into the reader, so the prefetcher does not have to wait for them
+         uint8_t icount;
+         Sift::CacheOnlyType cacheonly_type;
+         uint64_t eip;
+         uint64_t address;
+      };
+      const UInt32 m_prefetch_size;
+      Prefetcher *m_prefetcher;                //< NULL when not prefetching
+      SPSCCircularQueue<PrefetchEntry> *m_prefetch_queue;
+      const std::function<void()> *m_prefetch_callback; //< Callback of the CALLBACK entry in the queue, NULL once executed
+      Lock m_prefetch_lock;                    //< Protects the handshake below
+      ConditionVariable m_prefetch_cond;
+      bool m_prefetch_stopping;                //< run() stopped early, callbacks are no longer executed
+      bool m_prefetch_exited;
+
       static int m_isa;
       //xed_syntax_enum_t m_syntax;
       uint8_t m_output_leftover[160];
@@ -80,28 +128,35 @@ class TraceThread : public Runnable
       bool m_started;
 
       void run();
+      void prefetch();
+      void startPrefetch();
+      void stopPrefetch();
+      bool readInstruction(Sift::Instruction &inst);
+      void callback(const std::function<void()> &func);
+      void callbackCacheOnly(uint8_t icount, Sift::CacheOnlyType type, uint64_t eip, uint64_t address);
+      // Reader callbacks run in the prefetcher thread when prefetching, callback() makes them run in ours
       static Sift::Mode __handleInstructionCountFunc(void* arg, uint32_t icount)
-      { return ((TraceThread*)arg)->handleInstructionCountFunc(icount); }
+      { TraceThread *self = (TraceThread*)arg; Sift::Mode res = Sift::ModeUnknown; self->callback([&]() { res = self->handleInstructionCountFunc(icount); }); return res; }
       static void __handleCacheOnlyFunc(void* arg, uint8_t icount, Sift::CacheOnlyType type, uint64_t eip, uint64_t address)
-      { ((TraceThread*)arg)->handleCacheOnlyFunc(icount, type, eip, address); }
+      { ((TraceThread*)arg)->callbackCacheOnly(icount, type, eip, address); }
       static void __handleOutputFunc(void* arg, uint8_t fd, const uint8_t *data, uint32_t size)
-      { ((TraceThread*)arg)->handleOutputFunc(fd, data, size); }
+      { TraceThread *self = (TraceThread*)arg; self->callback([&]() { self->handleOutputFunc(fd, data, size); }); }
       static uint64_t __handleSyscallFunc(void* arg, uint16_t syscall_number, const uint8_t *data, uint32_t size)
-      { return ((TraceThread*)arg)->handleSyscallFunc(syscall_number, data, size); }
+      { TraceThread *self = (TraceThread*)arg; uint64_t res = 0; self->callback([&]() { res = self->handleSyscallFunc(syscall_number, data, size); }); return res; }
       static int32_t __handleNewThreadFunc(void* arg)
-      { return ((TraceThread*)arg)->handleNewThreadFunc(); }
+      { TraceThread *self = (TraceThread*)arg; int32_t res = 0; self->callback([&]() { res = self->handleNewThreadFunc(); }); return res; }
       static int32_t __handleJoinFunc(void* arg, int32_t join_thread_id)
-      { return ((TraceThread*)arg)->handleJoinFunc(join_thread_id); }
+      { TraceThread *self = (TraceThread*)arg; int32_t res = 0; self->callback([&]() { res = self->handleJoinFunc(join_thread_id); }); return res; }
       static uint64_t __handleMagicFunc(void* arg, uint64_t a, uint64_t b, uint64_t c)
-      { return ((TraceThread*)arg)->handleMagicFunc(a, b, c); }
+      { TraceThread *self = (TraceThread*)arg; uint64_t res = 0; self->callback([&]() { res = self->handleMagicFunc(a, b, c); }); return res; }
       static bool __handleEmuFunc(void* arg, Sift::EmuType type, Sift::EmuRequest &req, Sift::EmuReply &res)
-      { return ((TraceThread*)arg)->handleEmuFunc(type, req, res); }
+      { TraceThread *self = (TraceThread*)arg; bool ret = false; self->callback([&]() { ret = self->handleEmuFunc(type, req, res); }); return ret; }
       static void __handleRoutineChangeFunc(void* arg, Sift::RoutineOpType event, uint64_t eip, uint64_t esp, uint64_t callEip)
-      { ((TraceThread*)arg)->handleRoutineChangeFunc(event, eip, esp, callEip); }
+      { TraceThread *self = (TraceThread*)arg; self->callback([&]() { self->handleRoutineChangeFunc(event, eip, esp, callEip); }); }
       static void __handleRoutineAnnounceFunc(void* arg, uint64_t eip, const char *name, const char *imgname, uint64_t offset, uint32_t line, uint32_t column, const char *filename)
-      { ((TraceThread*)arg)->handleRoutineAnnounceFunc(eip, name, imgname, offset, line, column, filename); }
+      { TraceThread *self = (TraceThread*)arg; self->callback([&]() { self->handleRoutineAnnounceFunc(eip, name, imgname, offset, line, column, filename); }); }
       static int32_t __handleForkFunc(void* arg)
-      { return ((TraceThread*)arg)->handleForkFunc();}
+      { TraceThread *self = (TraceThread*)arg; int32_t res = 0; self->callback([&]() { res = self->handleForkFunc(); }); return res; }
 
       Sift::Mode handleInstructionCountFunc(uint32_t icount);
       void handleCacheOnlyFunc(uint8_t icount, Sift::CacheOnlyType type, uint64_t eip, uint64_t address);
@@ -115,11 +170,13 @@ class TraceThread : public Runnable
       void handleRoutineChangeFunc(Sift::RoutineOpType event, uint64_t eip, uint64_t esp, uint64_t callEip);
       void handleRoutineAnnounceFunc(uint64_t eip, const char *name, const char *imgname, uint64_t offset, uint32_t line, uint32_t column, const char *filename);
 
-      Instruction* decode(Sift::Instruction &inst);
+      Translation& getTranslation(Sift::Instruction &inst);
+      Instruction* decode(Sift::Instruction &inst, const Translation &translation);
       void handleInstructionWarmup(Sift::Instruction &inst, Sift::Instruction &next_inst, Core *core, bool do_icache_warmup, UInt64 icache_warmup_addr, UInt64 icache_warmup_size);
       void handleInstructionDetailed(Sift::Instruction &inst, Sift::Instruction &next_inst, PerformanceModel *prfmdl);
+      void flushBlock();
       //void addDetailedMemoryInfo(DynamicInstruction *dynins, Sift::Instruction &inst, const xed_decoded_inst_t &xed_inst, uint32_t mem_idx, Operand::Direction op_type, bool is_pretetch, PerformanceModel *prfmdl);
-      void addDetailedMemoryInfo(DynamicInstruction *dynins, Sift::Instruction &inst, const dl::DecodedInst &decoded_inst, uint32_t mem_idx, Operand::Direction op_type, bool is_pretetch, PerformanceModel *prfmdl);
+      void addDetailedMemoryInfo(DynamicInstruction *dynins, Sift::Instruction &inst, const Translation &translation, const MemoryOperand &operand);
       void unblock();
 
       SubsecondTime getCurrentTime() const;
@@ -136,7 +193,7 @@ class TraceThread : public Runnable
    public:
       bool m_stopped;
 
-      TraceThread(Thread *thread, SubsecondTime time_start, String tracefile, String responsefile, app_id_t app_id, bool cleanup);
+      TraceThread(Thread *thread, SubsecondTime time_start, String tracefile, String responsefile, app_id_t app_id, bool cleanup, const TracePool::Trace *pooled_trace = NULL, UInt64 address_space = 0, TranslationCache *translation_cache = NULL);
       ~TraceThread();
 
       void spawn();
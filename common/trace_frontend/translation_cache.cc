@@ -0,0 +1,79 @@
+#include "translation_cache.h"
+#include "instruction.h"
+#include "micro_op.h"
+#include "log.h"
+
+TranslationCache::Translation::Translation(const dl::DecodedInst *_decoded)
+   : decoded(_decoded)
+   , instruction(NULL)
+   , is_atomic(_decoded->is_atomic())
+   , is_prefetch(_decoded->is_prefetch())
+   , is_mem_pair(_decoded->is_mem_pair())
+{
+}
+
+TranslationCache::TranslationCache(UInt64 size)
+   : m_hash(size ? new LockFreeHash(size) : NULL)
+{
+}
+
+TranslationCache::~TranslationCache()
+{
+   // Instructions are referenced by DynamicInstructions until the end of the simulation, so leave them alone
+   for(std::vector<Translation*>::iterator it = m_translations.begin(); it != m_translations.end(); ++it)
+      destroy(*it);
+   delete m_hash;
+}
+
+void TranslationCache::destroy(Translation *translation)
+{
+   delete translation->decoded;
+   delete translation;
+}
+
+TranslationCache::Translation* TranslationCache::find(IntPtr pc) const
+{
+   if (m_hash)
+   {
+      std::pair<bool, UInt64> res = m_hash->find(pc);
+      if (res.first)
+         return reinterpret_cast<Translation*>(res.second);
+   }
+   return NULL;
+}
+
+TranslationCache::Translation* TranslationCache::publish(IntPtr pc, Translation *translation)
+{
+   if (m_hash && pc != 0)
+   {
+      std::pair<bool, UInt64> res = m_hash->insert(pc, reinterpret_cast<UInt64>(translation));
+      if (!res.first && res.second)
+      {
+         // Another thread decoded this PC at the same time and was first to publish it
+         destroy(translation);
+         return reinterpret_cast<Translation*>(res.second);
+      }
+      // Either inserted or the table is full; in the latter case this translation stays with the calling thread
+   }
+
+   ScopedLock sl(m_lock);
+   m_translations.push_back(translation);
+   return translation;
+}
+
+Instruction* TranslationCache::publish(Translation *translation, Instruction *instruction)
+{
+   Instruction *expected = NULL;
+   if (translation->instruction.compare_exchange_strong(expected, instruction))
+      return instruction;
+
+   // Lost the race, expected now holds the Instruction of the winning thread
+   if (instruction->getMicroOps())
+   {
+      for(std::vector<const MicroOp*>::const_iterator it = instruction->getMicroOps()->begin(); it != instruction->getMicroOps()->end(); ++it)
+         delete *it;
+      delete instruction->getMicroOps();
+   }
+   delete instruction;
+   return expected;
+}
@@ -0,0 +1,62 @@
+#ifndef __TRANSLATION_CACHE_H
+#define __TRANSLATION_CACHE_H
+
+#include "fixed_types.h"
+#include "operand.h"
+#include "lock.h"
+#include "lockfree_hash.h"
+
+#include <decoder.h>
+
+#include <atomic>
+#include <vector>
+
+class Instruction;
+
+// Translation cache: everything the trace frontend derives from a static instruction.
+// A shared cache holds the translations of one application: each PC is decoded by the first thread
+// that executes it and published in a lock-free hash table, the other threads of the application
+// (and later runs of it) pick it up from there without decoding. Translations are never changed or
+// removed once published. A private cache (size 0) only owns the translations of a single thread.
+
+class TranslationCache
+{
+   public:
+      struct MemoryOperand
+      {
+         UInt32 index;                          //< Memory operand index in the decoder
+         Operand::Direction direction;
+         UInt32 size;
+      };
+      struct Translation
+      {
+         Translation(const dl::DecodedInst *decoded);
+
+         const dl::DecodedInst *decoded;
+         std::atomic<Instruction*> instruction; //< Created the first time the instruction is simulated in detail
+         bool is_atomic;
+         bool is_prefetch;
+         bool is_mem_pair;
+         std::vector<MemoryOperand> memory_operands; //< Reads, then writes; none for NOPs
+      };
+
+      TranslationCache(UInt64 size);
+      ~TranslationCache();
+
+      // Published translation of this PC, NULL if there is none (or the cache is private)
+      Translation* find(IntPtr pc) const;
+      // Take ownership of a new translation and make it available to other threads. If another thread
+      // published this PC first, ours is deleted and theirs is returned.
+      Translation* publish(IntPtr pc, Translation *translation);
+      // Same for the Instruction of a translation
+      Instruction* publish(Translation *translation, Instruction *instruction);
+
+   private:
+      LockFreeHash *m_hash;                     //< PC -> Translation*, NULL for a private cache
+      Lock m_lock;
+      std::vector<Translation*> m_translations; //< Owns all Translations
+
+      static void destroy(Translation *translation);
+};
+
+#endif // __TRANSLATION_CACHE_H
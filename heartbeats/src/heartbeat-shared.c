@@ -76,6 +76,8 @@ heartbeat_t* heartbeat_init(int64_t window_size,
   hb->current_index = 0;
   hb->state->min_heartrate = min_target;
   hb->state->max_heartrate = max_target;
+  // Register the target heart-rate window with the simulator (in milli-beats per second)
+  SimHeartbeatTarget((unsigned long) (min_target * 1000), (unsigned long) (max_target * 1000));
   hb->state->counter = 0;
   hb->state->buffer_index = 0;
   hb->state->read_index = 0;
@@ -192,7 +194,7 @@ int64_t heartbeat( heartbeat_t* hb, int tag )
     pthread_mutex_lock(&hb->mutex);
     //printf("Registering Heartbeat\n");
     old_last_time = hb->last_timestamp;
-    time = SimUser(0x123, 1) / 1000000; // get fs time and convert to ns
+    time = SimHeartbeat(tag); // report the beat to the simulator, returns the simulated time in ns
 
     // TODO - parse with gmtime(), to see if value is valid timestamp?
     //      - Maybe simpler parse method to minimize perf impact of beats.
@@ -17,6 +17,8 @@
 #define SIM_CMD_NUM_THREADS     12
 #define SIM_CMD_NAMED_MARKER    13
 #define SIM_CMD_SET_THREAD_NAME 14
+#define SIM_CMD_HEARTBEAT_TARGET 15
+#define SIM_CMD_HEARTBEAT       16
 
 #define SIM_OPT_INSTRUMENT_DETAILED    0
 #define SIM_OPT_INSTRUMENT_WARMUP      1
@@ -130,6 +132,9 @@
 #define SimNamedMarker(arg0, str) SimMagic2(SIM_CMD_NAMED_MARKER, arg0, (unsigned long)(str))
 #define SimUser(cmd, arg)         SimMagic2(SIM_CMD_USER, cmd, arg)
 #define SimSetInstrumentMode(opt) SimMagic1(SIM_CMD_INSTRUMENT_MODE, opt)
+// Heart rates are passed in milli-beats per second; SimHeartbeat returns the simulated time in nanoseconds
+#define SimHeartbeatTarget(min_mbps, max_mbps) SimMagic2(SIM_CMD_HEARTBEAT_TARGET, min_mbps, max_mbps)
+#define SimHeartbeat(tag)         SimMagic1(SIM_CMD_HEARTBEAT, tag)
 #define SimInSimulator()          (SimMagic0(SIM_CMD_IN_SIMULATOR)!=SIM_CMD_IN_SIMULATOR)
 
 #endif /* __SIM_API */
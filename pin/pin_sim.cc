@@ -441,9 +441,9 @@ int main(int argc, char *argv[])
          fclose(fp);
       }
       String scheme = Sim()->getCfg()->getString("clock_skew_minimization/scheme");
-      if (!(scheme == "none" || scheme == "barrier")) {
+      if (!(scheme == "none" || scheme == "barrier" || scheme == "slack")) {
          fprintf(stderr, "\n[WARNING] Application debugging is not compatible with %s synchronization.\n", scheme.c_str());
-         fprintf(stderr, "          Consider adding -g --clock_skew_minimization/scheme={none|barrier}\n\n");
+         fprintf(stderr, "          Consider adding -g --clock_skew_minimization/scheme={none|barrier|slack}\n\n");
       }
    }
 
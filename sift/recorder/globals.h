@@ -27,6 +27,9 @@ extern KNOB<UINT64> KnobDetailedTarget;
 extern KNOB<UINT64> KnobUseResponseFiles;
 extern KNOB<UINT64> KnobEmulateSyscalls;
 extern KNOB<BOOL>   KnobSendPhysicalAddresses;
+extern KNOB<UINT64> KnobChunkCompression;
+extern KNOB<std::string> KnobCodeStore;
+extern KNOB<UINT64> KnobIndexInterval;
 extern KNOB<UINT64> KnobFlowControl;
 extern KNOB<UINT64> KnobFlowControlFF;
 extern KNOB<INT64> KnobSiftAppId;
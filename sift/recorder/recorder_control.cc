@@ -370,7 +370,7 @@ void openFile(THREADID threadid)
    #else
       const bool arch32 = false;
    #endif
-   thread_data[threadid].output = new Sift::Writer(filename, getCode, KnobUseResponseFiles.Value() ? false : true, response_filename, threadid, arch32, false, KnobSendPhysicalAddresses.Value());
+   thread_data[threadid].output = new Sift::Writer(filename, getCode, KnobUseResponseFiles.Value() ? false : true, response_filename, threadid, arch32, false, KnobSendPhysicalAddresses.Value(), NULL, NULL, KnobChunkCompression.Value(), KnobCodeStore.Value().empty() ? NULL : KnobCodeStore.Value().c_str());
 
    if (!thread_data[threadid].output->IsOpen())
    {
@@ -378,6 +378,13 @@ void openFile(THREADID threadid)
       exit(1);
    }
 
+   if (KnobIndexInterval.Value())
+   {
+      char index_filename[1024];
+      sprintf(index_filename, "%s.idx", filename);
+      thread_data[threadid].output->setIndex(index_filename, KnobIndexInterval.Value());
+   }
+
    thread_data[threadid].output->setHandleAccessMemoryFunc(handleAccessMemory, reinterpret_cast<void*>(threadid));
 }
 
@@ -0,0 +1,161 @@
+#include "sift_codestore.h"
+
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#if SIFT_USE_FAST_READER
+#include <sys/mman.h>
+#endif
+
+Sift::CodeStore::CodeStore(const char *filename, bool writable)
+   : m_fd(-1)
+   , m_scanned(0)
+   , m_pages()
+   , m_map(NULL)
+   , m_map_size(0)
+{
+   if (writable)
+      m_fd = open(filename, O_RDWR | O_CREAT | O_APPEND, 0644);
+   else
+      m_fd = open(filename, O_RDONLY);
+
+   if (m_fd >= 0)
+      scan();
+}
+
+Sift::CodeStore::~CodeStore()
+{
+#if SIFT_USE_FAST_READER
+   if (m_map)
+      munmap(const_cast<uint8_t*>(m_map), m_map_size);
+#endif
+   if (m_fd >= 0)
+      close(m_fd);
+}
+
+static inline uint64_t rotl64(uint64_t x, int r)
+{
+   return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t fmix64(uint64_t k)
+{
+   k ^= k >> 33;
+   k *= 0xff51afd7ed558ccdULL;
+   k ^= k >> 33;
+   k *= 0xc4ceb9fe1a85ec53ULL;
+   k ^= k >> 33;
+   return k;
+}
+
+Sift::CodeStoreHash Sift::CodeStore::Hash(const uint8_t *page)
+{
+   // MurmurHash3 (x64, 128-bit variant), seed 0. ICACHE_SIZE is a multiple of the 16-byte block size so there is no tail.
+   const uint64_t c1 = 0x87c37b91114253d5ULL;
+   const uint64_t c2 = 0x4cf5ad432745937fULL;
+   uint64_t h1 = 0, h2 = 0;
+
+   for(uint32_t i = 0 ; i < ICACHE_SIZE ; i += 16)
+   {
+      uint64_t k1, k2;
+      memcpy(&k1, page + i, sizeof(k1));
+      memcpy(&k2, page + i + 8, sizeof(k2));
+
+      k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+      h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+      k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+      h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+   }
+
+   h1 ^= ICACHE_SIZE; h2 ^= ICACHE_SIZE;
+   h1 += h2; h2 += h1;
+   h1 = fmix64(h1); h2 = fmix64(h2);
+   h1 += h2; h2 += h1;
+
+   CodeStoreHash hash = { h1, h2 };
+   return hash;
+}
+
+void Sift::CodeStore::scan()
+{
+   struct stat filestatus;
+   if (fstat(m_fd, &filestatus) != 0)
+      return;
+
+   // Another writer may be appending the last entry, only consider complete ones
+   while (m_scanned + sizeof(CodeStoreEntry) + ICACHE_SIZE <= uint64_t(filestatus.st_size))
+   {
+      CodeStoreEntry entry;
+      if (pread(m_fd, &entry, sizeof(entry), m_scanned) != sizeof(entry))
+         return;
+      if (entry.magic != CodeStoreMagic || entry.size != ICACHE_SIZE)
+      {
+         std::cerr << "[SIFT] Error: Invalid code store entry at offset " << m_scanned << "\n";
+         return;
+      }
+      // Keep the first copy of pages that were appended more than once by concurrent writers
+      m_pages.insert(std::make_pair(entry.hash, m_scanned + sizeof(entry)));
+      m_scanned += sizeof(entry) + ICACHE_SIZE;
+   }
+}
+
+bool Sift::CodeStore::Add(const CodeStoreHash &hash, const uint8_t *page)
+{
+   if (m_pages.count(hash))
+      return true;
+   scan();
+   if (m_pages.count(hash))
+      return true;
+
+   // A single write with O_APPEND so entries of concurrent writers do not interleave
+   uint8_t buffer[sizeof(CodeStoreEntry) + ICACHE_SIZE];
+   CodeStoreEntry entry = { CodeStoreMagic, ICACHE_SIZE, hash };
+   memcpy(buffer, &entry, sizeof(entry));
+   memcpy(buffer + sizeof(entry), page, ICACHE_SIZE);
+   ssize_t res;
+   do
+      res = write(m_fd, buffer, sizeof(buffer));
+   while (res < 0 && errno == EINTR);
+
+   if (res != ssize_t(sizeof(buffer)))
+      std::cerr << "[SIFT] Warning: Cannot append to the code store\n";
+   return false;
+}
+
+bool Sift::CodeStore::Get(const CodeStoreHash &hash, uint8_t *page)
+{
+   std::unordered_map<CodeStoreHash, uint64_t, HashHash>::iterator it = m_pages.find(hash);
+   if (it == m_pages.end())
+   {
+      scan();
+      it = m_pages.find(hash);
+      if (it == m_pages.end())
+         return false;
+   }
+   uint64_t offset = it->second;
+
+#if SIFT_USE_FAST_READER
+   if (offset + ICACHE_SIZE > m_map_size)
+   {
+      // The store grew since it was mapped, map everything we have scanned so far
+      if (m_map)
+         munmap(const_cast<uint8_t*>(m_map), m_map_size);
+      void *data = mmap(NULL, m_scanned, PROT_READ, MAP_SHARED, m_fd, 0);
+      if (data == MAP_FAILED)
+      {
+         m_map = NULL;
+         m_map_size = 0;
+         return pread(m_fd, page, ICACHE_SIZE, offset) == ICACHE_SIZE;
+      }
+      m_map = static_cast<const uint8_t*>(data);
+      m_map_size = m_scanned;
+   }
+   memcpy(page, m_map + offset, ICACHE_SIZE);
+   return true;
+#else
+   return pread(m_fd, page, ICACHE_SIZE, offset) == ICACHE_SIZE;
+#endif
+}
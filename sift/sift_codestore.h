@@ -0,0 +1,40 @@
+#ifndef __SIFT_CODESTORE_H
+#define __SIFT_CODESTORE_H
+
+#include "sift.h"
+#include "sift_format.h"
+
+#include <unordered_map>
+
+namespace Sift
+{
+   inline bool operator==(const CodeStoreHash &a, const CodeStoreHash &b) { return a.lo == b.lo && a.hi == b.hi; }
+
+   // Content-addressed code page store (see Sift::CodeStoreEntry), shared between the writers and readers of many traces.
+   // Pages appended by other processes are picked up by rescanning the end of the file whenever a hash is not found.
+   class CodeStore
+   {
+      private:
+         struct HashHash { size_t operator()(const CodeStoreHash &h) const { return h.lo; } };
+
+         int m_fd;
+         uint64_t m_scanned;        // Length of the file covered by m_pages
+         std::unordered_map<CodeStoreHash, uint64_t, HashHash> m_pages; // Hash -> file offset of the page
+         const uint8_t *m_map;      // Read-only mapping of the first m_map_size bytes of the file
+         uint64_t m_map_size;
+
+         void scan();
+
+      public:
+         CodeStore(const char *filename, bool writable);
+         ~CodeStore();
+         bool IsOpen() const { return m_fd >= 0; }
+         static CodeStoreHash Hash(const uint8_t *page);
+         // Writer: returns true if the page is already in the store, else appends it and returns false
+         bool Add(const CodeStoreHash &hash, const uint8_t *page);
+         // Reader: copy the page with this hash into page (ICACHE_SIZE bytes), false if it is not in the store
+         bool Get(const CodeStoreHash &hash, uint8_t *page);
+   };
+};
+
+#endif // __SIFT_CODESTORE_H
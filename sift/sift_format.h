@@ -18,6 +18,14 @@
 # define SIFT_USE_ZLIB 1
 #endif
 
+// Memory-mapped input and background decompression need mmap and std::thread, which we do not use with PinCRT
+// (the recorder only writes traces)
+#if defined(PIN_CRT)
+# define SIFT_USE_FAST_READER 0
+#else
+# define SIFT_USE_FAST_READER 1
+#endif
+
 namespace Sift
 {
 
@@ -42,8 +50,86 @@ namespace Sift
       ArchIA32 = 2,
       IcacheVariable = 4,
       PhysicalAddress = 8,
+      CompressionChunked = 16,
+      IcacheStore = 32,          //< The extra header holds the path of a code page store (not NUL-terminated)
    } Option;
 
+   // Chunked container (CompressionChunked): after the header, the trace is a sequence of independently compressed chunks,
+   // each starting at a record boundary. The writer ends the file with an index of all chunks and a trailer,
+   // such that any chunk can be located and decompressed without reading the ones before it.
+   const uint32_t ChunkMagic = 0x4b4e4843; // "CHNK"
+
+   typedef enum
+   {
+      ChunkZlib = 1,
+      ChunkIndex = 2,            //< Payload: uncompressed array of ChunkIndexEntry
+   } ChunkType;
+
+   typedef struct
+   {
+      uint32_t magic;
+      uint8_t type;
+      uint8_t reserved[3];
+      uint32_t compressed_size;
+      uint32_t uncompressed_size;
+   } __attribute__ ((__packed__)) ChunkHeader;
+
+   typedef struct
+   {
+      uint64_t offset;           //< File offset of the ChunkHeader
+      uint64_t uncompressed_offset; //< Offset of the chunk's first byte in the uncompressed record stream
+   } __attribute__ ((__packed__)) ChunkIndexEntry;
+
+   typedef struct
+   {
+      uint64_t index_offset;     //< File offset of the ChunkIndex ChunkHeader
+      uint32_t num_chunks;
+      uint32_t magic;            //< ChunkMagic
+   } __attribute__ ((__packed__)) ChunkTrailer;
+
+   // Trace index (<trace>.idx, written by Sift::IndexWriter): a checkpoint of the reader state every so many instructions,
+   // such that Sift::Reader::Seek can start at a checkpoint instead of decoding the whole prefix of the trace.
+   // Only uncompressed and chunked traces can be indexed. The file is an IndexHeader followed by IndexEntry records,
+   // each followed by the code pages written or modified (uint64_t address + ICACHE_SIZE bytes) and the va2pa mappings
+   // added (uint64_t vp, pp) since the previous entry, so the state at an entry is the sum of all entries up to it.
+   const uint32_t IndexMagic = 0x58444953; // "SIDX"
+
+   typedef struct
+   {
+      uint32_t magic;
+      uint32_t reserved;
+      uint64_t interval;         //< Number of instructions between entries
+   } __attribute__ ((__packed__)) IndexHeader;
+
+   typedef struct
+   {
+      uint64_t icount;           //< Instructions in the trace before this point
+      uint64_t offset;           //< Offset of the next record in the uncompressed record stream (i.e., after the Header)
+      uint64_t last_address;     //< Address of the next simple instruction
+      uint32_t isa;
+      uint32_t num_pages;
+      uint32_t num_mappings;
+   } __attribute__ ((__packed__)) IndexEntry;
+
+   // Code page store (written by Sift::CodeStore): code pages shared between traces, addressed by a 128-bit hash
+   // of their contents. The file is a sequence of CodeStoreEntry records, each followed by its ICACHE_SIZE page.
+   // Entries are only ever appended (atomically, with O_APPEND) so several recorders can share one store;
+   // a trace with the IcacheStore option may replace RecOtherIcache records by RecOtherIcacheRef records
+   // (uint64_t address + CodeStoreHash) for pages that were already in the store.
+   const uint32_t CodeStoreMagic = 0x45444f43; // "CODE"
+
+   typedef struct
+   {
+      uint64_t lo, hi;
+   } __attribute__ ((__packed__)) CodeStoreHash;
+
+   typedef struct
+   {
+      uint32_t magic;
+      uint32_t size;             //< Page size, ICACHE_SIZE
+      CodeStoreHash hash;
+   } __attribute__ ((__packed__)) CodeStoreEntry;
+
    typedef union
    {
       // Simple format for common instructions
@@ -115,6 +201,7 @@ namespace Sift
       RecOtherInstructionCount,
       RecOtherCacheOnly,
       RecOtherISAChange,
+      RecOtherIcacheRef,
       RecOtherEnd = 0xff,
    } RecOtherType;
 
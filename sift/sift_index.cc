@@ -0,0 +1,83 @@
+#include "sift_index.h"
+#include "zfstream.h"
+
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+
+Sift::IndexWriter::IndexWriter(const char *filename, uint64_t interval)
+   : output(new vofstream(filename, std::ios::out | std::ios::binary | std::ios::trunc))
+   , m_interval(interval)
+   , m_next_icount(interval)
+{
+   assert(interval > 0);
+
+   IndexHeader hdr = { IndexMagic, 0, interval };
+   output->write(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+}
+
+Sift::IndexWriter::~IndexWriter()
+{
+   delete output;
+   for(std::unordered_map<uint64_t, uint8_t*>::iterator i = m_pages.begin() ; i != m_pages.end() ; ++i)
+   {
+      delete [] (*i).second;
+   }
+}
+
+bool Sift::IndexWriter::IsOpen()
+{
+   return output->is_open() && !output->fail();
+}
+
+void Sift::IndexWriter::Code(uint64_t addr, const uint8_t *data, uint32_t size)
+{
+   // Same bookkeeping as the reader's icache: code may straddle page boundaries
+   while (size > 0)
+   {
+      uint64_t base_addr = addr & ICACHE_PAGE_MASK;
+      uint64_t offset = addr & ICACHE_OFFSET_MASK;
+      uint32_t amount = std::min(uint64_t(size), ICACHE_SIZE - offset);
+
+      uint8_t *&page = m_pages[base_addr];
+      if (page == NULL)
+      {
+         page = new uint8_t[ICACHE_SIZE];
+         memset(page, 0, ICACHE_SIZE);
+      }
+      memcpy(page + offset, data, amount);
+      m_dirty_pages.insert(base_addr);
+
+      addr += amount;
+      data += amount;
+      size -= amount;
+   }
+}
+
+void Sift::IndexWriter::Mapping(uint64_t vp, uint64_t pp)
+{
+   m_mappings.push_back(std::make_pair(vp, pp));
+}
+
+void Sift::IndexWriter::Checkpoint(uint64_t icount, uint64_t offset, uint64_t last_address, uint32_t isa)
+{
+   IndexEntry entry = { icount, offset, last_address, isa, uint32_t(m_dirty_pages.size()), uint32_t(m_mappings.size()) };
+   output->write(reinterpret_cast<char*>(&entry), sizeof(entry));
+
+   for(std::set<uint64_t>::iterator it = m_dirty_pages.begin() ; it != m_dirty_pages.end() ; ++it)
+   {
+      uint64_t address = *it;
+      output->write(reinterpret_cast<char*>(&address), sizeof(uint64_t));
+      output->write(reinterpret_cast<char*>(m_pages[address]), ICACHE_SIZE);
+   }
+   for(std::vector<std::pair<uint64_t, uint64_t> >::iterator it = m_mappings.begin() ; it != m_mappings.end() ; ++it)
+   {
+      output->write(reinterpret_cast<char*>(&it->first), sizeof(uint64_t));
+      output->write(reinterpret_cast<char*>(&it->second), sizeof(uint64_t));
+   }
+   output->flush();
+
+   m_dirty_pages.clear();
+   m_mappings.clear();
+   m_next_icount = icount - icount % m_interval + m_interval;
+}
@@ -0,0 +1,38 @@
+#ifndef __SIFT_INDEX_H
+#define __SIFT_INDEX_H
+
+#include "sift.h"
+#include "sift_format.h"
+
+#include <unordered_map>
+#include <set>
+#include <vector>
+
+class vostream;
+
+namespace Sift
+{
+   // Writes a trace index (see Sift::IndexHeader). The owner reports all code and va2pa records as they are written
+   // (Sift::Writer) or read (siftindex), and calls Checkpoint() after every instruction for which isDue() returns true.
+   class IndexWriter
+   {
+      private:
+         vostream *output;
+         const uint64_t m_interval;
+         uint64_t m_next_icount;
+         std::unordered_map<uint64_t, uint8_t*> m_pages;   // Code pages as the reader sees them
+         std::set<uint64_t> m_dirty_pages;                 // Pages written since the last checkpoint
+         std::vector<std::pair<uint64_t, uint64_t> > m_mappings;
+
+      public:
+         IndexWriter(const char *filename, uint64_t interval);
+         ~IndexWriter();
+         bool IsOpen();
+         void Code(uint64_t addr, const uint8_t *data, uint32_t size);
+         void Mapping(uint64_t vp, uint64_t pp);
+         bool isDue(uint64_t icount) const { return icount >= m_next_icount; }
+         void Checkpoint(uint64_t icount, uint64_t offset, uint64_t last_address, uint32_t isa);
+   };
+};
+
+#endif // __SIFT_INDEX_H
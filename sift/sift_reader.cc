@@ -1,15 +1,22 @@
 #include "sift_reader.h"
 #include "sift_format.h"
 #include "sift_utils.h"
+#include "sift_index.h"
+#include "sift_codestore.h"
 #include "zfstream.h"
 
 #include <iostream>
 #include <fstream>
+#include <string>
 #include <cassert>
 #include <cstring>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#if SIFT_USE_FAST_READER
+# include <fcntl.h>
+# include <sys/mman.h>
+#endif
 
 // Enable (>0) to print out everything we read
 #define VERBOSE 0
@@ -18,7 +25,7 @@
 
 //bool Sift::Reader::xed_initialized = false;
 
-Sift::Reader::Reader(const char *filename, const char *response_filename, uint32_t id)
+Sift::Reader::Reader(const char *filename, const char *response_filename, uint32_t id, const uint8_t *buffer, uint64_t buffer_size)
    : input(NULL)
    , response(NULL)
    , handleInstructionCountFunc(NULL)
@@ -43,11 +50,26 @@ Sift::Reader::Reader(const char *filename, const char *response_filename, uint32
    , handleRoutineAnnounceFunc(NULL)
    , handleRoutineArg(NULL)   
    , filesize(0)
+   , inputstream(NULL)
+   , m_pipestream(NULL)
+   , m_buffer(buffer)
+   , m_buffer_size(buffer_size)
+   , m_bufferstream(NULL)
+   , m_mapped(false)
+   , m_ringstream(NULL)
+   , m_ringstream_base(sizeof(Sift::Header))
+   , m_record_base(0)
+   , m_indexable(true)
+   , m_icount(0)
+   , m_index(NULL)
+   , m_header_size(sizeof(Sift::Header))
+   , m_code_store(NULL)
    , last_address(0)
    , icache()
    , m_id(id)
    , m_trace_has_pa(false)
    , m_seen_end(false)
+   , m_aborted(false)
    , m_last_sinst(NULL)
    , m_isa(0)
 {
@@ -75,6 +97,14 @@ Sift::Reader::~Reader()
       delete input;
    if (response)
       delete response;
+   if (m_index)
+      delete m_index;
+   if (m_code_store)
+      delete m_code_store;
+#if SIFT_USE_FAST_READER
+   if (m_mapped)
+      munmap(const_cast<uint8_t*>(m_buffer), m_buffer_size);
+#endif
    for(std::unordered_map<uint64_t, const uint8_t*>::iterator i = icache.begin() ; i != icache.end() ; ++i)
    {
       delete [] (*i).second;
@@ -85,34 +115,106 @@ Sift::Reader::~Reader()
    }
 }
 
+bool Sift::Reader::mapFile()
+{
+#if SIFT_USE_FAST_READER
+   // Only regular files can be mapped; traces streamed through a pipe are read through std::ifstream
+   struct stat filestatus;
+   if (stat(m_filename, &filestatus) != 0 || !S_ISREG(filestatus.st_mode) || filestatus.st_size == 0)
+      return false;
+
+   int fd = open(m_filename, O_RDONLY);
+   if (fd < 0)
+      return false;
+   void *data = mmap(NULL, filestatus.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (data == MAP_FAILED)
+      return false;
+   madvise(data, filestatus.st_size, MADV_SEQUENTIAL);
+
+   m_buffer = static_cast<const uint8_t*>(data);
+   m_buffer_size = filestatus.st_size;
+   m_mapped = true;
+   return true;
+#else
+   return false;
+#endif
+}
+
 bool Sift::Reader::initStream()
 {
    #if VERBOSE > 0
    std::cerr << "[DEBUG:" << m_id << "] InitStream Attempting Open" << std::endl;
    #endif
 
-   inputstream = new std::ifstream(m_filename, std::ios::in);
-
-   if ((!inputstream->is_open()) || (!inputstream->good()))
+   if (m_buffer || mapFile())
    {
-      std::cerr << "[SIFT:" << m_id << "] Cannot open " << m_filename << "\n";
-      return false;
+      // The trace was already loaded (m_filename is only used for messages)
+      filesize = m_buffer_size;
+      m_bufferstream = new vimstream(m_buffer, m_buffer_size);
+      input = m_bufferstream;
    }
+   else
+   {
+      struct stat filestatus;
+      if (stat(m_filename, &filestatus) == 0 && !S_ISREG(filestatus.st_mode))
+      {
+         // Live trace from the recorder
+         m_pipestream = new vifdstream(m_filename);
+         input = m_pipestream;
+         if (!m_pipestream->is_open() || m_pipestream->fail())
+         {
+            std::cerr << "[SIFT:" << m_id << "] Cannot open " << m_filename << "\n";
+            return false;
+         }
+      }
+      else
+      {
+         inputstream = new std::ifstream(m_filename, std::ios::in);
 
-   struct stat filestatus;
-   stat(m_filename, &filestatus);
-   filesize = filestatus.st_size;
+         if ((!inputstream->is_open()) || (!inputstream->good()))
+         {
+            std::cerr << "[SIFT:" << m_id << "] Cannot open " << m_filename << "\n";
+            return false;
+         }
 
-   input = new vifstream(inputstream);
+         filesize = filestatus.st_size;
+
+         input = new vifstream(inputstream);
+      }
+   }
 
    Sift::Header hdr;
-   input->read(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+   readInput(reinterpret_cast<char*>(&hdr), sizeof(hdr));
    if (hdr.magic != Sift::MagicNumber)
    {
       std::cerr << "[SIFT:" << m_id << "] Invalid magic number\n";
       return false;
    }
-   if (hdr.size != 0)
+   std::string extra_header(hdr.size, '\0');
+   readInput(&extra_header[0], hdr.size);
+   m_header_size = sizeof(hdr) + hdr.size;
+   m_ringstream_base = m_header_size;
+
+   if (hdr.options & IcacheStore)
+   {
+      // Fall back to a store with the same name next to the trace, e.g. when the traces were copied elsewhere
+      m_code_store = new CodeStore(extra_header.c_str(), false);
+      if (!m_code_store->IsOpen())
+      {
+         std::string trace(m_filename), store(extra_header);
+         std::string local = trace.substr(0, trace.find_last_of('/') + 1) + store.substr(store.find_last_of('/') + 1);
+         delete m_code_store;
+         m_code_store = new CodeStore(local.c_str(), false);
+         if (!m_code_store->IsOpen())
+         {
+            std::cerr << "[SIFT:" << m_id << "] Error: Cannot open code store " << extra_header << "\n";
+            return false;
+         }
+      }
+      hdr.options &= ~IcacheStore;
+   }
+   else if (hdr.size != 0)
    {
       std::cerr << "[SIFT:" << m_id << "] Invalid header size\n";
    }
@@ -120,8 +222,35 @@ bool Sift::Reader::initStream()
 #if SIFT_USE_ZLIB
    if (hdr.options & CompressionZlib)
    {
-      input = new izstream(input);
+#if SIFT_USE_FAST_READER
+      if (m_bufferstream)
+      {
+         m_ringstream = new izringstream(input);
+         input = m_ringstream;
+      }
+      else
+#endif
+         input = new izstream(input);
       hdr.options &= ~CompressionZlib;
+      m_indexable = false;
+   }
+   if (hdr.options & CompressionChunked)
+   {
+#if SIFT_USE_FAST_READER
+      // Chunks are decompressed ahead of the reader, which only works on trace files: a recorder writing into a pipe
+      // waits for our responses, and does not write out a chunk until it is complete
+      if (m_pipestream)
+      {
+         std::cerr << "[SIFT:" << m_id << "] Error: Chunked compression is only supported for trace files, not for pipes.\n";
+         return false;
+      }
+      m_ringstream = new izringstream(input, true);
+      input = m_ringstream;
+      hdr.options &= ~CompressionChunked;
+#else
+      std::cerr << "[SIFT:" << m_id << "] Error: Chunked compression is not supported in this build.\n";
+      return false;
+#endif
    }
 #else
    if (hdr.options & CompressionZlib)
@@ -184,6 +313,23 @@ bool Sift::Reader::initResponse()
    return true;
 }
 
+// Uncompressed records in memory are read with an inlined copy, bypassing the virtual vistream interface
+inline void Sift::Reader::readInput(char *s, std::streamsize n)
+{
+   if (input == m_bufferstream)
+      m_bufferstream->read(s, n);
+   else
+      input->read(s, n);
+}
+
+inline int Sift::Reader::peekInput()
+{
+   if (input == m_bufferstream)
+      return m_bufferstream->peek();
+   else
+      return input->peek();
+}
+
 bool Sift::Reader::Read(Instruction &inst)
 {
    if (input == NULL)
@@ -197,10 +343,15 @@ bool Sift::Reader::Read(Instruction &inst)
 
    while(!m_seen_end)
    {
+      if (m_aborted)
+         return false;
+
       Record rec;
-      uint8_t byte = input->peek();
+      uint8_t byte = peekInput();
       if (input->fail())
       {
+         if (m_aborted)
+            return false;
          std::cerr << "[SIFT:" << m_id << "] Error: " << strerror(errno) << "\n";
          return false;
       }
@@ -208,7 +359,7 @@ bool Sift::Reader::Read(Instruction &inst)
       if (byte == 0)
       {
          // Other
-         input->read(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
+         readInput(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
          switch(rec.Other.type)
          {
             case RecOtherEnd:
@@ -222,9 +373,32 @@ bool Sift::Reader::Read(Instruction &inst)
                assert(rec.Other.size == sizeof(uint64_t) + ICACHE_SIZE);
                uint64_t address;
                uint8_t *bytes = new uint8_t[ICACHE_SIZE];
-               input->read(reinterpret_cast<char*>(&address), sizeof(uint64_t));
-               input->read(reinterpret_cast<char*>(bytes), ICACHE_SIZE);
+               readInput(reinterpret_cast<char*>(&address), sizeof(uint64_t));
+               readInput(reinterpret_cast<char*>(bytes), ICACHE_SIZE);
                icache[address] = bytes;
+               if (m_index)
+                  m_index->Code(address, bytes, ICACHE_SIZE);
+               break;
+            }
+            case RecOtherIcacheRef:
+            {
+               assert(rec.Other.size == sizeof(uint64_t) + sizeof(CodeStoreHash));
+               uint64_t address;
+               CodeStoreHash hash;
+               readInput(reinterpret_cast<char*>(&address), sizeof(uint64_t));
+               readInput(reinterpret_cast<char*>(&hash), sizeof(CodeStoreHash));
+               uint8_t *bytes = new uint8_t[ICACHE_SIZE];
+               if (!m_code_store || !m_code_store->Get(hash, bytes))
+               {
+                  std::cerr << "[SIFT:" << m_id << "] Error: Code page " << std::hex << address << std::dec << " is not in the code store\n";
+                  delete [] bytes;
+                  return false;
+               }
+               if (icache.count(address))
+                  delete [] icache[address];
+               icache[address] = bytes;
+               if (m_index)
+                  m_index->Code(address, bytes, ICACHE_SIZE);
                break;
             }
             case RecOtherIcacheVariable:
@@ -235,7 +409,7 @@ bool Sift::Reader::Read(Instruction &inst)
                #endif
                uint64_t address;
                size_t size = rec.Other.size - sizeof(uint64_t);
-               input->read(reinterpret_cast<char*>(&address), sizeof(uint64_t));
+               readInput(reinterpret_cast<char*>(&address), sizeof(uint64_t));
                size_t size_left = size;
                while (size_left > 0)
                {
@@ -244,7 +418,9 @@ bool Sift::Reader::Read(Instruction &inst)
                      icache[base_addr] = new uint8_t[ICACHE_SIZE];
                   uint64_t offset = address & ICACHE_OFFSET_MASK;
                   size_t read_amount = std::min(size_left, size_t(ICACHE_SIZE - offset));
-                  input->read(const_cast<char*>(reinterpret_cast<const char*>(&(icache[base_addr][offset]))), read_amount);
+                  readInput(const_cast<char*>(reinterpret_cast<const char*>(&(icache[base_addr][offset]))), read_amount);
+                  if (m_index)
+                     m_index->Code(address, &(icache[base_addr][offset]), read_amount);
 
                   #if VERBOSE_ICACHE
                   std::cerr << __FUNCTION__ << ": Wrote " << read_amount << " bytes to 0x" << std::hex << (void*)&(icache[base_addr][offset]) << std::dec << std::endl;
@@ -260,9 +436,11 @@ bool Sift::Reader::Read(Instruction &inst)
             {
                assert(rec.Other.size == 2 * sizeof(uint64_t));
                uint64_t vp, pp;
-               input->read(reinterpret_cast<char*>(&vp), sizeof(uint64_t));
-               input->read(reinterpret_cast<char*>(&pp), sizeof(uint64_t));
+               readInput(reinterpret_cast<char*>(&vp), sizeof(uint64_t));
+               readInput(reinterpret_cast<char*>(&pp), sizeof(uint64_t));
                vcache[vp] = pp;
+               if (m_index)
+                  m_index->Mapping(vp, pp);
                break;
             }
             case RecOtherInstructionCount:
@@ -272,7 +450,7 @@ bool Sift::Reader::Read(Instruction &inst)
                #endif
                assert(rec.Other.size == sizeof(uint32_t));
                uint32_t icount;
-               input->read(reinterpret_cast<char*>(&icount), sizeof(icount));
+               readInput(reinterpret_cast<char*>(&icount), sizeof(icount));
                Mode mode = ModeUnknown;
                if (handleInstructionCountFunc)
                   mode = handleInstructionCountFunc(handleInstructionCountArg, icount);
@@ -287,10 +465,10 @@ bool Sift::Reader::Read(Instruction &inst)
                assert(rec.Other.size == sizeof(uint8_t) + sizeof(uint8_t) + sizeof(uint64_t) + sizeof(uint64_t));
                uint8_t icount, type;
                uint64_t eip, address;
-               input->read(reinterpret_cast<char*>(&icount), sizeof(uint8_t));
-               input->read(reinterpret_cast<char*>(&type), sizeof(uint8_t));
-               input->read(reinterpret_cast<char*>(&eip), sizeof(uint64_t));
-               input->read(reinterpret_cast<char*>(&address), sizeof(uint64_t));
+               readInput(reinterpret_cast<char*>(&icount), sizeof(uint8_t));
+               readInput(reinterpret_cast<char*>(&type), sizeof(uint8_t));
+               readInput(reinterpret_cast<char*>(&eip), sizeof(uint64_t));
+               readInput(reinterpret_cast<char*>(&address), sizeof(uint64_t));
                if (handleCacheOnlyFunc)
                   handleCacheOnlyFunc(handleCacheOnlyArg, icount, (Sift::CacheOnlyType)type, eip, address);
                break;
@@ -304,8 +482,8 @@ bool Sift::Reader::Read(Instruction &inst)
                uint8_t fd;
                uint32_t size = rec.Other.size - sizeof(uint8_t);
                uint8_t *bytes = new uint8_t[size];
-               input->read(reinterpret_cast<char*>(&fd), sizeof(uint8_t));
-               input->read(reinterpret_cast<char*>(bytes), size);
+               readInput(reinterpret_cast<char*>(&fd), sizeof(uint8_t));
+               readInput(reinterpret_cast<char*>(bytes), size);
                if (handleOutputFunc)
                   handleOutputFunc(handleOutputArg, fd, bytes, size);
                delete [] bytes;
@@ -320,8 +498,8 @@ bool Sift::Reader::Read(Instruction &inst)
                uint16_t syscall_number;
                uint32_t size = rec.Other.size - sizeof(uint16_t);
                uint8_t *bytes = new uint8_t[size];
-               input->read(reinterpret_cast<char*>(&syscall_number), sizeof(uint16_t));
-               input->read(reinterpret_cast<char*>(bytes), size);
+               readInput(reinterpret_cast<char*>(&syscall_number), sizeof(uint16_t));
+               readInput(reinterpret_cast<char*>(bytes), size);
                #if VERBOSE_HEX > 0
                hexdump((char*)&rec, sizeof(rec.Other));
                hexdump((char*)&syscall_number, sizeof(syscall_number));
@@ -367,7 +545,7 @@ bool Sift::Reader::Read(Instruction &inst)
             {
                int32_t thread;
                assert(rec.Other.size == sizeof(thread));
-               input->read(reinterpret_cast<char*>(&thread), sizeof(thread));
+               readInput(reinterpret_cast<char*>(&thread), sizeof(thread));
                assert(handleJoinFunc);
                if (handleJoinFunc)
                {
@@ -412,9 +590,9 @@ bool Sift::Reader::Read(Instruction &inst)
             {
                assert(rec.Other.size == 3 * sizeof(uint64_t));
                uint64_t a, b, c;
-               input->read(reinterpret_cast<char*>(&a), sizeof(uint64_t));
-               input->read(reinterpret_cast<char*>(&b), sizeof(uint64_t));
-               input->read(reinterpret_cast<char*>(&c), sizeof(uint64_t));
+               readInput(reinterpret_cast<char*>(&a), sizeof(uint64_t));
+               readInput(reinterpret_cast<char*>(&b), sizeof(uint64_t));
+               readInput(reinterpret_cast<char*>(&c), sizeof(uint64_t));
                uint64_t result;
                if (handleMagicFunc)
                {
@@ -431,8 +609,8 @@ bool Sift::Reader::Read(Instruction &inst)
             {
                assert(rec.Other.size <= sizeof(uint16_t) + sizeof(EmuRequest));
                uint16_t type; EmuRequest req;
-               input->read(reinterpret_cast<char*>(&type), sizeof(uint16_t));
-               input->read(reinterpret_cast<char*>(&req), rec.Other.size - sizeof(uint16_t));
+               readInput(reinterpret_cast<char*>(&type), sizeof(uint16_t));
+               readInput(reinterpret_cast<char*>(&req), rec.Other.size - sizeof(uint16_t));
                bool result = false; EmuReply res = {};
                if (handleEmuFunc)
                {
@@ -446,10 +624,10 @@ bool Sift::Reader::Read(Instruction &inst)
                assert(rec.Other.size == sizeof(uint8_t) + 3 * sizeof(uint64_t));
                uint8_t event;
                uint64_t eip, esp, callEip;
-               input->read(reinterpret_cast<char*>(&event), sizeof(uint8_t));
-               input->read(reinterpret_cast<char*>(&eip), sizeof(uint64_t));
-               input->read(reinterpret_cast<char*>(&esp), sizeof(uint64_t));
-               input->read(reinterpret_cast<char*>(&callEip), sizeof(uint64_t));
+               readInput(reinterpret_cast<char*>(&event), sizeof(uint8_t));
+               readInput(reinterpret_cast<char*>(&eip), sizeof(uint64_t));
+               readInput(reinterpret_cast<char*>(&esp), sizeof(uint64_t));
+               readInput(reinterpret_cast<char*>(&callEip), sizeof(uint64_t));
                if (handleRoutineChangeFunc)
                   handleRoutineChangeFunc(handleRoutineArg, Sift::RoutineOpType(event), eip, esp, callEip);
                break;
@@ -460,19 +638,19 @@ bool Sift::Reader::Read(Instruction &inst)
                uint16_t len_name, len_imgname, len_filename;
                char *name, *imgname, *filename;
                uint32_t line, column;
-               input->read(reinterpret_cast<char*>(&eip), sizeof(uint64_t));
-               input->read(reinterpret_cast<char*>(&len_name), sizeof(uint16_t));
+               readInput(reinterpret_cast<char*>(&eip), sizeof(uint64_t));
+               readInput(reinterpret_cast<char*>(&len_name), sizeof(uint16_t));
                name = (char*)malloc(len_name);
-               input->read(name, len_name);
-               input->read(reinterpret_cast<char*>(&len_imgname), sizeof(uint16_t));
+               readInput(name, len_name);
+               readInput(reinterpret_cast<char*>(&len_imgname), sizeof(uint16_t));
                imgname = (char*)malloc(len_imgname);
-               input->read(imgname, len_imgname);
-               input->read(reinterpret_cast<char*>(&offset), sizeof(uint64_t));
-               input->read(reinterpret_cast<char*>(&line), sizeof(uint32_t));
-               input->read(reinterpret_cast<char*>(&column), sizeof(uint32_t));
-               input->read(reinterpret_cast<char*>(&len_filename), sizeof(uint16_t));
+               readInput(imgname, len_imgname);
+               readInput(reinterpret_cast<char*>(&offset), sizeof(uint64_t));
+               readInput(reinterpret_cast<char*>(&line), sizeof(uint32_t));
+               readInput(reinterpret_cast<char*>(&column), sizeof(uint32_t));
+               readInput(reinterpret_cast<char*>(&len_filename), sizeof(uint16_t));
                filename = (char*)malloc(len_filename);
-               input->read(filename, len_filename);
+               readInput(filename, len_filename);
                if (handleRoutineAnnounceFunc)
                   handleRoutineAnnounceFunc(handleRoutineArg, eip, name, imgname, offset, line, column, filename);
                free(name);
@@ -483,7 +661,7 @@ bool Sift::Reader::Read(Instruction &inst)
             { 
                assert(rec.Other.size == sizeof(uint32_t));
                uint32_t new_isa;
-               input->read(reinterpret_cast<char*>(&new_isa), sizeof(new_isa));
+               readInput(reinterpret_cast<char*>(&new_isa), sizeof(new_isa));
                m_isa = new_isa; // save here new ISA mode value
 
                break;
@@ -491,7 +669,7 @@ bool Sift::Reader::Read(Instruction &inst)
             default:
             {
                uint8_t *bytes = new uint8_t[rec.Other.size];
-               input->read(reinterpret_cast<char*>(bytes), rec.Other.size);
+               readInput(reinterpret_cast<char*>(bytes), rec.Other.size);
                delete [] bytes;
                break;
             }
@@ -505,7 +683,7 @@ bool Sift::Reader::Read(Instruction &inst)
       if ((byte & 0xf) != 0)
       {
          // Instruction
-         input->read(reinterpret_cast<char*>(&rec), sizeof(rec.Instruction));
+         readInput(reinterpret_cast<char*>(&rec), sizeof(rec.Instruction));
 
          #if VERBOSE_HEX > 2
          hexdump(&rec, sizeof(rec.Instruction));
@@ -523,7 +701,7 @@ bool Sift::Reader::Read(Instruction &inst)
       else
       {
          // InstructionExt
-         input->read(reinterpret_cast<char*>(&rec), sizeof(rec.InstructionExt));
+         readInput(reinterpret_cast<char*>(&rec), sizeof(rec.InstructionExt));
 
          #if VERBOSE_HEX > 2
          hexdump(&rec, sizeof(rec.InstructionExt));
@@ -544,10 +722,14 @@ bool Sift::Reader::Read(Instruction &inst)
       last_address += size;
 
       for(int i = 0; i < inst.num_addresses; ++i)
-         input->read(reinterpret_cast<char*>(&inst.addresses[i]), sizeof(uint64_t));
+         readInput(reinterpret_cast<char*>(&inst.addresses[i]), sizeof(uint64_t));
 
       inst.sinst = getStaticInstruction(addr, size);
 
+      ++m_icount;
+      if (m_index && m_index->isDue(m_icount))
+         m_index->Checkpoint(m_icount, getRecordOffset(), last_address, m_isa);
+
       #if VERBOSE_HEX > 2
       hexdump(inst.sinst->data, inst.sinst->size);
       #endif
@@ -611,7 +793,7 @@ bool Sift::Reader::AccessMemory(MemoryLockType lock_signal, MemoryOpType mem_op,
    #endif
    uint64_t addr;
    MemoryOpType type;
-   input->read(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
+   readInput(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
    #if VERBOSE_HEX > 0
    hexdump((char*)&rec, sizeof(rec.Other));
    #endif
@@ -620,8 +802,8 @@ bool Sift::Reader::AccessMemory(MemoryLockType lock_signal, MemoryOpType mem_op,
       std::cerr << "[SIFT:" << m_id << "] Error: Invalid response. Expected RecOtherMemoryResponse\n";
       return false;
    }
-   input->read(reinterpret_cast<char*>(&addr), sizeof(addr));
-   input->read(reinterpret_cast<char*>(&type), sizeof(type));
+   readInput(reinterpret_cast<char*>(&addr), sizeof(addr));
+   readInput(reinterpret_cast<char*>(&type), sizeof(type));
    #if VERBOSE_HEX > 0
    hexdump((char*)&addr, sizeof(addr));
    hexdump((char*)&type, sizeof(type));
@@ -644,7 +826,7 @@ bool Sift::Reader::AccessMemory(MemoryLockType lock_signal, MemoryOpType mem_op,
 	 std::cerr << "[SIFT:" << m_id << "] Error: Invalid response. Expected payload size to match\n";
 	 return false;
       }
-      input->read(reinterpret_cast<char*>(data_buffer), data_size);
+      readInput(reinterpret_cast<char*>(data_buffer), data_size);
       #if VERBOSE_HEX > 0
       hexdump((char*)data_buffer, data_size);
       #endif
@@ -672,6 +854,8 @@ const Sift::StaticInstruction* Sift::Reader::staticInfoInstruction(uint64_t addr
    sinst->addr = addr;
    sinst->size = size;
    sinst->next = NULL;
+   sinst->next_alt = NULL;
+   sinst->user_data = NULL;
 
    uint8_t * dst = sinst->data;
    uint64_t base_addr = addr & ICACHE_PAGE_MASK;
@@ -699,37 +883,56 @@ const Sift::StaticInstruction* Sift::Reader::getStaticInstruction(uint64_t addr,
    const StaticInstruction *sinst;
 
    // Lookup in a large unordered_map is quite expensive if we have to do this for every dynamic instruction
-   // Therefore, keep a pointer to the probable next instruction in each (static) instruction
+   // Therefore, keep pointers to the probable next instructions in each (static) instruction
    if (m_last_sinst && m_last_sinst->next && m_last_sinst->next->addr == addr)
    {
       sinst = m_last_sinst->next;
    }
-   else if (scache.count(addr))
+   else if (m_last_sinst && m_last_sinst->next_alt && m_last_sinst->next_alt->addr == addr)
    {
-      sinst = scache[addr];
-      assert(sinst->size == size);
+      sinst = m_last_sinst->next_alt;
    }
    else
    {
-      sinst = staticInfoInstruction(addr, size);
-      scache[addr] = sinst;
-   }
+      std::unordered_map<uint64_t, const StaticInstruction*>::iterator it = scache.find(addr);
+      if (it != scache.end())
+      {
+         sinst = it->second;
+         assert(sinst->size == size);
+      }
+      else
+      {
+         sinst = staticInfoInstruction(addr, size);
+         scache[addr] = sinst;
+      }
 
-   if (m_last_sinst && m_last_sinst->next == NULL)
-   {
-      ((StaticInstruction*)m_last_sinst)->next = sinst;
+      if (m_last_sinst && m_last_sinst->next == NULL)
+         ((StaticInstruction*)m_last_sinst)->next = sinst;
+      else if (m_last_sinst)
+         ((StaticInstruction*)m_last_sinst)->next_alt = sinst;
    }
+
    m_last_sinst = sinst;
 
    return sinst;
 }
 
+void Sift::Reader::Abort()
+{
+   m_aborted = true;
+   if (m_pipestream)
+      m_pipestream->abort();
+}
+
 void Sift::Reader::sendSyscallResponse(uint64_t return_code)
 {
    #if VERBOSE > 0
    std::cerr << "[DEBUG:" << m_id << "] Write SyscallResponse" << std::endl;
    #endif
 
+   if (m_aborted)
+      return;
+
    if (!initResponse())
    {
       std::cerr << "[SIFT:" << m_id << "] Error: initResponse failed\n";
@@ -750,6 +953,9 @@ void Sift::Reader::sendEmuResponse(bool handled, EmuReply res)
    std::cerr << "[DEBUG:" << m_id << "] Write sendEmuResponse" << std::endl;
    #endif
 
+   if (m_aborted)
+      return;
+
    if (!initResponse())
    {
       std::cerr << "[SIFT:" << m_id << "] Error: initResponse failed\n";
@@ -772,6 +978,9 @@ void Sift::Reader::sendSimpleResponse(RecOtherType type, void *data, uint32_t si
    std::cerr << "[DEBUG:" << m_id << "] Write SimpleResponse type=" << type << std::endl;
    #endif
 
+   if (m_aborted)
+      return;
+
    if (!initResponse())
    {
       std::cerr << "[SIFT:" << m_id << "] Error: initResponse failed\n";
@@ -789,10 +998,198 @@ void Sift::Reader::sendSimpleResponse(RecOtherType type, void *data, uint32_t si
    response->flush();
 }
 
+uint64_t Sift::Reader::getRecordOffset()
+{
+#if SIFT_USE_FAST_READER && SIFT_USE_ZLIB
+   if (m_ringstream)
+      return m_record_base + m_ringstream->tellUncompressed();
+#endif
+   if (input == m_bufferstream)
+      return m_bufferstream->tell() - m_header_size;
+   else if (inputstream)
+      return uint64_t(inputstream->tellg()) - m_header_size;
+   else
+      return 0;
+}
+
+bool Sift::Reader::seekRecord(uint64_t offset)
+{
+#if SIFT_USE_FAST_READER && SIFT_USE_ZLIB
+   if (m_ringstream)
+   {
+      // Chunked trace: find the chunk holding this offset through the chunk index at the end of the file,
+      // restart decompression at that chunk and skip to the offset within it
+      ChunkTrailer trailer;
+      if (!m_buffer || m_buffer_size < m_header_size + sizeof(trailer))
+         return false;
+      memcpy(&trailer, m_buffer + m_buffer_size - sizeof(trailer), sizeof(trailer));
+      if (trailer.magic != ChunkMagic || trailer.num_chunks == 0
+         || trailer.index_offset + sizeof(ChunkHeader) + trailer.num_chunks * sizeof(ChunkIndexEntry) > m_buffer_size)
+      {
+         std::cerr << "[SIFT:" << m_id << "] Error: Invalid chunk index\n";
+         return false;
+      }
+      const ChunkIndexEntry *chunks = reinterpret_cast<const ChunkIndexEntry*>(m_buffer + trailer.index_offset + sizeof(ChunkHeader));
+
+      uint32_t lo = 0, hi = trailer.num_chunks;
+      while (hi - lo > 1)
+      {
+         uint32_t mid = (lo + hi) / 2;
+         if (chunks[mid].uncompressed_offset <= offset)
+            lo = mid;
+         else
+            hi = mid;
+      }
+
+      delete m_ringstream; // Also deletes m_bufferstream
+      m_bufferstream = new vimstream(m_buffer, m_buffer_size);
+      m_bufferstream->seek(chunks[lo].offset);
+      m_ringstream = new izringstream(m_bufferstream, true);
+      input = m_ringstream;
+      m_ringstream_base = chunks[lo].offset;
+      m_record_base = chunks[lo].uncompressed_offset;
+
+      char skip[4096];
+      for(uint64_t left = offset - m_record_base ; left > 0 && !input->fail() ; )
+      {
+         uint64_t amount = std::min(left, uint64_t(sizeof(skip)));
+         input->read(skip, amount);
+         left -= amount;
+      }
+      return !input->fail();
+   }
+#endif
+   if (input == m_bufferstream)
+   {
+      if (m_header_size + offset > m_buffer_size)
+         return false;
+      m_bufferstream->seek(m_header_size + offset);
+      return true;
+   }
+   else if (inputstream)
+   {
+      inputstream->seekg(m_header_size + offset);
+      return !inputstream->fail();
+   }
+   else
+      return false;
+}
+
+bool Sift::Reader::Seek(uint64_t icount, const char *index_filename)
+{
+   if (input == NULL)
+   {
+      if (!initStream())
+      {
+         std::cerr << "[SIFT:" << m_id << "] Error: initStream failed\n";
+         return false;
+      }
+   }
+
+   if (!m_indexable || m_icount != 0 || m_index)
+   {
+      std::cerr << "[SIFT:" << m_id << "] Error: Cannot seek in this trace\n";
+      return false;
+   }
+
+   std::string filename = index_filename ? index_filename : std::string(m_filename) + ".idx";
+   std::ifstream index(filename.c_str(), std::ios::in | std::ios::binary);
+   IndexHeader hdr;
+   index.read(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+   if (index.fail() || hdr.magic != IndexMagic)
+   {
+      std::cerr << "[SIFT:" << m_id << "] Error: Cannot read trace index " << filename << "\n";
+      return false;
+   }
+
+   // Each entry holds the pages and mappings added since the previous one: apply all of them up to the last usable entry
+   IndexEntry entry, target = {};
+   while (index.read(reinterpret_cast<char*>(&entry), sizeof(entry)) && entry.icount <= icount)
+   {
+      for(uint32_t i = 0 ; i < entry.num_pages ; ++i)
+      {
+         uint64_t address;
+         index.read(reinterpret_cast<char*>(&address), sizeof(uint64_t));
+         if (icache.count(address) == 0)
+            icache[address] = new uint8_t[ICACHE_SIZE];
+         index.read(const_cast<char*>(reinterpret_cast<const char*>(icache[address])), ICACHE_SIZE);
+      }
+      for(uint32_t i = 0 ; i < entry.num_mappings ; ++i)
+      {
+         uint64_t vp, pp;
+         index.read(reinterpret_cast<char*>(&vp), sizeof(uint64_t));
+         index.read(reinterpret_cast<char*>(&pp), sizeof(uint64_t));
+         vcache[vp] = pp;
+      }
+      if (index.fail())
+      {
+         std::cerr << "[SIFT:" << m_id << "] Error: Trace index " << filename << " is truncated\n";
+         return false;
+      }
+      target = entry;
+   }
+
+   if (target.icount == 0)
+   {
+      // Before the first checkpoint, start at the beginning of the trace
+      return true;
+   }
+
+   if (!seekRecord(target.offset))
+   {
+      std::cerr << "[SIFT:" << m_id << "] Error: Cannot seek to offset " << target.offset << "\n";
+      return false;
+   }
+
+   // Simple instructions are encoded relative to the previous one
+   last_address = target.last_address;
+   m_isa = target.isa;
+   m_icount = target.icount;
+   m_last_sinst = NULL;
+
+   return true;
+}
+
+bool Sift::Reader::setIndex(const char *index_filename, uint64_t interval)
+{
+   if (input == NULL)
+   {
+      if (!initStream())
+      {
+         std::cerr << "[SIFT:" << m_id << "] Error: initStream failed\n";
+         return false;
+      }
+   }
+
+   if (!m_indexable || m_icount != 0 || m_index || interval == 0)
+   {
+      std::cerr << "[SIFT:" << m_id << "] Error: Cannot index this trace, use an uncompressed or chunked trace\n";
+      return false;
+   }
+
+   m_index = new IndexWriter(index_filename, interval);
+   if (!m_index->IsOpen())
+   {
+      std::cerr << "[SIFT:" << m_id << "] Error: Cannot open " << index_filename << "\n";
+      delete m_index;
+      m_index = NULL;
+      return false;
+   }
+   return true;
+}
+
 uint64_t Sift::Reader::getPosition()
 {
    if (inputstream)
       return inputstream->tellg();
+   else if (m_pipestream)
+      return m_pipestream->tell();
+#if SIFT_USE_FAST_READER && SIFT_USE_ZLIB
+   else if (m_ringstream)
+      return m_ringstream_base + m_ringstream->tell();
+#endif
+   else if (m_bufferstream)
+      return m_bufferstream->tell();
    else
       return 0;
 }
@@ -11,10 +11,16 @@
 #include <unordered_map>
 #include <fstream>
 #include <cassert>
+#include <atomic>
 
 class vistream;
+class vimstream;
+class vifdstream;
+class izringstream;
 class vostream;
 
+namespace Sift { class IndexWriter; class CodeStore; }
+
 namespace Sift
 {
    // Static information
@@ -27,7 +33,9 @@ namespace Sift
          uint8_t size;
          uint8_t data[16];
          //xed_decoded_inst_t xed_inst;
-         const StaticInstruction *next;
+         const StaticInstruction *next;      //< First successor seen
+         const StaticInstruction *next_alt;  //< Most recent other successor (e.g. the other side of a branch)
+         mutable void *user_data;            //< Owned by the client, e.g. to attach its decoded version of this instruction
    };
 
    // Dynamic information
@@ -83,6 +91,19 @@ namespace Sift
          void *handleRoutineArg;
          uint64_t filesize;
          std::ifstream *inputstream;
+         vifdstream *m_pipestream;       // Set when reading from a pipe, so Abort() can interrupt a read that waits for the recorder
+         const uint8_t *m_buffer;        // Shared, read-only trace image to read from instead of m_filename (not owned)
+         uint64_t m_buffer_size;
+         vimstream *m_bufferstream;      // Set when reading from m_buffer; uncompressed records are then decoded straight from memory
+         bool m_mapped;                  // m_buffer is our own mmap of m_filename
+         izringstream *m_ringstream;     // Background decompression of m_buffer
+         uint64_t m_ringstream_base;     // File offset at which m_ringstream started reading
+         uint64_t m_record_base;         // Record stream offset at which m_ringstream started decompressing
+         bool m_indexable;               // Records can be located in the input (i.e., not a single zlib stream)
+         uint64_t m_icount;              // Instructions read so far (including those skipped by Seek)
+         IndexWriter *m_index;
+         uint64_t m_header_size;         // Header plus extra header, records start at this file offset
+         CodeStore *m_code_store;        // Resolves RecOtherIcacheRef records
 
          char *m_filename;
          char *m_response_filename;
@@ -99,11 +120,17 @@ namespace Sift
 
          bool m_trace_has_pa;
          bool m_seen_end;
+         std::atomic<bool> m_aborted;
          const StaticInstruction *m_last_sinst;
          
          int m_isa;
 
          bool initResponse();
+         bool mapFile();
+         void readInput(char *s, std::streamsize n);
+         int peekInput();
+         uint64_t getRecordOffset();
+         bool seekRecord(uint64_t offset);
          const Sift::StaticInstruction* staticInfoInstruction(uint64_t addr, uint8_t size);
          const Sift::StaticInstruction* getStaticInstruction(uint64_t addr, uint8_t size);
          void sendSyscallResponse(uint64_t return_code);
@@ -111,7 +138,7 @@ namespace Sift
          void sendSimpleResponse(RecOtherType type, void *data = NULL, uint32_t size = 0);
 
       public:
-         Reader(const char *filename, const char *response_filename = "", uint32_t id = 0);
+         Reader(const char *filename, const char *response_filename = "", uint32_t id = 0, const uint8_t *buffer = NULL, uint64_t buffer_size = 0);
          ~Reader();
          bool initStream();
          bool Read(Instruction&);
@@ -128,9 +155,21 @@ namespace Sift
          void setHandleRoutineFunc(HandleRoutineChange funcChange, HandleRoutineAnnounce funcAnnounce, void* arg = NULL) { assert(funcChange); assert(funcAnnounce); handleRoutineChangeFunc = funcChange; handleRoutineAnnounceFunc = funcAnnounce; handleRoutineArg = arg; }
          void setHandleForkFunc(HandleForkFunc func, void* arg = NULL) { assert(func); handleForkFunc = func; handleForkArg = arg;}
 
+         // Skip to the last checkpoint in the trace index (default: <filename>.idx) at or before instruction icount,
+         // without decoding the records before it. Only possible before the first instruction is read.
+         bool Seek(uint64_t icount, const char *index_filename = NULL);
+         // Write a trace index while reading (see Sift::IndexHeader)
+         bool setIndex(const char *index_filename, uint64_t interval);
+
          uint64_t getPosition();
          uint64_t getLength();
+         uint64_t getInstructionCount() const { return m_icount; }
          bool getTraceHasPhysicalAddresses() const { return m_trace_has_pa; }
+         // Whether the end-of-trace record was read, i.e. the trace was not cut short
+         bool getSeenEnd() const { return m_seen_end; }
+         // Stop reading, from any thread: a Read() waiting for input from a pipe returns false, and no more responses
+         // are sent, so callbacks interrupted by the abort do not answer the recorder with made-up values
+         void Abort();
          uint64_t va2pa(uint64_t va);
    };
 };
@@ -3,6 +3,8 @@
 #include "sift_format.h"
 #include "sift_utils.h"
 #include "sift_assert.h"
+#include "sift_index.h"
+#include "sift_codestore.h"
 #include "zfstream.h"
 
 #include <cstdlib>
@@ -35,7 +37,14 @@ __sift_assert_fail(__const char *__assertion, __const char *__file,
 }
 
 
-Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useCompression, const char *response_filename, uint32_t id, bool arch32, bool requires_icache_per_insn, bool send_va2pa_mapping, GetCodeFunc2 getCodeFunc2, void* getCodeFunc2Data)
+// Modified from http://stackoverflow.com/questions/2203159/is-there-a-c-equivalent-to-getcwd
+String get_working_path()
+{
+   char temp[MAXPATHLEN];
+   return ( getcwd(temp, MAXPATHLEN) ? String( temp ) : String("") );
+}
+
+Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useCompression, const char *response_filename, uint32_t id, bool arch32, bool requires_icache_per_insn, bool send_va2pa_mapping, GetCodeFunc2 getCodeFunc2, void* getCodeFunc2Data, int chunk_compression_level, const char *code_store_filename)
    : response(NULL)
    , getCodeFunc(getCodeFunc)
    , getCodeFunc2(getCodeFunc2)
@@ -47,11 +56,17 @@ Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useComp
    , ninstrext(0)
    , last_address(0)
    , icache()
+   , m_last_icache_page(1)    // Not page aligned, never matches
    , fd_va(-1)
    , m_va2pa()
    , m_id(id)
    , m_requires_icache_per_insn(requires_icache_per_insn)
    , m_send_va2pa_mapping(send_va2pa_mapping)
+   , m_isa(0)
+   , m_can_index(false)
+   , m_index(NULL)
+   , m_index_base(0)
+   , m_code_store(NULL)
 {
    memset(hsize, 0, sizeof(hsize));
    memset(haddr, 0, sizeof(haddr));
@@ -60,8 +75,9 @@ Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useComp
 
    uint64_t options = 0;
 #if SIFT_USE_ZLIB
+   // A chunk compression level (1-9) selects the chunked, seekable container instead of a single zlib stream
    if (useCompression)
-      options |= CompressionZlib;
+      options |= chunk_compression_level > 0 ? CompressionChunked : CompressionZlib;
 #else
    if (useCompression) {
       std::cerr << "[SIFT:" << m_id << "] Warning: Compression disabled, ignoring request.\n";
@@ -74,7 +90,24 @@ Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useComp
    if (m_send_va2pa_mapping)
       options |= PhysicalAddress;
 
-   output = new vofstream(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+   // The reader finds the code store through the path in the extra header, make it independent of our working directory
+   String code_store_path;
+   if (code_store_filename && !requires_icache_per_insn)
+   {
+      code_store_path = code_store_filename[0] == '/' ? String(code_store_filename) : get_working_path() + "/" + code_store_filename;
+      m_code_store = new CodeStore(code_store_path.c_str(), true);
+      if (m_code_store->IsOpen())
+         options |= IcacheStore;
+      else
+      {
+         std::cerr << "[SIFT:" << m_id << "] Warning: Cannot open code store " << code_store_path << ", storing code in the trace.\n";
+         delete m_code_store;
+         m_code_store = NULL;
+         code_store_path = "";
+      }
+   }
+
+   output = new vofdstream(filename);
 
    if (!output->is_open())
    {
@@ -87,19 +120,18 @@ Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useComp
    std::cerr << "[DEBUG:" << m_id << "] Write Header" << std::endl;
    #endif
 
-   Sift::Header hdr = { Sift::MagicNumber, 0 /* header size */, options, {}};
+   Sift::Header hdr = { Sift::MagicNumber, uint32_t(code_store_path.size()) /* header size */, options, {}};
    output->write(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+   output->write(code_store_path.c_str(), code_store_path.size());
    output->flush();
 
    if (options & CompressionZlib)
       output = new ozstream(output);
-}
+   else if (options & CompressionChunked)
+      output = new ozchunkstream(output, chunk_compression_level, sizeof(hdr) + hdr.size);
 
-// Modified from http://stackoverflow.com/questions/2203159/is-there-a-c-equivalent-to-getcwd
-String get_working_path()
-{
-   char temp[MAXPATHLEN];
-   return ( getcwd(temp, MAXPATHLEN) ? String( temp ) : String("") );
+   m_can_index = !(options & CompressionZlib);
+   m_index_base = output->tell();
 }
 
 void Sift::Writer::initResponse()
@@ -150,6 +182,18 @@ void Sift::Writer::End()
       delete output;
       output = NULL;
    }
+
+   if (m_index)
+   {
+      delete m_index;
+      m_index = NULL;
+   }
+
+   if (m_code_store)
+   {
+      delete m_code_store;
+      m_code_store = NULL;
+   }
 }
 
 Sift::Writer::~Writer()
@@ -180,6 +224,8 @@ void Sift::Writer::Instruction(uint64_t addr, uint8_t size, uint8_t num_addresse
       return;
    }
 
+   output->recordBoundary();
+
    if (m_requires_icache_per_insn)
    {
       if (! icache[addr])
@@ -201,6 +247,8 @@ void Sift::Writer::Instruction(uint64_t addr, uint8_t size, uint8_t num_addresse
             getCodeFunc(buffer, reinterpret_cast<const uint8_t *>(addr), size);
          }
          output->write(reinterpret_cast<char*>(buffer), size);
+         if (m_index)
+            m_index->Code(addr, buffer, size);
 
          #if VERBOSE_ICACHE
          hexdump((char*)buffer, sizeof(buffer));
@@ -209,7 +257,7 @@ void Sift::Writer::Instruction(uint64_t addr, uint8_t size, uint8_t num_addresse
          icache[addr] = true;
       }
    }
-   else
+   else if ((addr & ICACHE_PAGE_MASK) != m_last_icache_page || ((addr + size - 1) & ICACHE_PAGE_MASK) != m_last_icache_page)
    {
       // Send ICACHE record?
       for(uint64_t base_addr = addr & ICACHE_PAGE_MASK; base_addr <= ((addr + size - 1) & ICACHE_PAGE_MASK); base_addr += ICACHE_SIZE)
@@ -219,33 +267,67 @@ void Sift::Writer::Instruction(uint64_t addr, uint8_t size, uint8_t num_addresse
             #if VERBOSE > 2
             std::cerr << "[DEBUG:" << m_id << "] Write icache" << std::endl;
             #endif
-            Record rec;
-            rec.Other.zero = 0;
-            rec.Other.type = RecOtherIcache;
-            rec.Other.size = sizeof(uint64_t) + ICACHE_SIZE;
-            output->write(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
-            output->write(reinterpret_cast<char*>(&base_addr), sizeof(uint64_t));
-
             uint8_t buffer[ICACHE_SIZE];
             if (getCodeFunc2) {
                getCodeFunc2(buffer, (const uint8_t *)base_addr, ICACHE_SIZE, getCodeFunc2Data);
             } else {
                getCodeFunc(buffer, (const uint8_t *)base_addr, ICACHE_SIZE);
             }
-            output->write(reinterpret_cast<char*>(buffer), ICACHE_SIZE);
+
+            Record rec;
+            rec.Other.zero = 0;
+            CodeStoreHash hash;
+            bool in_store = false;
+            if (m_code_store)
+            {
+               hash = CodeStore::Hash(buffer);
+               in_store = m_code_store->Add(hash, buffer);
+            }
+
+            if (in_store)
+            {
+               // Page is already in the code store, only send its hash
+               rec.Other.type = RecOtherIcacheRef;
+               rec.Other.size = sizeof(uint64_t) + sizeof(hash);
+               output->write(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
+               output->write(reinterpret_cast<char*>(&base_addr), sizeof(uint64_t));
+               output->write(reinterpret_cast<char*>(&hash), sizeof(hash));
+            }
+            else
+            {
+               rec.Other.type = RecOtherIcache;
+               rec.Other.size = sizeof(uint64_t) + ICACHE_SIZE;
+               output->write(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
+               output->write(reinterpret_cast<char*>(&base_addr), sizeof(uint64_t));
+               output->write(reinterpret_cast<char*>(buffer), ICACHE_SIZE);
+            }
+            if (m_index)
+               m_index->Code(base_addr, buffer, ICACHE_SIZE);
 
             icache[base_addr] = true;
          }
       }
+      m_last_icache_page = (addr + size - 1) & ICACHE_PAGE_MASK;
    }
 
    #if VERBOSE > 2
    printf("%016lx (%d) A%u %c%c %c%c\n", addr, size, num_addresses, is_branch?'B':'.', is_branch?(taken?'T':'.'):'.', is_predicate?'C':'.', is_predicate?(executed?'E':'n'):'.');
    #endif
 
-   send_va2pa(addr);
-   for(int i = 0; i < num_addresses; ++i)
-      send_va2pa(addresses[i]);
+   if (m_send_va2pa_mapping)
+   {
+      send_va2pa(addr);
+      for(int i = 0; i < num_addresses; ++i)
+         send_va2pa(addresses[i]);
+   }
+
+   // Encode the record and its addresses in one go, such that the output stream sees a single write per instruction
+   union
+   {
+      Record rec;
+      uint8_t bytes[sizeof(Record) + MAX_DYNAMIC_ADDRESSES * sizeof(uint64_t)];
+   } buffer;
+   size_t length;
 
    // Try as simple instruction
    if (addr == last_address && !is_predicate)
@@ -254,12 +336,12 @@ void Sift::Writer::Instruction(uint64_t addr, uint8_t size, uint8_t num_addresse
       std::cerr << "[DEBUG:" << m_id << "] Write Simple Instruction" << std::endl;
       #endif
 
-      Record rec;
+      Record &rec = buffer.rec;
       rec.Instruction.size = size;
       rec.Instruction.num_addresses = num_addresses;
       rec.Instruction.is_branch = is_branch;
       rec.Instruction.taken = taken;
-      output->write(reinterpret_cast<char*>(&rec), sizeof(rec.Instruction));
+      length = sizeof(rec.Instruction);
 
       #if VERBOSE_HEX > 2
       hexdump((char*)&rec, sizeof(rec.Instruction));
@@ -274,7 +356,7 @@ void Sift::Writer::Instruction(uint64_t addr, uint8_t size, uint8_t num_addresse
       std::cerr << "[DEBUG:" << m_id << "] Write Simple Full Instruction" << std::endl;
       #endif
 
-      Record rec;
+      Record &rec = buffer.rec;
       memset(&rec, 0, sizeof(rec));
       rec.InstructionExt.type = 0;
       rec.InstructionExt.size = size;
@@ -284,7 +366,7 @@ void Sift::Writer::Instruction(uint64_t addr, uint8_t size, uint8_t num_addresse
       rec.InstructionExt.is_predicate = is_predicate;
       rec.InstructionExt.executed = executed;
       rec.InstructionExt.addr = addr;
-      output->write(reinterpret_cast<char*>(&rec), sizeof(rec.InstructionExt));
+      length = sizeof(rec.InstructionExt);
 
       #if VERBOSE_HEX > 2
       hexdump((char*)&rec, sizeof(rec.InstructionExt));
@@ -295,12 +377,15 @@ void Sift::Writer::Instruction(uint64_t addr, uint8_t size, uint8_t num_addresse
       ninstrext++;
    }
 
-   for(int i = 0; i < num_addresses; ++i)
-      output->write(reinterpret_cast<char*>(&addresses[i]), sizeof(uint64_t));
+   memcpy(buffer.bytes + length, addresses, num_addresses * sizeof(uint64_t));
+   length += num_addresses * sizeof(uint64_t);
+   output->write(reinterpret_cast<char*>(buffer.bytes), length);
 
    last_address += size;
 
    ninstrs++;
+   if (m_index && m_index->isDue(ninstrs))
+      m_index->Checkpoint(ninstrs, output->tell() - m_index_base, last_address, m_isa);
    hsize[size]++;
    haddr[num_addresses]++;
    if (is_branch)
@@ -889,6 +974,8 @@ void Sift::Writer::ISAChange(uint32_t new_isa)
 
    output->write(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
    output->write(reinterpret_cast<char*>(&new_isa), sizeof(new_isa));
+
+   m_isa = new_isa;
 }
 
 bool Sift::Writer::IsOpen()
@@ -896,6 +983,29 @@ bool Sift::Writer::IsOpen()
    return !!output;
 }
 
+bool Sift::Writer::setIndex(const char *index_filename, uint64_t interval)
+{
+   if (!output || m_index || interval == 0)
+   {
+      return false;
+   }
+   if (!m_can_index || ninstrs != 0)
+   {
+      std::cerr << "[SIFT:" << m_id << "] Warning: Cannot index this trace, use an uncompressed or chunked trace.\n";
+      return false;
+   }
+
+   m_index = new IndexWriter(index_filename, interval);
+   if (!m_index->IsOpen())
+   {
+      std::cerr << "[SIFT:" << m_id << "] Warning: Cannot open " << index_filename << "\n";
+      delete m_index;
+      m_index = NULL;
+      return false;
+   }
+   return true;
+}
+
 void Sift::Writer::handleMemoryRequest(Record &respRec)
 {
    #if VERBOSE > 0
@@ -1072,6 +1182,8 @@ void Sift::Writer::send_va2pa(uint64_t va)
             output->write(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
             output->write(reinterpret_cast<char*>(&vp), sizeof(uint64_t));
             output->write(reinterpret_cast<char*>(&pp), sizeof(uint64_t));
+            if (m_index)
+               m_index->Mapping(vp, pp);
 
             m_va2pa[vp] = true;
          }
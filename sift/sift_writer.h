@@ -11,6 +11,8 @@
 class vistream;
 class vostream;
 
+namespace Sift { class IndexWriter; class CodeStore; }
+
 namespace Sift
 {
    class Writer
@@ -31,12 +33,18 @@ namespace Sift
 
          uint64_t last_address;
          std::unordered_map<uint64_t, bool> icache;
+         uint64_t m_last_icache_page; // Most recent page found in icache, saves a lookup for most instructions
          int fd_va;
          std::unordered_map<intptr_t, bool> m_va2pa;
          char *m_response_filename;
          uint32_t m_id;
          bool m_requires_icache_per_insn;
          bool m_send_va2pa_mapping;
+         uint32_t m_isa;
+         bool m_can_index;          // Records can be located in the output (i.e., not a single zlib stream)
+         IndexWriter *m_index;
+         uint64_t m_index_base;     // output->tell() at the first record
+         CodeStore *m_code_store;   // Shared store for code pages, only the hash of pages already in there is written
 
          void initResponse();
          void handleMemoryRequest(Record &respRec);
@@ -44,7 +52,7 @@ namespace Sift
          uint64_t va2pa_lookup(uint64_t va);
 
       public:
-         Writer(const char *filename, GetCodeFunc getCodeFunc, bool useCompression = false, const char *response_filename = "", uint32_t id = 0, bool arch32 = false, bool requires_icache_per_insn = false, bool send_va2pa_mapping = false, GetCodeFunc2 getCodeFunc2 = NULL, void *GetCodeFunc2Data = NULL);
+         Writer(const char *filename, GetCodeFunc getCodeFunc, bool useCompression = false, const char *response_filename = "", uint32_t id = 0, bool arch32 = false, bool requires_icache_per_insn = false, bool send_va2pa_mapping = false, GetCodeFunc2 getCodeFunc2 = NULL, void *GetCodeFunc2Data = NULL, int chunk_compression_level = 0, const char *code_store_filename = NULL);
          ~Writer();
          void End();
          void Instruction(uint64_t addr, uint8_t size, uint8_t num_addresses, uint64_t addresses[], bool is_branch, bool taken, bool is_predicate, bool executed);
@@ -62,6 +70,8 @@ namespace Sift
          void RoutineAnnounce(uint64_t eip, const char *name, const char *imgname, uint64_t offset, uint32_t line, uint32_t column, const char *filename);
          void ISAChange(uint32_t new_isa);
          bool IsOpen();
+         // Write a trace index to index_filename while writing the trace (see Sift::IndexHeader)
+         bool setIndex(const char *index_filename, uint64_t interval);
 
          void setHandleAccessMemoryFunc(HandleAccessMemoryFunc func, void* arg = NULL) { assert(func); handleAccessMemoryFunc = func; handleAccessMemoryArg = arg; }
    };
@@ -0,0 +1,48 @@
+#define __STDC_FORMAT_MACROS
+
+#include "sift_reader.h"
+
+#include <inttypes.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// Build the trace index (<file.sift>.idx by default) of an existing uncompressed or chunked trace,
+// such that Sift::Reader::Seek can start at any checkpoint (see Sift::IndexHeader)
+
+int main(int argc, char* argv[])
+{
+   uint64_t interval = 1000000;
+   int arg = 1;
+   if (argc > 2 && strcmp(argv[1], "-i") == 0)
+   {
+      interval = strtoull(argv[2], NULL, 0);
+      arg += 2;
+   }
+
+   if (arg >= argc || interval == 0)
+   {
+      printf("Usage: %s [-i <interval>] <file.sift> [<index file>]\n", argv[0]);
+      return 1;
+   }
+
+   std::string filename = argv[arg];
+   std::string index_filename = arg + 1 < argc ? argv[arg + 1] : filename + ".idx";
+
+   Sift::Reader reader(filename.c_str());
+   if (!reader.setIndex(index_filename.c_str(), interval))
+      return 1;
+
+   Sift::Instruction inst;
+   while(reader.Read(inst))
+   {
+      if ((reader.getInstructionCount() & 0xffff) == 0)
+         fprintf(stderr, "Indexing SIFT trace: %" PRIu64 "%%\r", 100 * reader.getPosition() / reader.getLength());
+   }
+   fprintf(stderr, "                                       \r");
+
+   printf("%s: %" PRIu64 " instructions, %" PRIu64 " checkpoints\n", index_filename.c_str(), reader.getInstructionCount(), reader.getInstructionCount() / interval);
+
+   return 0;
+}
@@ -0,0 +1,342 @@
+#define __STDC_FORMAT_MACROS
+
+#include "sift_reader.h"
+#include "sift_format.h"
+
+#include <inttypes.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+// Summarize and validate SIFT traces, with the results in JSON: instruction mix, memory footprint, code pages,
+// syscalls, thread creation and markers (magic instructions), and whether the trace is complete and well-formed.
+// Traces are scanned in parallel. A trace with an index (<file.sift>.idx, see siftindex) is also split into
+// segments at its checkpoints, which are scanned in parallel using Sift::Reader::Seek.
+
+namespace
+{
+
+const uint32_t num_hot_pages = 16;
+
+struct Event
+{
+   uint64_t icount;
+   const char *type;
+   uint64_t a, b, c;
+};
+
+struct Stats
+{
+   uint64_t instructions, branches, taken, predicated, executed, memory_accesses;
+   uint64_t sizes[16];
+   std::unordered_map<uint64_t, uint64_t> data_pages;   // Page -> number of accesses
+   std::unordered_set<uint64_t> code_pages;
+   std::map<uint16_t, uint64_t> syscalls;
+   std::vector<Event> events;                          // Thread creation and markers, in trace order
+   std::vector<std::string> errors;
+   bool complete;
+
+   Stats()
+      : instructions(0), branches(0), taken(0), predicated(0), executed(0), memory_accesses(0), sizes(), complete(false)
+   {}
+
+   // Append the statistics of the next segment of the same trace
+   void merge(const Stats &other)
+   {
+      instructions += other.instructions;
+      branches += other.branches;
+      taken += other.taken;
+      predicated += other.predicated;
+      executed += other.executed;
+      memory_accesses += other.memory_accesses;
+      for(int i = 0; i < 16; ++i)
+         sizes[i] += other.sizes[i];
+      for(auto it = other.data_pages.begin(); it != other.data_pages.end(); ++it)
+         data_pages[it->first] += it->second;
+      code_pages.insert(other.code_pages.begin(), other.code_pages.end());
+      for(auto it = other.syscalls.begin(); it != other.syscalls.end(); ++it)
+         syscalls[it->first] += it->second;
+      events.insert(events.end(), other.events.begin(), other.events.end());
+      errors.insert(errors.end(), other.errors.begin(), other.errors.end());
+      complete = other.complete;
+   }
+};
+
+// Instructions [start, end) of one trace
+struct Segment
+{
+   size_t trace;
+   uint64_t start, end;
+   Stats stats;
+};
+
+struct Scanner
+{
+   Sift::Reader *reader;
+   Stats *stats;
+
+   void event(const char *type, uint64_t a = 0, uint64_t b = 0, uint64_t c = 0)
+   {
+      Event e = { reader->getInstructionCount(), type, a, b, c };
+      stats->events.push_back(e);
+   }
+
+   static uint64_t handleSyscall(void *arg, uint16_t syscall_number, const uint8_t *data, uint32_t size)
+   { ((Scanner*)arg)->stats->syscalls[syscall_number]++; return 0; }
+   static int32_t handleNewThread(void *arg)
+   { ((Scanner*)arg)->event("new_thread"); return 0; }
+   static int32_t handleFork(void *arg)
+   { ((Scanner*)arg)->event("fork"); return 0; }
+   static int32_t handleJoin(void *arg, int32_t thread)
+   { ((Scanner*)arg)->event("join", thread); return 0; }
+   static uint64_t handleMagic(void *arg, uint64_t a, uint64_t b, uint64_t c)
+   { ((Scanner*)arg)->event("marker", a, b, c); return 0; }
+   static bool handleEmu(void *arg, Sift::EmuType type, Sift::EmuRequest &req, Sift::EmuReply &res)
+   { return false; }
+};
+
+void scan(const std::string &filename, Segment &segment)
+{
+   Stats &stats = segment.stats;
+   char error[256];
+
+   // Synchronous records (syscalls, thread creation, ...) need somewhere to send their response to
+   Sift::Reader reader(filename.c_str(), "/dev/null");
+   Scanner scanner = { &reader, &stats };
+   reader.setHandleSyscallFunc(Scanner::handleSyscall, &scanner);
+   reader.setHandleNewThreadFunc(Scanner::handleNewThread, &scanner);
+   reader.setHandleForkFunc(Scanner::handleFork, &scanner);
+   reader.setHandleJoinFunc(Scanner::handleJoin, &scanner);
+   reader.setHandleMagicFunc(Scanner::handleMagic, &scanner);
+   reader.setHandleEmuFunc(Scanner::handleEmu, &scanner);
+
+   if (segment.start && (!reader.Seek(segment.start) || reader.getInstructionCount() != segment.start))
+   {
+      snprintf(error, sizeof(error), "cannot seek to checkpoint at instruction %" PRIu64, segment.start);
+      stats.errors.push_back(error);
+      return;
+   }
+
+   Sift::Instruction inst;
+   while(reader.getInstructionCount() < segment.end && reader.Read(inst))
+   {
+      stats.instructions++;
+      if (inst.sinst->size == 0 || inst.sinst->size >= 16 || inst.num_addresses > Sift::MAX_DYNAMIC_ADDRESSES)
+      {
+         if (stats.errors.size() < 100)
+         {
+            snprintf(error, sizeof(error), "malformed instruction %" PRIu64 " at %" PRIx64 ": size %u, %u addresses",
+                     reader.getInstructionCount(), inst.sinst->addr, inst.sinst->size, inst.num_addresses);
+            stats.errors.push_back(error);
+         }
+         continue;
+      }
+      stats.sizes[inst.sinst->size]++;
+      for(uint64_t page = inst.sinst->addr & Sift::ICACHE_PAGE_MASK; page <= ((inst.sinst->addr + inst.sinst->size - 1) & Sift::ICACHE_PAGE_MASK); page += Sift::ICACHE_SIZE)
+         stats.code_pages.insert(page);
+      if (inst.is_branch)
+      {
+         stats.branches++;
+         if (inst.taken)
+            stats.taken++;
+      }
+      if (inst.is_predicate)
+         stats.predicated++;
+      if (inst.executed)
+      {
+         stats.executed++;
+         for(int i = 0; i < inst.num_addresses; ++i)
+         {
+            stats.memory_accesses++;
+            stats.data_pages[inst.addresses[i] / Sift::PAGE_SIZE_SIFT]++;
+         }
+      }
+   }
+
+   if (segment.end != UINT64_MAX)
+   {
+      if (reader.getInstructionCount() != segment.end)
+      {
+         snprintf(error, sizeof(error), "trace ends at instruction %" PRIu64 ", before index checkpoint %" PRIu64, reader.getInstructionCount(), segment.end);
+         stats.errors.push_back(error);
+      }
+   }
+   else
+   {
+      stats.complete = reader.getSeenEnd();
+      if (!stats.complete)
+      {
+         snprintf(error, sizeof(error), "trace is truncated or corrupt after instruction %" PRIu64 " (no end record)", reader.getInstructionCount());
+         stats.errors.push_back(error);
+      }
+   }
+}
+
+// Instruction counts at which the trace can be split, from its index
+std::vector<uint64_t> getCheckpoints(const std::string &filename)
+{
+   std::vector<uint64_t> checkpoints;
+   std::ifstream index((filename + ".idx").c_str(), std::ios::in | std::ios::binary);
+   Sift::IndexHeader hdr;
+   index.read(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+   if (index.fail() || hdr.magic != Sift::IndexMagic)
+      return checkpoints;
+
+   Sift::IndexEntry entry;
+   while(index.read(reinterpret_cast<char*>(&entry), sizeof(entry)))
+   {
+      checkpoints.push_back(entry.icount);
+      index.seekg(entry.num_pages * (sizeof(uint64_t) + Sift::ICACHE_SIZE) + entry.num_mappings * 2 * sizeof(uint64_t), std::ios::cur);
+   }
+   return checkpoints;
+}
+
+std::string escape(const std::string &s)
+{
+   std::string res;
+   for(auto it = s.begin(); it != s.end(); ++it)
+   {
+      if (*it == '"' || *it == '\\')
+         res += '\\';
+      res += *it;
+   }
+   return res;
+}
+
+void printStats(FILE *fp, const std::string &filename, const Stats &stats)
+{
+   fprintf(fp, "    {\n");
+   fprintf(fp, "      \"file\": \"%s\",\n", escape(filename).c_str());
+   fprintf(fp, "      \"valid\": %s,\n", stats.errors.empty() ? "true" : "false");
+   fprintf(fp, "      \"complete\": %s,\n", stats.complete ? "true" : "false");
+   fprintf(fp, "      \"errors\": [");
+   for(size_t i = 0; i < stats.errors.size(); ++i)
+      fprintf(fp, "%s\"%s\"", i ? ", " : "", escape(stats.errors[i]).c_str());
+   fprintf(fp, "],\n");
+
+   fprintf(fp, "      \"instructions\": %" PRIu64 ",\n", stats.instructions);
+   fprintf(fp, "      \"branches\": %" PRIu64 ",\n", stats.branches);
+   fprintf(fp, "      \"taken_branches\": %" PRIu64 ",\n", stats.taken);
+   fprintf(fp, "      \"predicated\": %" PRIu64 ",\n", stats.predicated);
+   fprintf(fp, "      \"executed\": %" PRIu64 ",\n", stats.executed);
+   fprintf(fp, "      \"memory_accesses\": %" PRIu64 ",\n", stats.memory_accesses);
+   fprintf(fp, "      \"instruction_sizes\": {");
+   for(int i = 0, n = 0; i < 16; ++i)
+      if (stats.sizes[i])
+         fprintf(fp, "%s\"%d\": %" PRIu64, n++ ? ", " : "", i, stats.sizes[i]);
+   fprintf(fp, "},\n");
+
+   fprintf(fp, "      \"code_pages\": %zu,\n", stats.code_pages.size());
+   fprintf(fp, "      \"data_pages\": %zu,\n", stats.data_pages.size());
+   fprintf(fp, "      \"data_footprint_bytes\": %" PRIu64 ",\n", uint64_t(stats.data_pages.size()) * Sift::PAGE_SIZE_SIFT);
+   std::vector<std::pair<uint64_t, uint64_t> > pages;
+   for(auto it = stats.data_pages.begin(); it != stats.data_pages.end(); ++it)
+      pages.push_back(std::make_pair(it->second, it->first));
+   size_t num_hot = std::min(pages.size(), size_t(num_hot_pages));
+   std::partial_sort(pages.begin(), pages.begin() + num_hot, pages.end(), std::greater<std::pair<uint64_t, uint64_t> >());
+   fprintf(fp, "      \"hot_data_pages\": [");
+   for(size_t i = 0; i < num_hot; ++i)
+      fprintf(fp, "%s{\"address\": \"0x%" PRIx64 "\", \"accesses\": %" PRIu64 "}", i ? ", " : "", pages[i].second * Sift::PAGE_SIZE_SIFT, pages[i].first);
+   fprintf(fp, "],\n");
+
+   fprintf(fp, "      \"syscalls\": {");
+   int n = 0;
+   for(auto it = stats.syscalls.begin(); it != stats.syscalls.end(); ++it)
+      fprintf(fp, "%s\"%u\": %" PRIu64, n++ ? ", " : "", it->first, it->second);
+   fprintf(fp, "},\n");
+
+   fprintf(fp, "      \"events\": [");
+   for(size_t i = 0; i < stats.events.size(); ++i)
+   {
+      const Event &e = stats.events[i];
+      fprintf(fp, "%s\n        {\"icount\": %" PRIu64 ", \"type\": \"%s\"", i ? "," : "", e.icount, e.type);
+      if (strcmp(e.type, "join") == 0)
+         fprintf(fp, ", \"thread\": %d", int32_t(e.a));
+      else if (strcmp(e.type, "marker") == 0)
+         fprintf(fp, ", \"a\": %" PRIu64 ", \"b\": %" PRIu64 ", \"c\": %" PRIu64, e.a, e.b, e.c);
+      fprintf(fp, "}");
+   }
+   fprintf(fp, "%s]\n", stats.events.empty() ? "" : "\n      ");
+   fprintf(fp, "    }");
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+   unsigned int num_threads = std::max(1u, std::thread::hardware_concurrency());
+   int arg = 1;
+   if (argc > 2 && strcmp(argv[1], "-j") == 0)
+   {
+      num_threads = std::max(1, atoi(argv[2]));
+      arg += 2;
+   }
+
+   if (arg >= argc)
+   {
+      printf("Usage: %s [-j <threads>] <file.sift> [<file.sift> ...]\n", argv[0]);
+      return 1;
+   }
+
+   std::vector<std::string> filenames(argv + arg, argv + argc);
+
+   // Split each trace into at most num_threads segments, at evenly spread checkpoints of its index
+   std::vector<Segment> segments;
+   for(size_t t = 0; t < filenames.size(); ++t)
+   {
+      std::vector<uint64_t> checkpoints = getCheckpoints(filenames[t]);
+      uint64_t start = 0;
+      for(unsigned int s = 1; s < num_threads && !checkpoints.empty(); ++s)
+      {
+         uint64_t end = checkpoints[s * checkpoints.size() / num_threads];
+         if (end > start)
+         {
+            segments.push_back(Segment { t, start, end, Stats() });
+            start = end;
+         }
+      }
+      segments.push_back(Segment { t, start, UINT64_MAX, Stats() });
+   }
+
+   std::atomic<size_t> next(0);
+   std::vector<std::thread> workers;
+   for(unsigned int i = 0; i < std::min(size_t(num_threads), segments.size()); ++i)
+   {
+      workers.push_back(std::thread([&]() {
+         for(size_t s = next++; s < segments.size(); s = next++)
+            scan(filenames[segments[s].trace], segments[s]);
+      }));
+   }
+   for(auto it = workers.begin(); it != workers.end(); ++it)
+      it->join();
+
+   // Segments of a trace are consecutive and in order
+   std::vector<Stats> stats(filenames.size());
+   for(auto it = segments.begin(); it != segments.end(); ++it)
+      stats[it->trace].merge(it->stats);
+
+   bool valid = true;
+   uint64_t instructions = 0;
+   printf("{\n  \"traces\": [\n");
+   for(size_t t = 0; t < filenames.size(); ++t)
+   {
+      printStats(stdout, filenames[t], stats[t]);
+      printf("%s\n", t + 1 < filenames.size() ? "," : "");
+      valid &= stats[t].errors.empty();
+      instructions += stats[t].instructions;
+   }
+   printf("  ],\n");
+   printf("  \"instructions\": %" PRIu64 ",\n", instructions);
+   printf("  \"valid\": %s\n}\n", valid ? "true" : "false");
+
+   return valid ? 0 : 2;
+}
@@ -1,6 +1,159 @@
 #include "zfstream.h"
 
 #include <cassert>
+#include <cerrno>
+#include <algorithm>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+vofdstream::vofdstream(const char * filename, size_t arena_size)
+   : m_fd(open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644))
+   , m_fail(m_fd < 0)
+   , m_arena(new char[arena_size])
+   , m_arena_size(arena_size)
+   , m_used(0)
+   , m_written(0)
+{
+}
+
+vofdstream::~vofdstream()
+{
+   flush();
+   if (m_fd >= 0)
+      close(m_fd);
+   delete [] m_arena;
+}
+
+void vofdstream::writeOut(const char* s, size_t n)
+{
+   if (m_used == 0 && n == 0)
+      return;
+
+   struct iovec iov[2] = { { m_arena, m_used }, { const_cast<char*>(s), n } };
+   int iovcnt = n ? 2 : 1;
+   struct iovec *next = iov;
+   m_written += m_used + n;
+   m_used = 0;
+
+   if (m_fd < 0)
+   {
+      m_fail = true;
+      return;
+   }
+
+   // Pipes accept partial writes
+   while(iovcnt > 0)
+   {
+      ssize_t res = writev(m_fd, next, iovcnt);
+      if (res < 0)
+      {
+         if (errno == EINTR)
+            continue;
+         m_fail = true;
+         return;
+      }
+      while(iovcnt > 0 && size_t(res) >= next->iov_len)
+      {
+         res -= next->iov_len;
+         ++next;
+         --iovcnt;
+      }
+      if (iovcnt > 0)
+      {
+         next->iov_base = static_cast<char*>(next->iov_base) + res;
+         next->iov_len -= res;
+      }
+   }
+}
+
+vifdstream::vifdstream(const char * filename, size_t buffer_size)
+   : m_fd(open(filename, O_RDONLY))
+   , m_fail(m_fd < 0)
+   , m_buffer(new char[buffer_size])
+   , m_buffer_size(buffer_size)
+   , m_begin(0)
+   , m_end(0)
+   , m_consumed(0)
+{
+   if (pipe(m_abort_pipe) != 0)
+   {
+      m_abort_pipe[0] = m_abort_pipe[1] = -1;
+      m_fail = true;
+   }
+}
+
+vifdstream::~vifdstream()
+{
+   if (m_fd >= 0)
+      close(m_fd);
+   if (m_abort_pipe[0] >= 0)
+   {
+      close(m_abort_pipe[0]);
+      close(m_abort_pipe[1]);
+   }
+   delete [] m_buffer;
+}
+
+void vifdstream::abort()
+{
+   // Wakes up a fill() that is waiting in poll(), and makes any later one fail right away
+   char c = 0;
+   while(write(m_abort_pipe[1], &c, 1) < 0 && errno == EINTR) ;
+}
+
+// Wait for more input from m_fd, or for abort()
+bool vifdstream::fill()
+{
+   if (m_fail)
+      return false;
+
+   struct pollfd fds[2] = { { m_fd, POLLIN, 0 }, { m_abort_pipe[0], POLLIN, 0 } };
+   while(true)
+   {
+      int res = poll(fds, 2, -1);
+      if (res < 0 && errno == EINTR)
+         continue;
+      if (res < 0 || fds[1].revents)
+      {
+         m_fail = true;
+         return false;
+      }
+
+      ssize_t size = ::read(m_fd, m_buffer, m_buffer_size);
+      if (size < 0 && errno == EINTR)
+         continue;
+      if (size <= 0)
+      {
+         // End of file (the writer closed the pipe), or an error
+         m_fail = true;
+         return false;
+      }
+      m_begin = 0;
+      m_end = size;
+      return true;
+   }
+}
+
+void vifdstream::read(char* s, std::streamsize n)
+{
+   while(n > 0)
+   {
+      if (m_begin == m_end && !fill())
+      {
+         // As vimstream: do not leave the caller's data uninitialized
+         memset(s, 0, n);
+         return;
+      }
+      size_t amount = std::min(size_t(n), m_end - m_begin);
+      memcpy(s, m_buffer + m_begin, amount);
+      m_begin += amount;
+      m_consumed += amount;
+      s += amount;
+      n -= amount;
+   }
+}
 
 #if !SIFT_USE_ZLIB
 
@@ -43,6 +196,21 @@ int izstream::peek()
    return 0;
 }
 
+ozchunkstream::ozchunkstream(vostream *output, int level, uint64_t offset)
+   : output(output)
+   , level(level)
+{
+   assert(false);
+}
+
+ozchunkstream::~ozchunkstream()
+{
+}
+
+void ozchunkstream::writeChunk()
+{
+}
+
 #else /*SIFT_USE_ZLIB*/
 
 #include <zlib.h>
@@ -91,6 +259,53 @@ void ozstream::doCompress(bool finish)
 
 
 
+ozchunkstream::ozchunkstream(vostream *output, int level, uint64_t offset)
+   : output(output)
+   , level(level)
+   , m_offset(offset)
+   , m_uncompressed_offset(0)
+{
+   buffer.reserve(2 * chunksize);
+}
+
+ozchunkstream::~ozchunkstream()
+{
+   writeChunk();
+
+   Sift::ChunkHeader hdr = { Sift::ChunkMagic, Sift::ChunkIndex, {}, uint32_t(m_index.size() * sizeof(Sift::ChunkIndexEntry)), uint32_t(m_index.size() * sizeof(Sift::ChunkIndexEntry)) };
+   Sift::ChunkTrailer trailer = { m_offset, uint32_t(m_index.size()), Sift::ChunkMagic };
+   output->write(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+   if (m_index.size())
+      output->write(reinterpret_cast<char*>(&m_index[0]), m_index.size() * sizeof(Sift::ChunkIndexEntry));
+   output->write(reinterpret_cast<char*>(&trailer), sizeof(trailer));
+   output->flush();
+
+   delete output;
+}
+
+void ozchunkstream::writeChunk()
+{
+   if (buffer.empty())
+      return;
+
+   uLongf size = compressBound(buffer.size());
+   cbuffer.resize(size);
+   int ret = compress2((Bytef*)&cbuffer[0], &size, (const Bytef*)&buffer[0], buffer.size(), level);
+   assert(ret == Z_OK);
+
+   Sift::ChunkHeader hdr = { Sift::ChunkMagic, Sift::ChunkZlib, {}, uint32_t(size), uint32_t(buffer.size()) };
+   output->write(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+   output->write(&cbuffer[0], size);
+
+   Sift::ChunkIndexEntry entry = { m_offset, m_uncompressed_offset };
+   m_index.push_back(entry);
+   m_offset += sizeof(hdr) + size;
+   m_uncompressed_offset += buffer.size();
+   buffer.clear();
+}
+
+
+
 izstream::izstream(vistream *input)
    : input(input)
    , m_eof(false)
@@ -159,4 +374,187 @@ int izstream::peek()
    return peek_value;
 }
 
+#if SIFT_USE_FAST_READER
+
+izringstream::izringstream(vistream *input, bool chunked)
+   : input(input)
+   , m_chunked(chunked)
+   , inbuffer(chunksize)
+   , ring(new char[ringsize])
+   , m_produced(0)
+   , m_input_pos(0)
+   , m_finished(false)
+   , m_consumer_waiting(false)
+   , m_consumed(0)
+   , m_producer_waiting(false)
+   , m_read_pos(0)
+   , m_read_end(0)
+   , m_stop(false)
+   , m_fail(false)
+{
+   zstream.zalloc = Z_NULL;
+   zstream.zfree = Z_NULL;
+   zstream.opaque = Z_NULL;
+   zstream.avail_in = 0;
+   zstream.next_in = Z_NULL;
+   int ret = inflateInit(&zstream);
+   assert(ret == Z_OK);
+
+   m_thread = std::thread(&izringstream::inflateLoop, this);
+}
+
+izringstream::~izringstream()
+{
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+      m_cond.notify_all();
+   }
+   m_thread.join();
+   inflateEnd(&zstream);
+   delete input;
+   delete [] ring;
+}
+
+void izringstream::inflateLoop()
+{
+   while (true)
+   {
+      uint64_t produced = m_produced;
+      {
+         // Wait for free space in the ring. The waiting flag is set before checking m_consumed,
+         // so the reader either sees the flag or we see its update.
+         std::unique_lock<std::mutex> lock(m_mutex);
+         m_producer_waiting = true;
+         while (!m_stop && produced - m_consumed >= ringsize)
+            m_cond.wait(lock);
+         m_producer_waiting = false;
+         if (m_stop)
+            return;
+      }
+
+      size_t offset = produced % ringsize;
+      size_t space = std::min(size_t(ringsize - (produced - m_consumed)), ringsize - offset);
+
+      if (zstream.avail_in == 0)
+      {
+         if (m_chunked)
+         {
+            if (!nextChunk())
+               m_finished = true;
+         }
+         else
+         {
+            input->read(&inbuffer[0], chunksize);
+            zstream.next_in = (Bytef*)&inbuffer[0];
+            zstream.avail_in = chunksize;
+         }
+      }
+      if (!m_finished)
+      {
+         zstream.next_out = (Bytef*)(ring + offset);
+         zstream.avail_out = space;
+         int ret = inflate(&zstream, Z_NO_FLUSH);
+
+         if (!m_chunked)
+            m_input_pos = zstream.total_in;
+         m_produced = produced + (space - zstream.avail_out);
+         if (ret == Z_STREAM_END && m_chunked)
+            zstream.avail_in = 0;   // Chunk complete, continue with the next one
+         else if (ret != Z_OK)
+            m_finished = true;   // Z_STREAM_END, or a truncated trace: the reader fails once it consumed everything
+      }
+      if (m_consumer_waiting || m_finished)
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         m_cond.notify_all();
+      }
+      if (m_finished)
+         return;
+   }
+}
+
+void izringstream::release()
+{
+   m_consumed = m_read_pos;
+   if (m_producer_waiting)
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_cond.notify_all();
+   }
+}
+
+bool izringstream::nextChunk()
+{
+   // Load the next compressed chunk into inbuffer. Returns false at the chunk index (or the end of the file).
+   Sift::ChunkHeader hdr;
+   input->read(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+   if (input->fail() || hdr.magic != Sift::ChunkMagic || hdr.type != Sift::ChunkZlib)
+      return false;
+
+   if (inbuffer.size() < hdr.compressed_size)
+      inbuffer.resize(hdr.compressed_size);
+   input->read(&inbuffer[0], hdr.compressed_size);
+   m_input_pos = m_input_pos + sizeof(hdr) + hdr.compressed_size;
+
+   int ret = inflateReset(&zstream);
+   assert(ret == Z_OK);
+   zstream.next_in = (Bytef*)&inbuffer[0];
+   zstream.avail_in = hdr.compressed_size;
+   return hdr.compressed_size > 0;
+}
+
+bool izringstream::refill()
+{
+   // Called when all data known to the reader was consumed. Returns false once the stream has ended.
+   release();
+   if (m_produced == m_read_pos)
+   {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_consumer_waiting = true;
+      while (m_produced == m_read_pos && !m_finished)
+         m_cond.wait(lock);
+      m_consumer_waiting = false;
+   }
+   m_read_end = m_produced;
+   return m_read_end != m_read_pos;
+}
+
+void izringstream::read(char* s, std::streamsize n)
+{
+   while (n > 0)
+   {
+      if (m_read_pos == m_read_end && !refill())
+      {
+         m_fail = true;
+         return;
+      }
+      size_t offset = m_read_pos % ringsize;
+      size_t amount = std::min(std::min(uint64_t(n), m_read_end - m_read_pos), uint64_t(ringsize - offset));
+      memcpy(s, ring + offset, amount);
+      s += amount;
+      n -= amount;
+
+      if ((m_read_pos + amount) / chunksize != m_read_pos / chunksize)
+      {
+         m_read_pos += amount;
+         release();
+      }
+      else
+         m_read_pos += amount;
+   }
+}
+
+int izringstream::peek()
+{
+   if (m_read_pos == m_read_end && !refill())
+   {
+      m_fail = true;
+      return EOF;
+   }
+   return ring[m_read_pos % ringsize];
+}
+
+#endif /*SIFT_USE_FAST_READER*/
+
 #endif /*SIFT_USE_ZLIB*/
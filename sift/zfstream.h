@@ -3,14 +3,24 @@
 
 #include "sift_format.h"
 
+#include <vector>
 #include <ostream>
 #include <istream>
 #include <fstream>
+#include <cstdio>
+#include <cstring>
 
 #if SIFT_USE_ZLIB
 # include <zlib.h>
 #endif
 
+#if SIFT_USE_ZLIB && SIFT_USE_FAST_READER
+# include <atomic>
+# include <condition_variable>
+# include <mutex>
+# include <thread>
+#endif
+
 class vostream
 {
    public:
@@ -19,6 +29,10 @@ class vostream
       virtual void flush() = 0;
       virtual bool is_open() = 0;
       virtual bool fail() = 0;
+      // Called by the writer between records; streams that frame their output only cut frames here
+      virtual void recordBoundary() {}
+      // Uncompressed bytes written so far, for streams that can be indexed (see Sift::IndexWriter)
+      virtual uint64_t tell() { return 0; }
 };
 
 class vofstream : public vostream
@@ -39,6 +53,45 @@ class vofstream : public vostream
          { return stream->fail(); }
       virtual bool is_open()
          { return stream->is_open(); }
+      virtual uint64_t tell()
+         { return stream->tellp(); }
+};
+
+// Output to a file descriptor through an arena of our own, without the per-call overhead of an ofstream. The arena is
+// written out with a single system call when it is full or flushed; a write that does not fit in the remaining space
+// is passed to writev() together with the arena contents rather than being copied.
+class vofdstream : public vostream
+{
+   private:
+      int m_fd;
+      bool m_fail;
+      char *m_arena;
+      const size_t m_arena_size;
+      size_t m_used;
+      uint64_t m_written;
+      void writeOut(const char* s, size_t n);
+   public:
+      static const size_t default_arena_size = 1 << 20;
+      vofdstream(const char * filename, size_t arena_size = default_arena_size);
+      virtual ~vofdstream();
+      virtual void write(const char* s, std::streamsize n)
+      {
+         if (m_used + n <= m_arena_size)
+         {
+            memcpy(m_arena + m_used, s, n);
+            m_used += n;
+         }
+         else
+            writeOut(s, n);
+      }
+      virtual void flush()
+         { writeOut(NULL, 0); }
+      virtual bool fail()
+         { return m_fail; }
+      virtual bool is_open()
+         { return m_fd >= 0; }
+      virtual uint64_t tell()
+         { return m_written + m_used; }
 };
 
 class ozstream : public vostream
@@ -64,6 +117,37 @@ class ozstream : public vostream
          { return output->is_open(); }
 };
 
+// Chunked container (see Sift::CompressionChunked): every chunk is compressed independently at the given zlib level,
+// and the chunk index and trailer are written when the stream is deleted.
+class ozchunkstream : public vostream
+{
+   private:
+      vostream *output;
+      const int level;
+      static const size_t chunksize = 1024*1024;
+      std::vector<char> buffer;       // Uncompressed records of the current chunk
+      std::vector<char> cbuffer;
+      uint64_t m_offset;              // File offset of the next chunk
+      uint64_t m_uncompressed_offset;
+      std::vector<Sift::ChunkIndexEntry> m_index;
+      void writeChunk();
+   public:
+      ozchunkstream(vostream *output, int level, uint64_t offset);
+      virtual ~ozchunkstream();
+      virtual void write(const char* s, std::streamsize n)
+         { buffer.insert(buffer.end(), s, s + n); }
+      virtual void recordBoundary()
+         { if (buffer.size() >= chunksize) writeChunk(); }
+      virtual uint64_t tell()
+         { return m_uncompressed_offset + buffer.size(); }
+      virtual void flush()
+         { output->flush(); }
+      virtual bool fail()
+         { return output->fail(); }
+      virtual bool is_open()
+         { return output->is_open(); }
+};
+
 
 
 class vistream
@@ -92,6 +176,76 @@ class vifstream : public vistream
       virtual bool fail() const { return stream->fail(); }
 };
 
+// Input from a file descriptor through a buffer of our own, for pipes: unlike an ifstream, a read that is waiting for
+// the writer can be interrupted from another thread with abort(), after which the stream fails.
+class vifdstream : public vistream
+{
+   private:
+      int m_fd;
+      int m_abort_pipe[2];
+      bool m_fail;
+      char *m_buffer;
+      const size_t m_buffer_size;
+      size_t m_begin, m_end;
+      uint64_t m_consumed;
+      bool fill();
+   public:
+      static const size_t default_buffer_size = 1 << 16;
+      vifdstream(const char * filename, size_t buffer_size = default_buffer_size);
+      virtual ~vifdstream();
+      virtual void read(char* s, std::streamsize n);
+      virtual int peek()
+      {
+         if (m_begin == m_end && !fill())
+            return EOF;
+         return (unsigned char)m_buffer[m_begin];
+      }
+      virtual bool fail() const { return m_fail; }
+      bool is_open() const { return m_fd >= 0; }
+      uint64_t tell() const { return m_consumed; }
+      // Can be called from any thread
+      void abort();
+};
+
+class vimstream final : public vistream
+{
+   private:
+      const char *data;
+      std::streamsize size;
+      std::streamsize pos;
+      bool m_fail;
+   public:
+      // Read from a caller-owned memory buffer (e.g. a shared, read-only mmap of a trace file).
+      // The class is final so calls through a vimstream pointer are inlined (see Sift::Reader::readInput).
+      vimstream(const void *data, std::streamsize size)
+         : data(static_cast<const char*>(data)), size(size), pos(0), m_fail(false) {}
+      virtual ~vimstream() {}
+      virtual void read(char* s, std::streamsize n)
+      {
+         if (n > size - pos)
+         {
+            // Past the end: fail, and do not leave the caller's data uninitialized
+            memset(s, 0, n);
+            n = size - pos;
+            m_fail = true;
+         }
+         memcpy(s, data + pos, n);
+         pos += n;
+      }
+      virtual int peek()
+      {
+         if (pos >= size)
+         {
+            m_fail = true;
+            return EOF;
+         }
+         return (unsigned char)data[pos];
+      }
+      virtual bool fail() const { return m_fail; }
+      std::streamsize tell() const { return pos; }
+      void seek(std::streamsize position) { pos = position; m_fail = false; }
+};
+
 class izstream : public vistream
 {
    private:
@@ -114,4 +268,52 @@ class izstream : public vistream
       virtual bool fail() const { return m_fail; }
 };
 
+#if SIFT_USE_ZLIB && SIFT_USE_FAST_READER
+// Decompress on a background thread into a large ring buffer, overlapping inflate with trace consumption.
+// Reads either a single zlib stream or the chunked container (Sift::CompressionChunked).
+// Only use this on inputs that never wait for a response from the reader (i.e., files, not pipes).
+class izringstream : public vistream
+{
+   private:
+      vistream *input;
+      z_stream zstream;
+      static const size_t chunksize = 1024*1024;
+      static const size_t ringsize = 16*1024*1024;
+      const bool m_chunked;
+      std::vector<char> inbuffer;
+      char *ring;
+      // Shared state, written by the inflate thread and by the reader on separate cache lines
+      char m_pad0[64];
+      std::atomic<uint64_t> m_produced;               // Total bytes inflated into the ring
+      std::atomic<uint64_t> m_input_pos;              // Compressed bytes consumed by inflate
+      std::atomic<bool> m_finished;
+      std::atomic<bool> m_consumer_waiting;
+      char m_pad1[64];
+      std::atomic<uint64_t> m_consumed;               // Total bytes released by the reader
+      std::atomic<bool> m_producer_waiting;
+      // Reader-private: the reader copies out of [m_read_pos, m_read_end) without touching the shared state,
+      // and releases space to the inflate thread once per chunk
+      char m_pad2[64];
+      uint64_t m_read_pos;
+      uint64_t m_read_end;
+      bool m_stop;
+      bool m_fail;
+      std::mutex m_mutex;
+      std::condition_variable m_cond;
+      std::thread m_thread;
+      void inflateLoop();
+      bool nextChunk();
+      void release();
+      bool refill();
+   public:
+      izringstream(vistream *input, bool chunked = false);
+      virtual ~izringstream();
+      virtual void read(char* s, std::streamsize n);
+      virtual int peek();
+      virtual bool fail() const { return m_fail; }
+      uint64_t tell() const { return m_input_pos; }
+      uint64_t tellUncompressed() const { return m_read_pos; }
+};
+#endif
+
 #endif // __ZFSTREAM_H
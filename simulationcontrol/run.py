@@ -260,6 +260,24 @@ def get_workload(benchmark, cores, parallelism=None, number_tasks=None, input_se
         raise Exception('either parallelism or number_tasks needs to be set')
 
 
+def get_workload_from_arrival_log(arrival_log, input_set='small'):
+    """Return the benchmark instances of an arrival log, in arrival order.
+
+    Use together with 'distribution = trace' and 'arrivalLog = <arrival_log>' in [scheduler/open],
+    so that task i of the simulation runs the benchmark of the i-th arrival in the log.
+    """
+    workload = []
+    with open(arrival_log) as f:
+        for line in f:
+            fields = line.replace(',', ' ').split()
+            if not fields or fields[0].startswith('#'):
+                continue
+            if len(fields) < 3:
+                raise Exception('arrival log entry without benchmark and parallelism: {}'.format(line.strip()))
+            workload.append(get_instance(fields[1], int(fields[2]), input_set=input_set))
+    return workload
+
+
 def example():
     for benchmark in (
                       'parsec-blackscholes',
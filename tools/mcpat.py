@@ -337,6 +337,8 @@ def main(jobid, resultsdir, outputfile, powertype='dynamic', config=None, no_gra
         'Gate Leakage': 0,
         'Area': 0,
     }
+    # Power-gated cores (scheduler/open/powergating)
+    power_gating(power_dat, results['results'], results['config'])
     # Write back
     file(outputfile + '.py', 'w').write("power = " + pprint.pformat(power_dat))
 
@@ -414,6 +416,26 @@ def main(jobid, resultsdir, outputfile, powertype='dynamic', config=None, no_gra
         return {'labels': plot_labels, 'power_data': plot_data, 'ncores': ncores, 'time_s': seconds}
 
 
+def power_gating(power_dat, stats, cfg):
+    # While gated, a core only leaks a residual fraction of its leakage power. Waking it up costs energy.
+    if 'core.gated_time' not in stats:
+        return
+    residual = float(sniper_config.get_config_default(
+        cfg, 'scheduler/open/powergating/residual_leakage', 0.05))
+    wakeup_energy = float(sniper_config.get_config_default(
+        cfg, 'scheduler/open/powergating/wakeup_energy', 0)) * 1e-9
+    time_fs = stats['global.time']
+    if time_fs <= 0:
+        return
+    for i, core in enumerate(power_dat['Core']):
+        gated = min(1., stats['core.gated_time'][i] / float(time_fs))
+        for name in core.keys():
+            if name.endswith('Leakage') or name.endswith('Leakage with power gating'):
+                core[name] *= 1 - gated * (1 - residual)
+        wakeup_power = stats['core.wakeups'][i] * wakeup_energy / (time_fs * 1e-15)
+        core['Runtime Dynamic'] = core.get('Runtime Dynamic', 0) + wakeup_power
+
+
 def scale_power(suffix, power, size_nm):
     if suffix == 'Runtime Dynamic':
         if size_nm >= 22: